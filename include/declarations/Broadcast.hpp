@@ -0,0 +1,164 @@
+/**========================================================================
+ * ?                          Broadcast.hpp
+ * @brief   : NumPy-style broadcasting of Matrix operands
+ * @details : Two shapes are compatible when, along each dimension, they are
+ *            equal or one of them is 1. The dimension of size 1 is stretched
+ *            virtually by giving it a stride of 0, so a row or column vector
+ *            never has to be copied with repcol / reprow before being combined
+ *            with a full matrix.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <utility>
+#include <cstddef>
+
+#include "Grid2D.hpp"
+
+namespace ejovo {
+
+template <class T> class Matrix;
+
+namespace broadcast {
+
+    using shape_t = std::pair<std::size_t, std::size_t>;
+
+    // Resulting extent of a single dimension, 0 if the extents are incompatible
+    inline std::size_t extent(std::size_t a, std::size_t b) {
+        if (a == b) return a;
+        if (a == 1) return b;
+        if (b == 1) return a;
+        return 0;
+    }
+
+    inline bool compatible(std::size_t am, std::size_t an, std::size_t bm, std::size_t bn) {
+        return extent(am, bm) != 0 && extent(an, bn) != 0;
+    }
+
+    // Shape of broadcasting an (am x an) operand against a (bm x bn) operand
+    inline shape_t shape(std::size_t am, std::size_t an, std::size_t bm, std::size_t bn) {
+        return std::make_pair(extent(am, bm), extent(an, bn));
+    }
+
+    // Can an (xm x xn) operand be stretched to exactly (m x n)?
+    inline bool stretches_to(std::size_t xm, std::size_t xn, std::size_t m, std::size_t n) {
+        return (xm == m || xm == 1) && (xn == n || xn == 1);
+    }
+
+    /**
+     * @brief Fused element-wise kernel over two column-major operands stretched to (m x n)
+     *
+     * `out` may alias `a` or `b` when that operand is not stretched. The stride of a
+     * stretched dimension is 0, so each operand is read in place.
+     */
+    template <class R, class A, class B, class Op>
+    void apply(R *out, std::size_t m, std::size_t n,
+               const A *a, std::size_t am, std::size_t an,
+               const B *b, std::size_t bm, std::size_t bn,
+               Op op) {
+
+        const std::size_t a_rs = (am == 1) ? 0 : 1;
+        const std::size_t b_rs = (bm == 1) ? 0 : 1;
+        const std::size_t a_cs = (an == 1) ? 0 : am;
+        const std::size_t b_cs = (bn == 1) ? 0 : bm;
+
+        for (std::size_t j = 0; j < n; j++) {
+
+            const A *aj = a + j * a_cs;
+            const B *bj = b + j * b_cs;
+            R *oj = out + j * m;
+
+            if (a_rs == 1 && b_rs == 1) {
+                for (std::size_t i = 0; i < m; i++) oj[i] = op(aj[i], bj[i]);
+            } else if (a_rs == 1) {
+                const B bv = bj[0];
+                for (std::size_t i = 0; i < m; i++) oj[i] = op(aj[i], bv);
+            } else if (b_rs == 1) {
+                const A av = aj[0];
+                for (std::size_t i = 0; i < m; i++) oj[i] = op(av, bj[i]);
+            } else {
+                const R v = op(aj[0], bj[0]);
+                for (std::size_t i = 0; i < m; i++) oj[i] = v;
+            }
+        }
+    }
+
+};
+
+/**
+ * @brief Lazy, read-mostly view of a Matrix stretched to a larger shape
+ *
+ * A Broadcast stores only its (small) base operand and the virtual shape. Element
+ * (i, j) refers to base(i, 1) when the base is a column, base(1, j) when the base
+ * is a row, and base(1, 1) when it is a scalar. Writing through the view therefore
+ * writes into the shared base element. Arithmetic between a Broadcast and a Matrix
+ * (or another Broadcast) runs the fused broadcasting kernel on the base directly.
+ *
+ * @tparam T any arithmetic type
+ */
+template <class T>
+class Broadcast : public Grid2D<T> {
+
+public:
+
+    Matrix<T> base;
+
+    Broadcast(const Matrix<T>& base, std::size_t m, std::size_t n);
+    Broadcast(Matrix<T>&& base, std::size_t m, std::size_t n);
+
+    Broadcast(const Broadcast& rhs);
+    Broadcast(Broadcast&& rhs);
+    Broadcast& operator=(const Broadcast& rhs);
+    Broadcast& operator=(Broadcast&& rhs);
+
+    /**============================================
+     *!    Grid1D / Grid2D Pure Virtual Functions
+     *=============================================**/
+    T& operator[](int i) override;
+    const T& operator[](int i) const override;
+    std::size_t nrow() const override;
+    std::size_t ncol() const override;
+    Matrix<T> to_matrix() const override;
+
+    using ejovo::Grid2D<T>::operator();
+
+    /**============================================
+     *!    Fused arithmetic
+     *=============================================**/
+    template <class Op>
+    Matrix<T> combine(const Matrix<T>& rhs, Op op) const;
+    template <class Op>
+    Matrix<T> combine(const Broadcast& rhs, Op op) const;
+
+    friend Matrix<T> operator+(const Broadcast& lhs, const Broadcast& rhs) { return lhs.combine(rhs, std::plus<T>{}); }
+    friend Matrix<T> operator-(const Broadcast& lhs, const Broadcast& rhs) { return lhs.combine(rhs, std::minus<T>{}); }
+    friend Matrix<T> operator%(const Broadcast& lhs, const Broadcast& rhs) { return lhs.combine(rhs, std::multiplies<T>{}); }
+    friend Matrix<T> operator/(const Broadcast& lhs, const Broadcast& rhs) { return lhs.combine(rhs, std::divides<T>{}); }
+
+    friend Matrix<T> operator+(const Broadcast& lhs, const Matrix<T>& rhs) { return lhs.combine(rhs, std::plus<T>{}); }
+    friend Matrix<T> operator-(const Broadcast& lhs, const Matrix<T>& rhs) { return lhs.combine(rhs, std::minus<T>{}); }
+    friend Matrix<T> operator%(const Broadcast& lhs, const Matrix<T>& rhs) { return lhs.combine(rhs, std::multiplies<T>{}); }
+    friend Matrix<T> operator/(const Broadcast& lhs, const Matrix<T>& rhs) { return lhs.combine(rhs, std::divides<T>{}); }
+
+    // Matrix op Broadcast: swap the operands of the fused kernel, keeping the order of op
+    friend Matrix<T> operator+(const Matrix<T>& lhs, const Broadcast& rhs) { return rhs.combine(lhs, [] (T b, T a) { return a + b; }); }
+    friend Matrix<T> operator-(const Matrix<T>& lhs, const Broadcast& rhs) { return rhs.combine(lhs, [] (T b, T a) { return a - b; }); }
+    friend Matrix<T> operator%(const Matrix<T>& lhs, const Broadcast& rhs) { return rhs.combine(lhs, [] (T b, T a) { return a * b; }); }
+    friend Matrix<T> operator/(const Matrix<T>& lhs, const Broadcast& rhs) { return rhs.combine(lhs, [] (T b, T a) { return a / b; }); }
+
+    friend Matrix<T> operator+(const Broadcast& lhs, const T& scalar) { return lhs.map([&] (T x) { return x + scalar; }); }
+    friend Matrix<T> operator-(const Broadcast& lhs, const T& scalar) { return lhs.map([&] (T x) { return x - scalar; }); }
+    friend Matrix<T> operator*(const Broadcast& lhs, const T& scalar) { return lhs.map([&] (T x) { return x * scalar; }); }
+    friend Matrix<T> operator/(const Broadcast& lhs, const T& scalar) { return lhs.map([&] (T x) { return x / scalar; }); }
+    friend Matrix<T> operator*(const T& scalar, const Broadcast& rhs) { return rhs * scalar; }
+    friend Matrix<T> operator+(const T& scalar, const Broadcast& rhs) { return rhs + scalar; }
+
+private:
+
+    std::size_t m_;
+    std::size_t n_;
+
+};
+
+};
@@ -22,6 +22,9 @@
 #include <functional>
 #include <cmath>
 #include <cstddef>
+#include <compare>
+#include <iterator>
+#include <type_traits>
 
 // Abstract class to implement the common behavior that is associated with a 1 dimensional vector
 namespace ejovo {
@@ -173,6 +176,27 @@ public:
     const T& operator()(int i) const;
     //@}
 
+    /**========================================================================
+     *!                           Iterators
+     *========================================================================**/
+    /** @name Iterators
+     *  Random-access iterators over the 1-dimensional indexing of a grid so that
+     *  every Grid1D models `std::ranges::random_access_range` and can be fed to
+     *  range-for loops and the lazy adaptors of `ejovo::views`
+     */
+    //@{
+    template <bool Const> class Iterator;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    //@}
+
     /**========================================================================
      *!                           First, Last
      *========================================================================**/
@@ -369,6 +393,68 @@ public:
 
 };
 
+/**
+ * @brief Random-access iterator that walks a Grid1D through its 0-based `[]` operator
+ *
+ * The iterator only stores a pointer to the grid and an offset, so it is valid for
+ * any concrete Grid1D (Matrix, views, Vector). Concrete types with contiguous
+ * storage, like Matrix, hide `begin()` and `end()` with raw pointers instead.
+ *
+ * @tparam Const whether the iterator yields `const T&`
+ */
+template <class T>
+template <bool Const>
+class Grid1D<T>::Iterator {
+
+public:
+
+    using grid_type = std::conditional_t<Const, const Grid1D<T>, Grid1D<T>>;
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const T&, T&>;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+
+    Iterator() = default;
+    Iterator(grid_type *grid, difference_type i) : grid_{grid}, i_{i} {}
+
+    // Allow an iterator to be converted to a const_iterator
+    template <bool C = Const> requires C
+    Iterator(const Iterator<false>& it)
+        : grid_{it.grid()}
+        , i_{it.index()}
+    {}
+
+    grid_type* grid() const { return grid_; }
+    difference_type index() const { return i_; }
+
+    reference operator*() const { return (*grid_)[i_]; }
+    reference operator[](difference_type k) const { return (*grid_)[i_ + k]; }
+
+    Iterator& operator++() { ++i_; return *this; }
+    Iterator& operator--() { --i_; return *this; }
+    Iterator operator++(int) { Iterator tmp{*this}; ++i_; return tmp; }
+    Iterator operator--(int) { Iterator tmp{*this}; --i_; return tmp; }
+
+    Iterator& operator+=(difference_type k) { i_ += k; return *this; }
+    Iterator& operator-=(difference_type k) { i_ -= k; return *this; }
+
+    friend Iterator operator+(Iterator it, difference_type k) { return it += k; }
+    friend Iterator operator+(difference_type k, Iterator it) { return it += k; }
+    friend Iterator operator-(Iterator it, difference_type k) { return it -= k; }
+    friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) { return lhs.i_ - rhs.i_; }
+
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) { return lhs.i_ == rhs.i_; }
+    friend std::strong_ordering operator<=>(const Iterator& lhs, const Iterator& rhs) { return lhs.i_ <=> rhs.i_; }
+
+private:
+
+    grid_type *grid_ = nullptr;
+    difference_type i_ = 0;
+
+};
+
 
 
 
@@ -10,9 +10,10 @@
 // #include <cmath>
 // #include <string>
 
-#include "ejovo/rng/Xoshiro.hpp"
+#include "ejovo/rng/engine.hpp"
 #include "Grid1D.hpp"
 #include "Grid2D.hpp"
+#include "Broadcast.hpp"
 
 
 namespace ejovo {
@@ -40,6 +41,18 @@ public:
     T& operator[](int i) override;
     const T& operator[](int i) const override;
 
+    /**============================================
+     *!    Contiguous iterators
+     *=============================================**/
+    // Hide Grid1D's virtual-dispatch iterators with raw pointers into the
+    // column-major storage so that Matrix models std::ranges::contiguous_range
+    T* begin();
+    T* end();
+    const T* begin() const;
+    const T* end() const;
+    const T* cbegin() const;
+    const T* cend() const;
+
     /**============================================
      *!     Grid2D Pure Virtual Functions
      *=============================================**/
@@ -99,6 +112,9 @@ public:
 
     bool can_add_b(const Matrix &rhs) const;
     bool cant_add_b(const Matrix &rhs) const;
+    // NumPy-style broadcasting: along each dimension the extents are equal or one of them is 1
+    template <class U> bool can_broadcast(const Matrix<U>& rhs) const;
+    template <class U> bool can_broadcast_into(const Matrix<U>& rhs) const; // rhs stretches to this shape
 
     Matrix& reshape(std::tuple<int, int> ind);
     Matrix& reshape(Matrix& ind);
@@ -131,9 +147,16 @@ public:
     Matrix kronecker_product(const Matrix& rhs) const;
 
     //* Matrix Moperators
+    // rhs is broadcast when it is a row vector, column vector or 1 x 1 matrix
+    // that stretches to the shape of this matrix
     Matrix& operator+=(const Matrix& rhs);
     Matrix& operator-=(const Matrix& rhs);
     Matrix& operator%=(const Matrix& rhs); // hadamard multiplication
+    Matrix& operator/=(const Matrix& rhs); // element-wise division
+
+    // Apply op element-wise to this and rhs stretched to their common broadcast shape
+    template <class U = T, class Op>
+    Matrix<U> broadcast_with(const Matrix& rhs, Op op) const;
 
     //* Matrix + scalar
     Matrix& operator+=(const T scalar);
@@ -144,11 +167,14 @@ public:
 
     Matrix operator-() const;
     Matrix operator*(const Matrix& rhs) const;
+    // y = A x on raw vectors of length ncol() and nrow(), which makes a Matrix a linalg::LinearOperator
+    void apply(const T *x, T *y) const;
     // using Grid
     // Matrix dot(const Matrix& rhs) const;
     Matrix operator^(int k) const;
 
-    friend Matrix operator+(Matrix lhs, const Matrix rhs) {
+    friend Matrix operator+(Matrix lhs, const Matrix& rhs) {
+        if (!lhs.can_broadcast_into(rhs)) return lhs.broadcast_with(rhs, std::plus<T>{});
         lhs += rhs;
         return lhs;
     }
@@ -164,7 +190,8 @@ public:
     }
 
     // these values are passed in by  copy
-    friend Matrix operator-(Matrix lhs, const Matrix rhs) {
+    friend Matrix operator-(Matrix lhs, const Matrix& rhs) {
+        if (!lhs.can_broadcast_into(rhs)) return lhs.broadcast_with(rhs, std::minus<T>{});
         lhs -= rhs;
         return lhs;
     }
@@ -189,11 +216,18 @@ public:
         return lhs;
     }
 
-    friend Matrix operator%(Matrix lhs, const Matrix rhs) {
+    friend Matrix operator%(Matrix lhs, const Matrix& rhs) {
+        if (!lhs.can_broadcast_into(rhs)) return lhs.broadcast_with(rhs, std::multiplies<T>{});
         lhs %= rhs;
         return lhs;
     }
 
+    friend Matrix operator/(Matrix lhs, const Matrix& rhs) {
+        if (!lhs.can_broadcast_into(rhs)) return lhs.broadcast_with(rhs, std::divides<T>{});
+        lhs /= rhs;
+        return lhs;
+    }
+
     friend Matrix operator/(const T scalar, Matrix rhs) {
         rhs.loop_i([&] (int i) {
             return rhs(i) = scalar * (1 / rhs(i));
@@ -334,6 +368,12 @@ public:
     Matrix<bool> operator>=(const T& rhs) const;
     // Matrix<bool> operator==(const T& rhs) const;
 
+    // Element-wise comparisons, broadcasting row and column vectors
+    Matrix<bool> operator<(const Matrix& rhs) const;
+    Matrix<bool> operator<=(const Matrix& rhs) const;
+    Matrix<bool> operator>(const Matrix& rhs) const;
+    Matrix<bool> operator>=(const Matrix& rhs) const;
+
 
 
 
@@ -15,7 +15,7 @@ public:
      *!               Fields
      *=============================================**/
     std::size_t n;
-    static ejovo::rng::Xoshiro& xoroshiro;
+    static thread_local ejovo::rng::Xoshiro& xoroshiro; // the calling thread's default engine
     std::unique_ptr<T[]> data;
     bool col = true;
 
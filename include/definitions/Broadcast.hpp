@@ -0,0 +1,139 @@
+#pragma once
+
+#include "declarations/Broadcast.hpp"
+
+namespace ejovo {
+
+/**========================================================================
+ *!                           Constructors
+ *========================================================================**/
+template <class T>
+Broadcast<T>::Broadcast(const Matrix<T>& base, std::size_t m, std::size_t n)
+    : base{base}
+    , m_{m}
+    , n_{n}
+{
+    if (!broadcast::stretches_to(base.m, base.n, m, n)) throw std::runtime_error("Cannot broadcast matrix to the requested shape");
+}
+
+template <class T>
+Broadcast<T>::Broadcast(Matrix<T>&& base, std::size_t m, std::size_t n)
+    : base{std::move(base)}
+    , m_{m}
+    , n_{n}
+{
+    if (!broadcast::stretches_to(this->base.m, this->base.n, m, n)) throw std::runtime_error("Cannot broadcast matrix to the requested shape");
+}
+
+template <class T>
+Broadcast<T>::Broadcast(const Broadcast& rhs)
+    : base{rhs.base}
+    , m_{rhs.m_}
+    , n_{rhs.n_}
+{}
+
+template <class T>
+Broadcast<T>::Broadcast(Broadcast&& rhs)
+    : base{std::move(rhs.base)}
+    , m_{rhs.m_}
+    , n_{rhs.n_}
+{}
+
+// Assigning a Broadcast rebinds the view instead of writing element-wise through it
+template <class T>
+Broadcast<T>& Broadcast<T>::operator=(const Broadcast& rhs) {
+    this->base = rhs.base;
+    this->m_ = rhs.m_;
+    this->n_ = rhs.n_;
+    return *this;
+}
+
+template <class T>
+Broadcast<T>& Broadcast<T>::operator=(Broadcast&& rhs) {
+    this->base = std::move(rhs.base);
+    this->m_ = rhs.m_;
+    this->n_ = rhs.n_;
+    return *this;
+}
+
+/**========================================================================
+ *!                           Indexing
+ *========================================================================**/
+template <class T>
+std::size_t Broadcast<T>::nrow() const {
+    return this->m_;
+}
+
+template <class T>
+std::size_t Broadcast<T>::ncol() const {
+    return this->n_;
+}
+
+template <class T>
+T& Broadcast<T>::operator[](int k) {
+    const std::size_t i = (base.m == 1) ? 0 : k % m_;
+    const std::size_t j = (base.n == 1) ? 0 : k / m_;
+    return base.data[i + j * base.m];
+}
+
+template <class T>
+const T& Broadcast<T>::operator[](int k) const {
+    const std::size_t i = (base.m == 1) ? 0 : k % m_;
+    const std::size_t j = (base.n == 1) ? 0 : k / m_;
+    return base.data[i + j * base.m];
+}
+
+template <class T>
+Matrix<T> Broadcast<T>::to_matrix() const {
+    Matrix<T> out (m_, n_);
+    broadcast::apply(out.data.get(), m_, n_,
+                     base.data.get(), base.m, base.n,
+                     base.data.get(), base.m, base.n,
+                     [] (T a, T) { return a; });
+    return out;
+}
+
+/**========================================================================
+ *!                           Fused arithmetic
+ *========================================================================**/
+template <class T>
+template <class Op>
+Matrix<T> Broadcast<T>::combine(const Matrix<T>& rhs, Op op) const {
+
+    if (!broadcast::compatible(m_, n_, rhs.m, rhs.n)) throw std::runtime_error("Operands could not be broadcast together");
+
+    const auto [m, n] = broadcast::shape(m_, n_, rhs.m, rhs.n);
+    // The base of this view stretches to (m x n) since it already stretches to (m_ x n_)
+    Matrix<T> out (m, n);
+    broadcast::apply(out.data.get(), m, n,
+                     base.data.get(), base.m, base.n,
+                     rhs.data.get(), rhs.m, rhs.n,
+                     op);
+    return out;
+}
+
+template <class T>
+template <class Op>
+Matrix<T> Broadcast<T>::combine(const Broadcast& rhs, Op op) const {
+
+    if (!broadcast::compatible(m_, n_, rhs.m_, rhs.n_)) throw std::runtime_error("Operands could not be broadcast together");
+
+    const auto [m, n] = broadcast::shape(m_, n_, rhs.m_, rhs.n_);
+    Matrix<T> out (m, n);
+    broadcast::apply(out.data.get(), m, n,
+                     base.data.get(), base.m, base.n,
+                     rhs.base.data.get(), rhs.base.m, rhs.base.n,
+                     op);
+    return out;
+}
+
+/**========================================================================
+ *!                           Factory
+ *========================================================================**/
+// Stretch a row vector, column vector or scalar matrix to (m x n) without copying it
+template <class T>
+Broadcast<T> broadcast_to(const Matrix<T>& x, std::size_t m, std::size_t n) {
+    return Broadcast<T>(x, m, n);
+}
+
+};
@@ -33,6 +33,39 @@ const T& Grid1D<T>::at(int i) const {
     return this->operator[](i - 1);
 }
 
+/**========================================================================
+ *!                           Iterators
+ *========================================================================**/
+template <class T>
+typename Grid1D<T>::iterator Grid1D<T>::begin() {
+    return iterator(this, 0);
+}
+
+template <class T>
+typename Grid1D<T>::iterator Grid1D<T>::end() {
+    return iterator(this, this->size());
+}
+
+template <class T>
+typename Grid1D<T>::const_iterator Grid1D<T>::begin() const {
+    return const_iterator(this, 0);
+}
+
+template <class T>
+typename Grid1D<T>::const_iterator Grid1D<T>::end() const {
+    return const_iterator(this, this->size());
+}
+
+template <class T>
+typename Grid1D<T>::const_iterator Grid1D<T>::cbegin() const {
+    return this->begin();
+}
+
+template <class T>
+typename Grid1D<T>::const_iterator Grid1D<T>::cend() const {
+    return this->end();
+}
+
 template <class T>
 T& Grid1D<T>::first() {
     return this->operator()(1);
@@ -5,6 +5,8 @@
 // #include "ejovo/rng/Xoshiro.hpp"
 #include "ejovo/rng/rng.hpp"
 #include "ejovo/core.hpp"
+#include "ejovo/linalg/blas.hpp"
+#include "ejovo/linalg/strassen.hpp"
 
 namespace ejovo {
 
@@ -18,6 +20,36 @@ std::size_t Matrix<T>::ncol() const {
     return this->n;
 }
 
+template <class T>
+T* Matrix<T>::begin() {
+    return this->data.get();
+}
+
+template <class T>
+T* Matrix<T>::end() {
+    return this->data.get() + this->size();
+}
+
+template <class T>
+const T* Matrix<T>::begin() const {
+    return this->data.get();
+}
+
+template <class T>
+const T* Matrix<T>::end() const {
+    return this->data.get() + this->size();
+}
+
+template <class T>
+const T* Matrix<T>::cbegin() const {
+    return this->begin();
+}
+
+template <class T>
+const T* Matrix<T>::cend() const {
+    return this->end();
+}
+
 /**========================================================================
  *!                           Trigonometric functions
  *========================================================================**/
@@ -308,31 +340,64 @@ Matrix<T> Matrix<T>::transpose() const {
 template <class T>
 Matrix<T>& Matrix<T>::operator+=(const Matrix& rhs) {
 
-    if (this->cant_add_b(rhs)) {
+    if (!this->can_broadcast_into(rhs)) {
         std::cerr << "Trying to add incompatible matrices\n";
         return *this;
     }
-    // element-wise addition
-    this->loop_i([&] (int i) {
-        this->at(i) += rhs(i);
-    });
+    // element-wise addition, stretching rhs if needed
+    broadcast::apply(this->data.get(), this->m, this->n,
+                     this->data.get(), this->m, this->n,
+                     rhs.data.get(), rhs.m, rhs.n,
+                     std::plus<T>{});
     return *this;
 }
 
 template <class T>
 Matrix<T>& Matrix<T>::operator-=(const Matrix& rhs) {
 
-    if (this->cant_add_b(rhs)) {
+    if (!this->can_broadcast_into(rhs)) {
         std::cerr << "Trying to add incompatible matrices\n";
         return *this;
     }
-    // element-wise addition
-    this->loop_i([&] (int i) {
-        this->at(i) -= rhs(i);
-    });
+    broadcast::apply(this->data.get(), this->m, this->n,
+                     this->data.get(), this->m, this->n,
+                     rhs.data.get(), rhs.m, rhs.n,
+                     std::minus<T>{});
     return *this;
 }
 
+template <class T>
+Matrix<T>& Matrix<T>::operator/=(const Matrix& rhs) {
+
+    if (!this->can_broadcast_into(rhs)) {
+        std::cerr << "Not the same size, cant perform element-wise division\n";
+        return *this;
+    }
+    broadcast::apply(this->data.get(), this->m, this->n,
+                     this->data.get(), this->m, this->n,
+                     rhs.data.get(), rhs.m, rhs.n,
+                     std::divides<T>{});
+    return *this;
+}
+
+template <class T>
+template <class U, class Op>
+Matrix<U> Matrix<T>::broadcast_with(const Matrix& rhs, Op op) const {
+
+    if (!this->can_broadcast(rhs)) {
+        std::cerr << "Operands could not be broadcast together\n";
+        return Matrix<U>::null();
+    }
+
+    const auto [m, n] = broadcast::shape(this->m, this->n, rhs.m, rhs.n);
+    Matrix<U> out (m, n);
+    broadcast::apply(out.data.get(), m, n,
+                     this->data.get(), this->m, this->n,
+                     rhs.data.get(), rhs.m, rhs.n,
+                     op);
+    return out;
+}
+
 //========================= Scalar operations ====================
 template <class T>
 Matrix<T>& Matrix<T>::operator+=(const T scalar) {
@@ -378,13 +443,14 @@ Matrix<T> Matrix<T>::operator-() const {
 template <class T>
 Matrix<T>& Matrix<T>::operator%=(const Matrix& rhs) {
 
-    if (this->size() != rhs.size()) {
+    if (!this->can_broadcast_into(rhs)) {
         std::cerr << "Not the same size, cant perform hadamard multiplication\n";
         return *this;
     }
-    this->loop_i([&] (int i) {
-        this->at(i) *= rhs(i);
-    });
+    broadcast::apply(this->data.get(), this->m, this->n,
+                     this->data.get(), this->m, this->n,
+                     rhs.data.get(), rhs.m, rhs.n,
+                     std::multiplies<T>{});
     return *this;
 }
 
@@ -399,26 +465,32 @@ T Matrix<T>::dot(const Matrix& rhs, int i, int j) const {
     return total;
 }
 
+// Materialize A ⊗ B. Prefer the lazy ejovo::linalg::Kronecker operator when only
+// products with vectors are needed.
 template <class T>
 Matrix<T> Matrix<T>::kronecker_product(const Matrix& rhs) const {
 
-    Matrix out{Matrix<T>::zeros(this->m * rhs.m, this->n * rhs.n)};
+    const std::size_t p = rhs.m;
+    const std::size_t q = rhs.n;
+    Matrix out (this->m * p, this->n * q);
 
-    int block_rowmaj_pos = 0;
+    const T *a = this->data.get();
+    const T *b = rhs.data.get();
+    T *o = out.data.get();
 
-    // I think I need a function to set a block matrix..
-    auto set_block = [&] (int i, int j) {
+    // Block (i, j) of the output is a(i, j) * rhs; fill it one output column at a time
+    for (std::size_t j = 0; j < this->n; j++) {
+        for (std::size_t c = 0; c < q; c++) {
 
-        MatView block{out, ejovo::seq<int>(i, i + rhs.m - 1), ejovo::seq<int>(j, j + rhs.n - 1)}; // construct the block view
-        block = rhs * this->operator[](block_rowmaj_pos);
+            T *ocol = o + (j * q + c) * out.m;
+            const T *bcol = b + c * p;
 
-    };
-
-    // Equipped with the basics of views, I think I'm ready to tackle this function!
-    for (std::size_t i = 1; i < out.m; i += rhs.m) {
-        for (std::size_t j = 1; j < out.n; j += rhs.n) {
-            set_block(i, j);
-            block_rowmaj_pos ++;
+            for (std::size_t i = 0; i < this->m; i++) {
+                const T aij = a[i + j * this->m];
+                for (std::size_t r = 0; r < p; r++) {
+                    ocol[i * p + r] = aij * bcol[r];
+                }
+            }
         }
     }
 
@@ -433,19 +505,34 @@ Matrix<T> Matrix<T>::operator*(const Matrix&rhs) const {
         std::cerr << "Can't multiply matrices\n";
         return zeros(1);
     }
-    // o(n3), so we will have 3 loops
 
-    // create output matrix
-    Matrix out{this->m, rhs.n};
+    // Matrix-vector products are memory bound and skip the packing of gemm
+    if (rhs.n == 1) {
+        Matrix out{this->m, 1};
+        blas::gemv(blas::Op::N, this->m, this->n, T(1), this->data.get(), this->m, rhs.data.get(), T(0), out.data.get());
+        return out;
+    }
 
-    for (std::size_t i = 1; i <= out.m; i++) {
-        for (std::size_t j = 1; j <= out.n; j++) {
-            out(i, j) = this->dot(rhs, i, j);
-        }
+    // x^T A = (A^T x)^T, as when propagating a distribution through a transition matrix
+    if (this->m == 1) {
+        Matrix out{1, rhs.n};
+        blas::gemv(blas::Op::T, rhs.m, rhs.n, T(1), rhs.data.get(), rhs.m, this->data.get(), T(0), out.data.get());
+        return out;
     }
+
+    // Packed, blocked and threaded product, see ejovo/linalg/blas.hpp, or Strassen-Winograd
+    // for very large products when blas::strassen_config() enables it
+    Matrix out{this->m, rhs.n};
+    blas::multiply<T>(this->m, rhs.n, this->n, this->data.get(), this->m, rhs.data.get(), rhs.m,
+                      out.data.get(), out.m);
     return out;
 }
 
+template <class T>
+void Matrix<T>::apply(const T *x, T *y) const {
+    blas::gemv(blas::Op::N, this->m, this->n, T(1), this->data.get(), this->m, x, T(0), y);
+}
+
 template <class T>
 Matrix<T> Matrix<T>::operator^(int k) const {
 
@@ -454,10 +541,29 @@ Matrix<T> Matrix<T>::operator^(int k) const {
     if (k == 0) return Matrix<T>::id(n);
     if (k == 1) return *this;
 
-    Matrix<T> out (*this);
+    // Binary exponentiation: about 2 log2(k) products instead of k - 1. The three
+    // buffers are reused, every product writing into `tmp` before being swapped in.
+    const std::size_t N = this->n;
+    Matrix<T> base (*this);
+    Matrix<T> out;
+    Matrix<T> tmp (N, N);
+    bool first = true;
 
-    for (int i = 2; i <= k; i++) {
-        out = out * *this;
+    auto mult = [&] (Matrix<T>& lhs, const Matrix<T>& rhs) {
+        blas::multiply<T>(N, N, N, lhs.data.get(), N, rhs.data.get(), N, tmp.data.get(), N);
+        lhs.data.swap(tmp.data);
+    };
+
+    for (unsigned int e = k; e > 0; e >>= 1) {
+        if (e & 1) {
+            if (first) {
+                out = base;
+                first = false;
+            } else {
+                mult(out, base);
+            }
+        }
+        if (e > 1) mult(base, base);
     }
 
     return out;
@@ -587,10 +693,15 @@ Matrix<T> Matrix<T>::id(int n) {
     return out;
 }
 
-// template <class T>
-// Matrix<T> Matrix<T>::id(int m, int n) {
-
-// }
+// Rectangular identity: ones on the main diagonal, zeros elsewhere
+template <class T>
+Matrix<T> Matrix<T>::id(int m, int n) {
+    Matrix out = zeros(m, n);
+    for (int k = 0; k < std::min(m, n); k++) {
+        out.data[k + k * m] = 1;
+    }
+    return out;
+}
 
 template <class T>
 Matrix<T> Matrix<T>::i(int n) {
@@ -789,17 +900,36 @@ bool Matrix<T>::cant_add_b(const Matrix &rhs) const {
     return !(this->is_same_shape(rhs));
 }
 
+template <class T>
+template <class U>
+bool Matrix<T>::can_broadcast(const Matrix<U>& rhs) const {
+    return broadcast::compatible(this->m, this->n, rhs.m, rhs.n);
+}
+
+template <class T>
+template <class U>
+bool Matrix<T>::can_broadcast_into(const Matrix<U>& rhs) const {
+    return broadcast::stretches_to(rhs.m, rhs.n, this->m, this->n);
+}
+
 template <class T>
 Matrix<T> Matrix<T>::get_row(int i) const {
-    Matrix row_i (1, this->m);
+    Matrix row_i (1, this->n);
 
-    for (std::size_t j = 1; j <= this->m; j++) {
+    for (std::size_t j = 1; j <= this->n; j++) {
         row_i(j) = this->operator()(i, j);
     }
 
     return row_i;
 }
 
+template <class T>
+Matrix<T> Matrix<T>::get_col(int j) const {
+    Matrix col_j (this->m, 1);
+    std::copy_n(this->data.get() + (j - 1) * this->m, this->m, col_j.data.get());
+    return col_j;
+}
+
 /**========================================================================
  *!                           Ejovo interface
  *========================================================================**/
@@ -965,14 +1095,16 @@ Matrix<T> Matrix<T>::rand() {
 template <class T>
 Matrix<T> Matrix<T>::rand(int n, double min, double max) {
     Matrix out (1, n);
-    out.loop_i([&] (int i) { out(i) = ejovo::rng::g_XOSHIRO.unifd(min, max); });
+    auto& g = ejovo::rng::engine();
+    out.loop_i([&] (int i) { out(i) = g.unifd(min, max); });
     return out;
 }
 
 template <class T>
 Matrix<T> Matrix<T>::rand(int m, int n,  double min, double max) {
     Matrix out (m, n);
-    out.loop_i([&] (int i) { out(i) = ejovo::rng::g_XOSHIRO.unifd(min, max); });
+    auto& g = ejovo::rng::engine();
+    out.loop_i([&] (int i) { out(i) = g.unifd(min, max); });
     return out;
 }
 
@@ -1056,6 +1188,26 @@ Matrix<bool> Matrix<T>::operator>=(const T& rhs) const {
 //     return this->binop_k(ejovo::eq<T>, rhs);
 // }
 
+template <class T>
+Matrix<bool> Matrix<T>::operator<(const Matrix& rhs) const {
+    return this->broadcast_with<bool>(rhs, std::less<T>{});
+}
+
+template <class T>
+Matrix<bool> Matrix<T>::operator<=(const Matrix& rhs) const {
+    return this->broadcast_with<bool>(rhs, std::less_equal<T>{});
+}
+
+template <class T>
+Matrix<bool> Matrix<T>::operator>(const Matrix& rhs) const {
+    return this->broadcast_with<bool>(rhs, std::greater<T>{});
+}
+
+template <class T>
+Matrix<bool> Matrix<T>::operator>=(const Matrix& rhs) const {
+    return this->broadcast_with<bool>(rhs, std::greater_equal<T>{});
+}
+
 template <>
 Matrix<int> Matrix<bool>::which() const {
 
@@ -1195,22 +1347,34 @@ typename Matrix<T>::MatView Matrix<T>::block(int i, int j, int m, int n) {
 // template <class T>
 // typename Matrix<T>::BoolView
 
+// Doolittle factorization A = L U without pivoting. Use ejovo::linalg::LU for a
+// pivoted, blocked factorization that can be reused to solve systems.
 template <class T>
 std::tuple<Matrix<T>, Matrix<T>> Matrix<T>::lu() const {
 
     // let's only accept square matrices....
     if (!this->is_square()) return std::make_tuple(Matrix<T>::null(), Matrix<T>::null());
 
-    Matrix L = Matrix<T>::id(this->m);
+    const std::size_t n = this->m;
+    Matrix L = Matrix<T>::id(n);
     Matrix U = this->clone();
 
-    for (std::size_t j = 1; j < L.n; j++) {
-        for (std::size_t i = j + 1; i <= L.m; i++) {
+    T *l = L.data.get();
+    T *u = U.data.get();
 
-            T scalar = U(i, j) / U(j, j);
-            U.rows({i}, j) = U.rows({i}, j) - scalar * U.rows({j}, j);
-            L(i, j) = scalar;
+    for (std::size_t j = 0; j + 1 < n; j++) {
+
+        const T pivot = u[j + j * n];
+        for (std::size_t i = j + 1; i < n; i++) {
+            l[i + j * n] = u[i + j * n] / pivot;
+            u[i + j * n] = 0;
+        }
 
+        // eliminate below the pivot one column at a time
+        for (std::size_t k = j + 1; k < n; k++) {
+            T *uk = u + k * n;
+            const T ujk = uk[j];
+            for (std::size_t i = j + 1; i < n; i++) uk[i] -= l[i + j * n] * ujk;
         }
     }
 
@@ -223,7 +223,7 @@ Vector<T> Vector<T>::from(std::initializer_list<T> list, bool col) {
 }
 
 template <class T>
-ejovo::rng::Xoshiro& Vector<T>::xoroshiro = ejovo::rng::g_XOSHIRO;
+thread_local ejovo::rng::Xoshiro& Vector<T>::xoroshiro = ejovo::rng::engine();
 
 template <class T> std::unique_ptr<T[]> Vector<T>::copy_data() const {
     // this->print();
@@ -3,9 +3,11 @@
 #pragma once
 
 #include "ejovo/rng/Xoshiro.hpp"
+#include "ejovo/rng/philox.hpp"
 #include "ejovo/rng/rng.hpp"
 #include "ejovo/rng/openmp.hpp"
 #include "ejovo/core.hpp"
+#include "ejovo/views.hpp"
 #include "ejovo/diffyq.hpp"
 #include "ejovo/discrete.hpp"
 #include "ejovo/factory.hpp"
@@ -18,5 +20,6 @@
 #include "ejovo/quadrature.hpp"
 #include "ejovo/trig.hpp"
 #include "ejovo/rng/mcmc.hpp"
+#include "ejovo/qmc.hpp"
 #include "ejovo/monte_carlo.hpp"
 #include "ejovo/linear.hpp"
@@ -142,28 +142,24 @@ Matrix<T> chebynodes(T a, T b, int n = 100) {
 }
 
 
+// Return the grids X(i, j) = u(i) and Y(i, j) = v(j) as lazy broadcast views:
+// only u and v are stored, stretched virtually to u.size() x v.size().
+// Call .to_matrix() on a grid to materialize it.
 template <class T>
-std::tuple<Matrix<T>, Matrix<T>> meshgrid(const Matrix<T>& u, const Matrix<T>& v) {
+std::tuple<Broadcast<T>, Broadcast<T>> meshgrid(const Matrix<T>& u, const Matrix<T>& v) {
 
-    // Matrix m1 = Matrix<T>::zeros(u.size(), v.size());
-    // Matrix m2 = m1.clone();
+    const std::size_t m = u.size();
+    const std::size_t n = v.size();
 
-    Matrix m1 = u.repcol(v.size());
-    Matrix m2 = v.reprow(u.size());
+    Broadcast<T> m1 (u.as_colvec(), m, n);
+    Broadcast<T> m2 (v.as_rowvec(), m, n);
 
-    return std::make_tuple(m1, m2);
+    return std::make_tuple(std::move(m1), std::move(m2));
 }
 
 template <class T>
-std::tuple<Matrix<T>, Matrix<T>> meshgrid(const Matrix<T>& u) {
-
-    // Matrix m1 = Matrix<T>::zeros(u.size(), v.size());
-    // Matrix m2 = m1.clone();
-
-    Matrix m1 = u.repcol(u.size());
-    Matrix m2 = u.reprow(u.size());
-
-    return std::make_tuple(m1, m2);
+std::tuple<Broadcast<T>, Broadcast<T>> meshgrid(const Matrix<T>& u) {
+    return meshgrid(u, u);
 }
 
 /**========================================================================
@@ -0,0 +1,383 @@
+/**========================================================================
+ * ?                          batched.hpp
+ * @brief   : Batches of small fixed-size matrices in struct-of-arrays layout
+ * @details : A Batch<T, M, N> holds `count` M x N matrices. Element (i, j) of
+ *            every matrix is stored contiguously across the batch,
+ *
+ *                data[(i + j M) count + b]  = element (i, j) of matrix b,
+ *
+ *            so every kernel is a fixed, fully unrolled sequence of operations
+ *            over (i, j) whose innermost loop runs over the batch: it
+ *            vectorizes across matrices instead of within one tiny matrix, and
+ *            there is a single allocation for the whole batch.
+ *
+ *            The kernels work on chunks of `batch_chunk` matrices, copied into
+ *            stack buffers that stay in L1; chunks are spread over threads.
+ *            Partial pivoting in the LU kernels is done lane by lane with
+ *            selects, so it does not break vectorization either. Elements are
+ *            reached through raw pointers (the batch storage and Matrix::data),
+ *            never through the virtual operator[], size(), nrow() and ncol()
+ *            that Matrix inherits from Grid1D and Grid2D, so no call stands in
+ *            the way of inlining and vectorizing the inner loops.
+ *
+ *            Singular or non positive definite members do not throw: their
+ *            results contain infinities or NaNs, which det() can screen.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    /**
+     * @brief `count` matrices of size M x N, interleaved element by element
+     *
+     * Indices are 0-based: at(b, i, j) is element (i, j) of matrix b.
+     */
+    template <class T, std::size_t M, std::size_t N = M>
+    class Batch {
+
+    public:
+
+        static constexpr std::size_t rows = M;
+        static constexpr std::size_t cols = N;
+
+        Batch() = default;
+        explicit Batch(std::size_t count) : count_{count}, data_(M * N * count) {}
+
+        // Every member equal to the identity (M x M batches only)
+        static Batch identity(std::size_t count) {
+            static_assert(M == N, "The identity is only defined for square batches");
+            Batch out (count);
+            for (std::size_t i = 0; i < M; i++) std::fill_n(out.element(i, i), count, T(1));
+            return out;
+        }
+
+        std::size_t size() const { return count_; }
+
+        T& at(std::size_t b, std::size_t i, std::size_t j) { return data_[(i + j * M) * count_ + b]; }
+        const T& at(std::size_t b, std::size_t i, std::size_t j) const { return data_[(i + j * M) * count_ + b]; }
+
+        // Element (i, j) of all the matrices, `size()` contiguous values
+        T *element(std::size_t i, std::size_t j) { return data_.data() + (i + j * M) * count_; }
+        const T *element(std::size_t i, std::size_t j) const { return data_.data() + (i + j * M) * count_; }
+
+        // Copy matrix b out of, or into, the batch
+        Matrix<T> get(std::size_t b) const {
+            Matrix<T> out (M, N);
+            for (std::size_t j = 0; j < N; j++) {
+                for (std::size_t i = 0; i < M; i++) out.data[i + j * M] = at(b, i, j);
+            }
+            return out;
+        }
+
+        void set(std::size_t b, const Matrix<T>& A) {
+            if (A.nrow() != M || A.ncol() != N) throw std::runtime_error("Matrix does not match the batch dimensions");
+            for (std::size_t j = 0; j < N; j++) {
+                for (std::size_t i = 0; i < M; i++) at(b, i, j) = A.data[i + j * M];
+            }
+        }
+
+    private:
+
+        std::size_t count_ = 0;
+        std::vector<T> data_;
+
+    };
+
+    namespace detail {
+
+        inline constexpr std::size_t batch_chunk = 64;
+
+        // f(b0, len) on consecutive chunks of at most batch_chunk matrices
+        template <class F>
+        void for_each_chunk(std::size_t count, F&& f) {
+            const std::size_t chunks = (count + batch_chunk - 1) / batch_chunk;
+            #pragma omp parallel for if(count >= 64 * batch_chunk) schedule(static)
+            for (std::size_t c = 0; c < chunks; c++) {
+                const std::size_t b0 = c * batch_chunk;
+                f(b0, std::min(batch_chunk, count - b0));
+            }
+        }
+
+        // Local R x C block of a chunk: buf[i + j R][lane]
+        template <class T, std::size_t R, std::size_t C, std::size_t Rows, std::size_t Cols>
+        void load(const Batch<T, Rows, Cols>& A, std::size_t b0, std::size_t len, T (&buf)[R * C][batch_chunk]) {
+            for (std::size_t e = 0; e < R * C; e++) {
+                const T *src = A.element(e % R, e / R) + b0;
+                #pragma omp simd
+                for (std::size_t l = 0; l < len; l++) buf[e][l] = src[l];
+            }
+        }
+
+        template <class T, std::size_t R, std::size_t C, std::size_t Rows, std::size_t Cols>
+        void store(const T (&buf)[R * C][batch_chunk], Batch<T, Rows, Cols>& A, std::size_t b0, std::size_t len) {
+            for (std::size_t e = 0; e < R * C; e++) {
+                T *dst = A.element(e % R, e / R) + b0;
+                #pragma omp simd
+                for (std::size_t l = 0; l < len; l++) dst[l] = buf[e][l];
+            }
+        }
+
+        /**
+         * @brief Gaussian elimination with partial pivoting on a chunk of M x M matrices
+         *
+         * a is reduced to U in place and the same row operations are applied to the
+         * M x R right hand sides x. sign receives the parity of the row interchanges.
+         */
+        template <class T, std::size_t M, std::size_t R>
+        void eliminate(std::size_t len, T (&a)[M * M][batch_chunk], T (&x)[M * R > 0 ? M * R : 1][batch_chunk],
+                       T (&sign)[batch_chunk]) {
+
+            #pragma omp simd
+            for (std::size_t l = 0; l < len; l++) sign[l] = T(1);
+
+            for (std::size_t k = 0; k < M; k++) {
+
+                // pivot row of every lane
+                unsigned piv[batch_chunk];
+                #pragma omp simd
+                for (std::size_t l = 0; l < len; l++) {
+                    unsigned p = k;
+                    T best = std::abs(a[k + k * M][l]);
+                    for (std::size_t i = k + 1; i < M; i++) {
+                        const T v = std::abs(a[i + k * M][l]);
+                        if (v > best) {
+                            best = v;
+                            p = i;
+                        }
+                    }
+                    piv[l] = p;
+                    sign[l] = (p != k) ? -sign[l] : sign[l];
+                }
+
+                // interchange rows k and piv, as selects
+                for (std::size_t i = k + 1; i < M; i++) {
+                    for (std::size_t j = k; j < M; j++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) {
+                            const bool swap = piv[l] == i;
+                            const T u = a[k + j * M][l], v = a[i + j * M][l];
+                            a[k + j * M][l] = swap ? v : u;
+                            a[i + j * M][l] = swap ? u : v;
+                        }
+                    }
+                    for (std::size_t j = 0; j < R; j++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) {
+                            const bool swap = piv[l] == i;
+                            const T u = x[k + j * M][l], v = x[i + j * M][l];
+                            x[k + j * M][l] = swap ? v : u;
+                            x[i + j * M][l] = swap ? u : v;
+                        }
+                    }
+                }
+
+                // eliminate below the pivot
+                for (std::size_t i = k + 1; i < M; i++) {
+                    T f[batch_chunk];
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) f[l] = a[i + k * M][l] / a[k + k * M][l];
+                    for (std::size_t j = k + 1; j < M; j++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) a[i + j * M][l] -= f[l] * a[k + j * M][l];
+                    }
+                    for (std::size_t j = 0; j < R; j++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) x[i + j * M][l] -= f[l] * x[k + j * M][l];
+                    }
+                }
+            }
+        }
+
+        // x <- U^{-1} x for the upper triangle of a chunk of M x M matrices
+        template <class T, std::size_t M, std::size_t R>
+        void back_substitute(std::size_t len, const T (&a)[M * M][batch_chunk], T (&x)[M * R][batch_chunk]) {
+            for (std::size_t j = 0; j < R; j++) {
+                for (std::size_t k = M; k-- > 0;) {
+                    for (std::size_t c = k + 1; c < M; c++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) x[k + j * M][l] -= a[k + c * M][l] * x[c + j * M][l];
+                    }
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) x[k + j * M][l] /= a[k + k * M][l];
+                }
+            }
+        }
+
+        // Lower Cholesky factor of a chunk of M x M matrices, in place
+        template <class T, std::size_t M>
+        void potrf_chunk(std::size_t len, T (&a)[M * M][batch_chunk]) {
+            for (std::size_t j = 0; j < M; j++) {
+                for (std::size_t c = 0; c < j; c++) {
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) a[j + j * M][l] -= a[j + c * M][l] * a[j + c * M][l];
+                }
+                #pragma omp simd
+                for (std::size_t l = 0; l < len; l++) a[j + j * M][l] = std::sqrt(a[j + j * M][l]);
+
+                for (std::size_t i = j + 1; i < M; i++) {
+                    for (std::size_t c = 0; c < j; c++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) a[i + j * M][l] -= a[i + c * M][l] * a[j + c * M][l];
+                    }
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) a[i + j * M][l] /= a[j + j * M][l];
+                }
+                for (std::size_t i = 0; i < j; i++) {
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) a[i + j * M][l] = T(0);
+                }
+            }
+        }
+
+    };
+
+    /**
+     * @brief Batched product C_b = A_b B_b
+     */
+    template <class T, std::size_t M, std::size_t K, std::size_t N>
+    Batch<T, M, N> operator*(const Batch<T, M, K>& A, const Batch<T, K, N>& B) {
+
+        if (A.size() != B.size()) throw std::runtime_error("Batches have different sizes");
+        Batch<T, M, N> C (A.size());
+
+        detail::for_each_chunk(A.size(), [&] (std::size_t b0, std::size_t len) {
+            for (std::size_t j = 0; j < N; j++) {
+                for (std::size_t i = 0; i < M; i++) {
+                    T *c = C.element(i, j) + b0;
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) c[l] = T(0);
+                    for (std::size_t p = 0; p < K; p++) {
+                        const T *a = A.element(i, p) + b0, *b = B.element(p, j) + b0;
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) c[l] += a[l] * b[l];
+                    }
+                }
+            }
+        });
+
+        return C;
+    }
+
+    /**
+     * @brief Solve A_b X_b = B_b for every member, by LU with partial pivoting
+     */
+    template <class T, std::size_t M, std::size_t R>
+    Batch<T, M, R> solve(const Batch<T, M, M>& A, const Batch<T, M, R>& B) {
+
+        if (A.size() != B.size()) throw std::runtime_error("Batches have different sizes");
+        Batch<T, M, R> X (A.size());
+
+        detail::for_each_chunk(A.size(), [&] (std::size_t b0, std::size_t len) {
+            T a[M * M][detail::batch_chunk], x[M * R][detail::batch_chunk], sign[detail::batch_chunk];
+            detail::load<T, M, M>(A, b0, len, a);
+            detail::load<T, M, R>(B, b0, len, x);
+            detail::eliminate<T, M, R>(len, a, x, sign);
+            detail::back_substitute<T, M, R>(len, a, x);
+            detail::store<T, M, R>(x, X, b0, len);
+        });
+
+        return X;
+    }
+
+    // Inverse of every member
+    template <class T, std::size_t M>
+    Batch<T, M, M> inv(const Batch<T, M, M>& A) {
+        return solve(A, Batch<T, M, M>::identity(A.size()));
+    }
+
+    // Determinant of every member, as a column vector
+    template <class T, std::size_t M>
+    Matrix<T> det(const Batch<T, M, M>& A) {
+
+        Matrix<T> out (A.size(), 1);
+
+        detail::for_each_chunk(A.size(), [&] (std::size_t b0, std::size_t len) {
+            T a[M * M][detail::batch_chunk], none[1][detail::batch_chunk], sign[detail::batch_chunk];
+            detail::load<T, M, M>(A, b0, len, a);
+            detail::eliminate<T, M, 0>(len, a, none, sign);
+            T *d = out.data.get() + b0;
+            #pragma omp simd
+            for (std::size_t l = 0; l < len; l++) d[l] = sign[l];
+            for (std::size_t k = 0; k < M; k++) {
+                #pragma omp simd
+                for (std::size_t l = 0; l < len; l++) d[l] *= a[k + k * M][l];
+            }
+        });
+
+        return out;
+    }
+
+    /**
+     * @brief Lower Cholesky factor L_b of every symmetric positive definite member
+     *
+     * Only the lower triangles are read.
+     */
+    template <class T, std::size_t M>
+    Batch<T, M, M> cholesky(const Batch<T, M, M>& A) {
+        Batch<T, M, M> L (A.size());
+        detail::for_each_chunk(A.size(), [&] (std::size_t b0, std::size_t len) {
+            T a[M * M][detail::batch_chunk];
+            detail::load<T, M, M>(A, b0, len, a);
+            detail::potrf_chunk<T, M>(len, a);
+            detail::store<T, M, M>(a, L, b0, len);
+        });
+        return L;
+    }
+
+    /**
+     * @brief Solve A_b X_b = B_b for symmetric positive definite members, A_b = L_b L_b^T
+     */
+    template <class T, std::size_t M, std::size_t R>
+    Batch<T, M, R> cholesky_solve(const Batch<T, M, M>& A, const Batch<T, M, R>& B) {
+
+        if (A.size() != B.size()) throw std::runtime_error("Batches have different sizes");
+        Batch<T, M, R> X (A.size());
+
+        detail::for_each_chunk(A.size(), [&] (std::size_t b0, std::size_t len) {
+
+            T a[M * M][detail::batch_chunk], x[M * R][detail::batch_chunk];
+            detail::load<T, M, M>(A, b0, len, a);
+            detail::load<T, M, R>(B, b0, len, x);
+            detail::potrf_chunk<T, M>(len, a);
+
+            for (std::size_t j = 0; j < R; j++) {
+                // L y = b
+                for (std::size_t k = 0; k < M; k++) {
+                    for (std::size_t c = 0; c < k; c++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) x[k + j * M][l] -= a[k + c * M][l] * x[c + j * M][l];
+                    }
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) x[k + j * M][l] /= a[k + k * M][l];
+                }
+                // L^T x = y
+                for (std::size_t k = M; k-- > 0;) {
+                    for (std::size_t c = k + 1; c < M; c++) {
+                        #pragma omp simd
+                        for (std::size_t l = 0; l < len; l++) x[k + j * M][l] -= a[c + k * M][l] * x[c + j * M][l];
+                    }
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < len; l++) x[k + j * M][l] /= a[k + k * M][l];
+                }
+            }
+
+            detail::store<T, M, R>(x, X, b0, len);
+        });
+
+        return X;
+    }
+
+    };
+
+};
@@ -0,0 +1,655 @@
+/**========================================================================
+ * ?                          blas.hpp
+ * @brief   : Dense level-2 and level-3 kernels on raw column-major storage
+ * @details : The kernels follow the BLAS calling convention (0-based pointers,
+ *            leading dimensions, op flags) so that the factorizations in
+ *            ejovo::linalg can run on sub-blocks of a Matrix without building
+ *            views or temporaries. Matrix stores its elements column-major,
+ *            so `A.data.get()` with `lda = A.m` is a valid operand.
+ *
+ *            gemm is a GotoBLAS-style blocked product: op(B) is packed into
+ *            KC x NC panels, op(A) into MC x KC blocks, and an MR x NR register
+ *            micro-kernel that the compiler vectorizes does the flops. Blocks of
+ *            rows of C are distributed across OpenMP threads. gemv and ger are
+ *            memory bound: they stream A once and are threaded by rows or
+ *            columns so that no reduction across threads is needed.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace ejovo {
+
+    namespace blas {
+
+    enum class Op { N, T };             // no transpose, transpose
+    enum class Uplo { Lower, Upper };   // which triangle is referenced
+    enum class Side { Left, Right };    // op(A) X = B or X op(A) = B
+    enum class Diag { NonUnit, Unit };  // Unit: the diagonal of A is assumed to be 1
+
+    // Products with fewer flops than this run single-threaded
+    inline constexpr std::size_t parallel_flops = 1 << 18;
+
+    // Threads available to a kernel; kernels called from inside a parallel region run serially
+    inline int max_threads() {
+#ifdef _OPENMP
+        return omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    namespace detail {
+
+        // Register block of C computed by the micro-kernel, and cache blocks of A and B
+        inline constexpr std::size_t MR = 8;
+        inline constexpr std::size_t NR = 4;
+        inline constexpr std::size_t MC = 128;
+        inline constexpr std::size_t KC = 256;
+        inline constexpr std::size_t NC = 2048;
+
+        // Pack the mc x kc block of op(A) starting at (i0, p0) into MR-row slivers,
+        // padding the last sliver with zeros. The loop order follows the storage of A
+        // so that reads stay contiguous.
+        template <class T>
+        void pack_a(Op op, const T *A, std::size_t lda, std::size_t i0, std::size_t p0,
+                    std::size_t mc, std::size_t kc, T *Ap) {
+
+            for (std::size_t is = 0; is < mc; is += MR) {
+                const std::size_t mr = std::min(MR, mc - is);
+                if (op == Op::N) {
+                    for (std::size_t p = 0; p < kc; p++) {
+                        const T *a = A + (i0 + is) + (p0 + p) * lda;
+                        for (std::size_t i = 0; i < mr; i++) Ap[p * MR + i] = a[i];
+                        for (std::size_t i = mr; i < MR; i++) Ap[p * MR + i] = T(0);
+                    }
+                } else {
+                    for (std::size_t i = 0; i < mr; i++) {
+                        const T *a = A + p0 + (i0 + is + i) * lda;
+                        for (std::size_t p = 0; p < kc; p++) Ap[p * MR + i] = a[p];
+                    }
+                    for (std::size_t i = mr; i < MR; i++) {
+                        for (std::size_t p = 0; p < kc; p++) Ap[p * MR + i] = T(0);
+                    }
+                }
+                Ap += MR * kc;
+            }
+        }
+
+        // Pack the single NR-column sliver of op(B) starting at (p0, j0)
+        template <class T>
+        void pack_b_sliver(Op op, const T *B, std::size_t ldb, std::size_t p0, std::size_t j0,
+                           std::size_t kc, std::size_t nr, T *Bp) {
+
+            if (op == Op::N) {
+                for (std::size_t j = 0; j < nr; j++) {
+                    const T *b = B + p0 + (j0 + j) * ldb;
+                    for (std::size_t p = 0; p < kc; p++) Bp[p * NR + j] = b[p];
+                }
+                for (std::size_t j = nr; j < NR; j++) {
+                    for (std::size_t p = 0; p < kc; p++) Bp[p * NR + j] = T(0);
+                }
+            } else {
+                for (std::size_t p = 0; p < kc; p++) {
+                    const T *b = B + j0 + (p0 + p) * ldb;
+                    for (std::size_t j = 0; j < nr; j++) Bp[p * NR + j] = b[j];
+                    for (std::size_t j = nr; j < NR; j++) Bp[p * NR + j] = T(0);
+                }
+            }
+        }
+
+        // C(0:mr, 0:nr) += alpha * Ap * Bp for packed slivers of depth kc
+        template <class T>
+        inline void micro_kernel(std::size_t kc, T alpha, const T *__restrict Ap, const T *__restrict Bp,
+                                 T *C, std::size_t ldc, std::size_t mr, std::size_t nr) {
+
+            T acc[NR][MR] = {};
+
+            for (std::size_t p = 0; p < kc; p++) {
+                for (std::size_t j = 0; j < NR; j++) {
+                    const T b = Bp[j];
+                    for (std::size_t i = 0; i < MR; i++) {
+                        acc[j][i] += Ap[i] * b;
+                    }
+                }
+                Ap += MR;
+                Bp += NR;
+            }
+
+            for (std::size_t j = 0; j < nr; j++) {
+                for (std::size_t i = 0; i < mr; i++) {
+                    C[i + j * ldc] += alpha * acc[j][i];
+                }
+            }
+        }
+
+        // C += alpha op(A) op(B) with straightforward loops, for products too small to pack
+        template <class T>
+        void gemm_small(Op ta, Op tb, std::size_t m, std::size_t n, std::size_t k, T alpha,
+                        const T *A, std::size_t lda, const T *B, std::size_t ldb, T *C, std::size_t ldc) {
+
+            for (std::size_t j = 0; j < n; j++) {
+                T *c = C + j * ldc;
+                if (ta == Op::N) {
+                    for (std::size_t p = 0; p < k; p++) {
+                        const T b = alpha * ((tb == Op::N) ? B[p + j * ldb] : B[j + p * ldb]);
+                        const T *a = A + p * lda;
+                        for (std::size_t i = 0; i < m; i++) c[i] += a[i] * b;
+                    }
+                } else {
+                    for (std::size_t i = 0; i < m; i++) {
+                        const T *a = A + i * lda;
+                        T total = 0;
+                        #pragma omp simd reduction(+:total)
+                        for (std::size_t p = 0; p < k; p++) {
+                            total += a[p] * ((tb == Op::N) ? B[p + j * ldb] : B[j + p * ldb]);
+                        }
+                        c[i] += alpha * total;
+                    }
+                }
+            }
+        }
+
+        template <class T>
+        void scale(std::size_t m, std::size_t n, T beta, T *C, std::size_t ldc) {
+            if (beta == T(1)) return;
+            for (std::size_t j = 0; j < n; j++) {
+                T *c = C + j * ldc;
+                if (beta == T(0)) {
+                    for (std::size_t i = 0; i < m; i++) c[i] = T(0);
+                } else {
+                    for (std::size_t i = 0; i < m; i++) c[i] *= beta;
+                }
+            }
+        }
+
+    };
+
+    /**
+     * @brief General matrix product C = alpha op(A) op(B) + beta C
+     *
+     * op(A) is m x k, op(B) is k x n and C is m x n, all column-major. When beta is 0,
+     * C does not need to be initialized.
+     */
+    template <class T>
+    void gemm(Op ta, Op tb, std::size_t m, std::size_t n, std::size_t k, T alpha,
+              const T *A, std::size_t lda, const T *B, std::size_t ldb,
+              T beta, T *C, std::size_t ldc) {
+
+        using namespace detail;
+
+        if (m == 0 || n == 0) return;
+        scale(m, n, beta, C, ldc);
+        if (k == 0 || alpha == T(0)) return;
+
+        const std::size_t flops = m * n * k;
+        if (flops <= 32 * 32 * 32) {
+            gemm_small(ta, tb, m, n, k, alpha, A, lda, B, ldb, C, ldc);
+            return;
+        }
+
+        const bool parallel = flops >= parallel_flops && max_threads() > 1;
+        const std::size_t nthreads = parallel ? max_threads() : 1;
+
+        // Shrink the row blocks when there are too few of them to keep every thread busy
+        std::size_t mc = std::min(MC, (m + nthreads - 1) / nthreads);
+        mc = std::max(MR, ((mc + MR - 1) / MR) * MR);
+
+        const std::size_t nc_max = std::min(NC, n);
+        const std::size_t kc_max = std::min(KC, k);
+        std::vector<T> Bp (((nc_max + NR - 1) / NR) * NR * kc_max);
+
+        #pragma omp parallel if(parallel)
+        {
+            std::vector<T> Ap (((mc + MR - 1) / MR) * MR * kc_max);
+
+            for (std::size_t jc = 0; jc < n; jc += NC) {
+
+                const std::size_t nc = std::min(NC, n - jc);
+                const std::size_t n_slivers = (nc + NR - 1) / NR;
+
+                for (std::size_t pc = 0; pc < k; pc += KC) {
+
+                    const std::size_t kc = std::min(KC, k - pc);
+
+                    #pragma omp for schedule(static)
+                    for (std::size_t s = 0; s < n_slivers; s++) {
+                        const std::size_t nr = std::min(NR, nc - s * NR);
+                        pack_b_sliver(tb, B, ldb, pc, jc + s * NR, kc, nr, Bp.data() + s * NR * kc);
+                    }
+
+                    #pragma omp for schedule(dynamic)
+                    for (std::size_t ic = 0; ic < m; ic += mc) {
+
+                        const std::size_t mcb = std::min(mc, m - ic);
+                        pack_a(ta, A, lda, ic, pc, mcb, kc, Ap.data());
+
+                        for (std::size_t jr = 0; jr < nc; jr += NR) {
+                            const std::size_t nr = std::min(NR, nc - jr);
+                            const T *bp = Bp.data() + (jr / NR) * NR * kc;
+
+                            for (std::size_t ir = 0; ir < mcb; ir += MR) {
+                                const std::size_t mr = std::min(MR, mcb - ir);
+                                micro_kernel(kc, alpha, Ap.data() + (ir / MR) * MR * kc, bp,
+                                             C + (ic + ir) + (jc + jr) * ldc, ldc, mr, nr);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Matrix-vector product y = alpha op(A) x + beta y, A m x n
+     *
+     * Op::N splits the rows of A across threads, each thread sweeping its slice of
+     * every column into a local accumulator, so that no reduction is needed; Op::T
+     * computes dot products against x, one thread per group of columns. Both
+     * stream A exactly once and handle four columns per pass over x or y.
+     */
+    template <class T>
+    void gemv(Op op, std::size_t m, std::size_t n, T alpha, const T *A, std::size_t lda,
+              const T *x, T beta, T *y) {
+
+        const std::size_t leny = (op == Op::N) ? m : n;
+        const bool parallel = m * n >= parallel_flops;
+
+        if (m == 0 || n == 0 || alpha == T(0)) {
+            for (std::size_t i = 0; i < leny; i++) y[i] = (beta == T(0)) ? T(0) : beta * y[i];
+            return;
+        }
+
+        const std::size_t n4 = n - n % 4;
+
+        if (op == Op::N) {
+
+            constexpr std::size_t chunk = 512;
+            const std::size_t n_chunks = (m + chunk - 1) / chunk;
+
+            #pragma omp parallel for if(parallel) schedule(static)
+            for (std::size_t c = 0; c < n_chunks; c++) {
+
+                const std::size_t i0 = c * chunk, len = std::min(m, i0 + chunk) - i0;
+                T acc[chunk];
+                for (std::size_t i = 0; i < len; i++) acc[i] = T(0);
+
+                for (std::size_t j = 0; j < n4; j += 4) {
+                    const T x0 = x[j], x1 = x[j + 1], x2 = x[j + 2], x3 = x[j + 3];
+                    const T *a0 = A + i0 + j * lda, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+                    #pragma omp simd
+                    for (std::size_t i = 0; i < len; i++) acc[i] += a0[i] * x0 + a1[i] * x1 + a2[i] * x2 + a3[i] * x3;
+                }
+                for (std::size_t j = n4; j < n; j++) {
+                    const T xj = x[j];
+                    const T *a = A + i0 + j * lda;
+                    #pragma omp simd
+                    for (std::size_t i = 0; i < len; i++) acc[i] += a[i] * xj;
+                }
+
+                T *yc = y + i0;
+                if (beta == T(0)) {
+                    for (std::size_t i = 0; i < len; i++) yc[i] = alpha * acc[i];
+                } else {
+                    for (std::size_t i = 0; i < len; i++) yc[i] = alpha * acc[i] + beta * yc[i];
+                }
+            }
+
+        } else {
+
+            auto finish = [&] (std::size_t j, T total) {
+                y[j] = alpha * total + ((beta == T(0)) ? T(0) : beta * y[j]);
+            };
+
+            #pragma omp parallel for if(parallel) schedule(static)
+            for (std::size_t j = 0; j < n4; j += 4) {
+                const T *a0 = A + j * lda, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+                T t0 = 0, t1 = 0, t2 = 0, t3 = 0;
+                #pragma omp simd reduction(+:t0, t1, t2, t3)
+                for (std::size_t i = 0; i < m; i++) {
+                    const T xi = x[i];
+                    t0 += a0[i] * xi;
+                    t1 += a1[i] * xi;
+                    t2 += a2[i] * xi;
+                    t3 += a3[i] * xi;
+                }
+                finish(j, t0);
+                finish(j + 1, t1);
+                finish(j + 2, t2);
+                finish(j + 3, t3);
+            }
+
+            for (std::size_t j = n4; j < n; j++) {
+                const T *a = A + j * lda;
+                T total = 0;
+                #pragma omp simd reduction(+:total)
+                for (std::size_t i = 0; i < m; i++) total += a[i] * x[i];
+                finish(j, total);
+            }
+        }
+    }
+
+    /**
+     * @brief Rank-1 update A = A + alpha x y^T, A m x n
+     *
+     * x and y are read with strides incx and incy, so rows of a column-major matrix
+     * can be passed with incy = lda. Columns of A are updated independently.
+     */
+    template <class T>
+    void ger(std::size_t m, std::size_t n, T alpha, const T *x, std::size_t incx,
+             const T *y, std::size_t incy, T *A, std::size_t lda) {
+
+        if (m == 0 || n == 0 || alpha == T(0)) return;
+
+        #pragma omp parallel for if(m * n >= parallel_flops) schedule(static)
+        for (std::size_t j = 0; j < n; j++) {
+            const T a = alpha * y[j * incy];
+            if (a == T(0)) continue;
+            T *col = A + j * lda;
+            if (incx == 1) {
+                #pragma omp simd
+                for (std::size_t i = 0; i < m; i++) col[i] += x[i] * a;
+            } else {
+                for (std::size_t i = 0; i < m; i++) col[i] += x[i * incx] * a;
+            }
+        }
+    }
+
+    namespace detail {
+
+        // Serial SYRK: C is swept in column blocks so that the off-diagonal part runs
+        // through gemm and only the small diagonal blocks compute their unused half.
+        template <class T>
+        void syrk_blocked(Uplo uplo, Op op, std::size_t n, std::size_t k, T alpha, const T *A, std::size_t lda,
+                          T beta, T *C, std::size_t ldc) {
+
+            const std::size_t nb = 128;
+            const Op opt = (op == Op::N) ? Op::T : Op::N;
+            std::vector<T> diag (std::min(nb, n) * std::min(nb, n));
+
+            // first row (op N) or column (op T) of op(A) block i
+            auto block = [&] (std::size_t i) { return (op == Op::N) ? A + i : A + i * lda; };
+
+            for (std::size_t j = 0; j < n; j += nb) {
+
+                const std::size_t jb = std::min(nb, n - j);
+
+                // diagonal block, computed in full and copied into its triangle
+                gemm(op, opt, jb, jb, k, alpha, block(j), lda, block(j), lda, T(0), diag.data(), jb);
+                for (std::size_t c = 0; c < jb; c++) {
+                    T *cc = C + j + (j + c) * ldc;
+                    const std::size_t i0 = (uplo == Uplo::Lower) ? c : 0;
+                    const std::size_t i1 = (uplo == Uplo::Lower) ? jb : c + 1;
+                    for (std::size_t i = i0; i < i1; i++) {
+                        cc[i] = ((beta == T(0)) ? T(0) : beta * cc[i]) + diag[i + c * jb];
+                    }
+                }
+
+                // off-diagonal panel: below the block for Lower, to its right for Upper
+                if (j + jb < n) {
+                    const std::size_t r = n - j - jb;
+                    if (uplo == Uplo::Lower) {
+                        gemm(op, opt, r, jb, k, alpha, block(j + jb), lda, block(j), lda,
+                             beta, C + (j + jb) + j * ldc, ldc);
+                    } else {
+                        gemm(op, opt, jb, r, k, alpha, block(j), lda, block(j + jb), lda,
+                             beta, C + j + (j + jb) * ldc, ldc);
+                    }
+                }
+            }
+        }
+
+    };
+
+    /**
+     * @brief Symmetric rank-k update C = alpha op(A) op(A)^T + beta C
+     *
+     * Op::N computes A A^T with A n x k, Op::T computes A^T A with A k x n. Only the
+     * `uplo` triangle of the n x n matrix C is referenced and updated.
+     *
+     * gemm threads over blocks of rows of C, which starves when C is small and k is
+     * long (the Gram matrix of a tall data matrix). In that case the k dimension is
+     * split across threads instead, each accumulating a private triangle, and the
+     * triangles are summed at the end.
+     */
+    template <class T>
+    void syrk(Uplo uplo, Op op, std::size_t n, std::size_t k, T alpha, const T *A, std::size_t lda,
+              T beta, T *C, std::size_t ldc) {
+
+        if (n == 0) return;
+
+        const std::size_t nthreads = max_threads();
+        const bool split_k = nthreads > 1 && n * n * k >= parallel_flops && k >= 8 * n * nthreads;
+
+        if (!split_k) {
+            detail::syrk_blocked(uplo, op, n, k, alpha, A, lda, beta, C, ldc);
+            return;
+        }
+
+        std::vector<T> partial (nthreads * n * n, T(0));
+
+        #pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+        for (std::size_t t = 0; t < nthreads; t++) {
+            const std::size_t k0 = (k * t) / nthreads, k1 = (k * (t + 1)) / nthreads;
+            const T *a = (op == Op::N) ? A + k0 * lda : A + k0;
+            if (k1 > k0) detail::syrk_blocked(uplo, op, n, k1 - k0, alpha, a, lda, T(0), partial.data() + t * n * n, n);
+        }
+
+        #pragma omp parallel for schedule(static)
+        for (std::size_t j = 0; j < n; j++) {
+            const std::size_t i0 = (uplo == Uplo::Lower) ? j : 0;
+            const std::size_t i1 = (uplo == Uplo::Lower) ? n : j + 1;
+            for (std::size_t i = i0; i < i1; i++) {
+                T total = 0;
+                for (std::size_t t = 0; t < nthreads; t++) total += partial[t * n * n + i + j * n];
+                C[i + j * ldc] = ((beta == T(0)) ? T(0) : beta * C[i + j * ldc]) + total;
+            }
+        }
+    }
+
+    namespace detail {
+
+        // Unblocked op(A) X = B for a single right hand side column b of length n
+        template <class T>
+        void trsv(Uplo uplo, Op op, Diag diag, std::size_t n, const T *A, std::size_t lda, T *b) {
+
+            const bool unit = diag == Diag::Unit;
+
+            if (op == Op::N) {
+                if (uplo == Uplo::Lower) {
+                    for (std::size_t k = 0; k < n; k++) {
+                        if (!unit) b[k] /= A[k + k * lda];
+                        const T bk = b[k];
+                        const T *a = A + k * lda;
+                        for (std::size_t i = k + 1; i < n; i++) b[i] -= bk * a[i];
+                    }
+                } else {
+                    for (std::size_t k = n; k-- > 0;) {
+                        if (!unit) b[k] /= A[k + k * lda];
+                        const T bk = b[k];
+                        const T *a = A + k * lda;
+                        for (std::size_t i = 0; i < k; i++) b[i] -= bk * a[i];
+                    }
+                }
+            } else {
+                if (uplo == Uplo::Lower) {
+                    // L^T is upper triangular: eliminate from the bottom using columns of L
+                    for (std::size_t k = n; k-- > 0;) {
+                        const T *a = A + k * lda;
+                        T total = b[k];
+                        #pragma omp simd reduction(-:total)
+                        for (std::size_t i = k + 1; i < n; i++) total -= a[i] * b[i];
+                        b[k] = unit ? total : total / a[k];
+                    }
+                } else {
+                    for (std::size_t k = 0; k < n; k++) {
+                        const T *a = A + k * lda;
+                        T total = b[k];
+                        #pragma omp simd reduction(-:total)
+                        for (std::size_t i = 0; i < k; i++) total -= a[i] * b[i];
+                        b[k] = unit ? total : total / a[k];
+                    }
+                }
+            }
+        }
+
+        // op(A) X = B with columns of B solved independently in parallel
+        template <class T>
+        void trsm_left_unblocked(Uplo uplo, Op op, Diag diag, std::size_t m, std::size_t n,
+                                 const T *A, std::size_t lda, T *B, std::size_t ldb) {
+
+            const bool parallel = m * m * n >= parallel_flops && n > 1;
+
+            #pragma omp parallel for if(parallel) schedule(static)
+            for (std::size_t j = 0; j < n; j++) {
+                trsv(uplo, op, diag, m, A, lda, B + j * ldb);
+            }
+        }
+
+        // Recursively split op(A) so that most of the work runs through gemm
+        template <class T>
+        void trsm_left(Uplo uplo, Op op, Diag diag, std::size_t m, std::size_t n,
+                       const T *A, std::size_t lda, T *B, std::size_t ldb) {
+
+            if (m <= 64) {
+                trsm_left_unblocked(uplo, op, diag, m, n, A, lda, B, ldb);
+                return;
+            }
+
+            const std::size_t m1 = m / 2;
+            const std::size_t m2 = m - m1;
+
+            const T *A11 = A;
+            const T *A22 = A + m1 + m1 * lda;
+            T *B1 = B;
+            T *B2 = B + m1;
+
+            // op(A) is effectively lower triangular for (Lower, N) and (Upper, T)
+            const bool eff_lower = (uplo == Uplo::Lower) == (op == Op::N);
+
+            if (eff_lower) {
+                // The off-diagonal block of op(A) is A21 (Lower, N) or A12^T (Upper, T)
+                const T *Aoff = (uplo == Uplo::Lower) ? A + m1 : A + m1 * lda;
+                trsm_left(uplo, op, diag, m1, n, A11, lda, B1, ldb);
+                gemm(op, Op::N, m2, n, m1, T(-1), Aoff, lda, B1, ldb, T(1), B2, ldb);
+                trsm_left(uplo, op, diag, m2, n, A22, lda, B2, ldb);
+            } else {
+                // The off-diagonal block of op(A) is A12 (Upper, N) or A21^T (Lower, T)
+                const T *Aoff = (uplo == Uplo::Upper) ? A + m1 * lda : A + m1;
+                trsm_left(uplo, op, diag, m2, n, A22, lda, B2, ldb);
+                gemm(op, Op::N, m1, n, m2, T(-1), Aoff, lda, B2, ldb, T(1), B1, ldb);
+                trsm_left(uplo, op, diag, m1, n, A11, lda, B1, ldb);
+            }
+        }
+
+        // X op(A) = B, updating whole columns of X; rows of B are independent
+        template <class T>
+        void trsm_right(Uplo uplo, Op op, Diag diag, std::size_t m, std::size_t n,
+                        const T *A, std::size_t lda, T *B, std::size_t ldb) {
+
+            const bool unit = diag == Diag::Unit;
+            // entry (k, j) of op(A)
+            auto a = [&] (std::size_t k, std::size_t j) { return (op == Op::N) ? A[k + j * lda] : A[j + k * lda]; };
+            // op(A) is effectively upper triangular for (Upper, N) and (Lower, T)
+            const bool eff_upper = (uplo == Uplo::Upper) == (op == Op::N);
+
+            auto solve_col = [&] (std::size_t j, std::size_t i0, std::size_t i1) {
+                T *bj = B + j * ldb;
+                if (eff_upper) {
+                    for (std::size_t k = 0; k < j; k++) {
+                        const T akj = a(k, j);
+                        const T *bk = B + k * ldb;
+                        for (std::size_t i = i0; i < i1; i++) bj[i] -= bk[i] * akj;
+                    }
+                } else {
+                    for (std::size_t k = j + 1; k < n; k++) {
+                        const T akj = a(k, j);
+                        const T *bk = B + k * ldb;
+                        for (std::size_t i = i0; i < i1; i++) bj[i] -= bk[i] * akj;
+                    }
+                }
+                if (!unit) {
+                    const T d = a(j, j);
+                    for (std::size_t i = i0; i < i1; i++) bj[i] /= d;
+                }
+            };
+
+            const std::size_t chunk = 256;
+            const std::size_t n_chunks = (m + chunk - 1) / chunk;
+            const bool parallel = m * n * n >= parallel_flops && n_chunks > 1;
+
+            #pragma omp parallel for if(parallel) schedule(static)
+            for (std::size_t c = 0; c < n_chunks; c++) {
+                const std::size_t i0 = c * chunk;
+                const std::size_t i1 = std::min(m, i0 + chunk);
+                if (eff_upper) {
+                    for (std::size_t j = 0; j < n; j++) solve_col(j, i0, i1);
+                } else {
+                    for (std::size_t j = n; j-- > 0;) solve_col(j, i0, i1);
+                }
+            }
+        }
+
+    };
+
+    /**
+     * @brief Triangular solve with multiple right hand sides
+     *
+     * Side::Left solves op(A) X = alpha B and Side::Right solves X op(A) = alpha B,
+     * overwriting B (m x n) with X. A is triangular, only its `uplo` triangle is read.
+     */
+    template <class T>
+    void trsm(Side side, Uplo uplo, Op op, Diag diag, std::size_t m, std::size_t n, T alpha,
+              const T *A, std::size_t lda, T *B, std::size_t ldb) {
+
+        if (m == 0 || n == 0) return;
+        detail::scale(m, n, alpha, B, ldb);
+
+        if (side == Side::Left) {
+            detail::trsm_left(uplo, op, diag, m, n, A, lda, B, ldb);
+        } else {
+            detail::trsm_right(uplo, op, diag, m, n, A, lda, B, ldb);
+        }
+    }
+
+    /**
+     * @brief Apply the row interchanges ipiv[k1:k2] to the n columns of A
+     *
+     * Row k is swapped with row ipiv[k] (0-based), in increasing order of k when
+     * `forward`, in decreasing order otherwise (which undoes the permutation).
+     */
+    template <class T>
+    void laswp(std::size_t n, T *A, std::size_t lda, std::size_t k1, std::size_t k2,
+               const int *ipiv, bool forward = true) {
+
+        const bool parallel = n * (k2 - k1) >= (1 << 16);
+
+        #pragma omp parallel for if(parallel) schedule(static)
+        for (std::size_t j = 0; j < n; j++) {
+            T *a = A + j * lda;
+            if (forward) {
+                for (std::size_t k = k1; k < k2; k++) {
+                    const std::size_t p = ipiv[k];
+                    if (p != k) std::swap(a[k], a[p]);
+                }
+            } else {
+                for (std::size_t k = k2; k-- > k1;) {
+                    const std::size_t p = ipiv[k];
+                    if (p != k) std::swap(a[k], a[p]);
+                }
+            }
+        }
+    }
+
+    };
+
+};
@@ -0,0 +1,253 @@
+/**========================================================================
+ * ?                          chain.hpp
+ * @brief   : Lazy matrix-chain products with optimal parenthesization
+ * @details : `A * B * C * v` evaluates left to right, forming the full matrix
+ *            products before touching v. A ProductChain instead records its
+ *            operands and, when it is evaluated, picks the parenthesization
+ *            with the fewest flops by dynamic programming over the actual
+ *            dimensions (the classical O(k^3) matrix-chain order), so that
+ *            here A (B (C v)) costs three matrix-vector products.
+ *
+ *            @code
+ *            Matrix<double> y = linalg::chain(A) * B * C * v;
+ *            auto G = linalg::multi_dot(linalg::trans(X), X, w);
+ *            @endcode
+ *
+ *            Transposes are part of the operands: trans(X) is never formed and
+ *            reaches gemm/gemv as an op flag. A product of a matrix with its own
+ *            transpose, trans(X) * X or X * X.t() (detected by value when the
+ *            transpose was materialized), is computed by SYRK, which only
+ *            forms one triangle.
+ *
+ *            The chain keeps references to its operands: evaluate it in the
+ *            same expression as any temporary it was built from.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    // Lazy transpose of a matrix, only meaningful as a ProductChain operand
+    template <class T = double>
+    struct Transpose {
+        const Matrix<T>& A;
+    };
+
+    template <class T>
+    Transpose<T> trans(const Matrix<T>& A) {
+        return Transpose<T>{A};
+    }
+
+    namespace detail {
+
+        // A stored rows x cols column-major matrix, used as op(A)
+        template <class T>
+        struct ChainOperand {
+            const T *data;
+            std::size_t rows;
+            std::size_t cols;
+            bool trans;
+
+            std::size_t nrow() const { return trans ? cols : rows; }
+            std::size_t ncol() const { return trans ? rows : cols; }
+            blas::Op op() const { return trans ? blas::Op::T : blas::Op::N; }
+        };
+
+        // Whether the stored matrices of a and b are transposes of each other, element by element
+        template <class T>
+        bool stores_transpose(const ChainOperand<T>& a, const ChainOperand<T>& b) {
+            if (a.rows != b.cols || a.cols != b.rows) return false;
+            for (std::size_t j = 0; j < a.cols; j++) {
+                for (std::size_t i = 0; i < a.rows; i++) {
+                    if (a.data[i + j * a.rows] != b.data[j + i * b.rows]) return false;
+                }
+            }
+            return true;
+        }
+
+        // op(a) op(b)
+        template <class T>
+        Matrix<T> chain_multiply(const ChainOperand<T>& a, const ChainOperand<T>& b) {
+
+            using blas::Op;
+            const std::size_t m = a.nrow(), k = a.ncol(), n = b.ncol();
+            if (b.nrow() != k) throw std::runtime_error("Product chain operands have incompatible dimensions");
+
+            Matrix<T> out (m, n);
+            T *c = out.data.get();
+
+            // op(a) op(b) = S^T S or S S^T for a single stored matrix S
+            const bool same = a.data == b.data && a.rows == b.rows && a.cols == b.cols && a.trans != b.trans;
+            if (same || (a.trans == b.trans && stores_transpose(a, b))) {
+                // the product is op(a) op(a)^T; express it through the stored matrix of a
+                const Op op = a.trans ? Op::T : Op::N;
+                blas::syrk(blas::Uplo::Lower, op, m, k, T(1), a.data, a.rows, T(0), c, m);
+                for (std::size_t j = 0; j < m; j++) {
+                    for (std::size_t i = j + 1; i < m; i++) c[j + i * m] = c[i + j * m];
+                }
+                return out;
+            }
+
+            // Vectors are contiguous whatever their orientation, so gemv applies
+            if (n == 1) {
+                blas::gemv(a.op(), a.rows, a.cols, T(1), a.data, a.rows, b.data, T(0), c);
+            } else if (m == 1) {
+                blas::gemv(b.trans ? Op::N : Op::T, b.rows, b.cols, T(1), b.data, b.rows, a.data, T(0), c);
+            } else {
+                blas::gemm(a.op(), b.op(), m, n, k, T(1), a.data, a.rows, b.data, b.rows, T(0), c, m);
+            }
+            return out;
+        }
+
+    };
+
+    /**
+     * @brief Lazily collected product op(A_1) op(A_2) ... op(A_k)
+     */
+    template <class T = double>
+    class ProductChain {
+
+    public:
+
+        ProductChain() = default;
+        ProductChain(const Matrix<T>& A) { push(A); }
+        ProductChain(Transpose<T> A) { push(A); }
+
+        ProductChain& push(const Matrix<T>& A) {
+            ops_.push_back({A.data.get(), A.nrow(), A.ncol(), false});
+            return *this;
+        }
+
+        ProductChain& push(Transpose<T> A) {
+            ops_.push_back({A.A.data.get(), A.A.nrow(), A.A.ncol(), true});
+            return *this;
+        }
+
+        ProductChain& operator*(const Matrix<T>& rhs) { return push(rhs); }
+        ProductChain& operator*(Transpose<T> rhs) { return push(rhs); }
+
+        std::size_t size() const { return ops_.size(); }
+
+        // Flops of the cheapest parenthesization, counting a multiply-add as 2
+        double flops() const {
+            if (ops_.size() < 2) return 0;
+            const auto [cost, split] = order();
+            return 2 * cost[0 + (ops_.size() - 1) * ops_.size()];
+        }
+
+        Matrix<T> eval() const {
+            if (ops_.empty()) throw std::runtime_error("Cannot evaluate an empty product chain");
+            check_dimensions();
+            const auto [cost, split] = order();
+            std::vector<Matrix<T>> keep;
+            keep.reserve(ops_.size());
+            auto result = eval(0, ops_.size() - 1, split, keep);
+            if (!keep.empty() && result.data == keep.back().data.get()) return std::move(keep.back());
+            return copy(result);
+        }
+
+        operator Matrix<T>() const { return eval(); }
+
+    private:
+
+        std::vector<detail::ChainOperand<T>> ops_;
+
+        void check_dimensions() const {
+            for (std::size_t i = 0; i + 1 < ops_.size(); i++) {
+                if (ops_[i].ncol() != ops_[i + 1].nrow()) throw std::runtime_error("Product chain operands have incompatible dimensions");
+            }
+        }
+
+        // cost(i, j) and split(i, j) of the classical matrix-chain dynamic program, stored k x k
+        std::pair<std::vector<double>, std::vector<std::size_t>> order() const {
+
+            const std::size_t k = ops_.size();
+            std::vector<double> p (k + 1);
+            for (std::size_t i = 0; i < k; i++) p[i] = double(ops_[i].nrow());
+            p[k] = double(ops_[k - 1].ncol());
+
+            std::vector<double> cost (k * k, 0);
+            std::vector<std::size_t> split (k * k, 0);
+
+            for (std::size_t len = 2; len <= k; len++) {
+                for (std::size_t i = 0; i + len <= k; i++) {
+                    const std::size_t j = i + len - 1;
+                    double best = std::numeric_limits<double>::max();
+                    for (std::size_t s = i; s < j; s++) {
+                        const double c = cost[i + s * k] + cost[(s + 1) + j * k] + p[i] * p[s + 1] * p[j + 1];
+                        if (c < best) {
+                            best = c;
+                            split[i + j * k] = s;
+                        }
+                    }
+                    cost[i + j * k] = best;
+                }
+            }
+
+            return {cost, split};
+        }
+
+        // Evaluate the sub-chain i..j; computed intermediates are owned by `keep`
+        detail::ChainOperand<T> eval(std::size_t i, std::size_t j, const std::vector<std::size_t>& split,
+                                     std::vector<Matrix<T>>& keep) const {
+            if (i == j) return ops_[i];
+            const std::size_t s = split[i + j * ops_.size()];
+            const auto left = eval(i, s, split, keep);
+            const auto right = eval(s + 1, j, split, keep);
+            keep.push_back(detail::chain_multiply(left, right));
+            const auto& M = keep.back();
+            return {M.data.get(), M.nrow(), M.ncol(), false};
+        }
+
+        static Matrix<T> copy(const detail::ChainOperand<T>& a) {
+            Matrix<T> out (a.nrow(), a.ncol());
+            for (std::size_t j = 0; j < a.ncol(); j++) {
+                for (std::size_t i = 0; i < a.nrow(); i++) {
+                    out.data[i + j * a.nrow()] = a.trans ? a.data[j + i * a.rows] : a.data[i + j * a.rows];
+                }
+            }
+            return out;
+        }
+
+    };
+
+    template <class T>
+    ProductChain<T> chain(const Matrix<T>& A) {
+        return ProductChain<T>(A);
+    }
+
+    template <class T>
+    ProductChain<T> chain(Transpose<T> A) {
+        return ProductChain<T>(A);
+    }
+
+    /**
+     * @brief Product of all the operands (matrices or trans(...)) in the cheapest order
+     */
+    template <class T, class... Rest>
+    Matrix<T> multi_dot(const Matrix<T>& first, const Rest&... rest) {
+        ProductChain<T> c (first);
+        (c.push(rest), ...);
+        return c.eval();
+    }
+
+    template <class T, class... Rest>
+    Matrix<T> multi_dot(Transpose<T> first, const Rest&... rest) {
+        ProductChain<T> c (first);
+        (c.push(rest), ...);
+        return c.eval();
+    }
+
+    };
+
+};
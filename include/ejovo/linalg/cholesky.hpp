@@ -0,0 +1,192 @@
+/**========================================================================
+ * ?                          cholesky.hpp
+ * @brief   : Blocked Cholesky factorization of symmetric positive definite matrices
+ * @details : A = L L^T is computed in place in the lower triangle of A,
+ *            right-looking, one block column at a time:
+ *
+ *              1. A11 <- chol(A11)                    (unblocked)
+ *              2. A21 <- A21 L11^{-T}                  (trsm)
+ *              3. A22 <- A22 - A21 A21^T               (syrk, lower triangle only)
+ *
+ *            The upper triangle is never read, so a matrix holding only its
+ *            lower half is a valid input. When a pivot is not positive the
+ *            matrix is not positive definite; the factorization stops and
+ *            reports the offending column instead of producing NaNs.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+#include "triangular.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    namespace detail {
+
+        // Unblocked Cholesky of the n x n lower triangle of A. Returns the 1-based
+        // column of the first non-positive pivot, 0 on success.
+        template <class T>
+        std::size_t potf2(std::size_t n, T *A, std::size_t lda) {
+
+            for (std::size_t k = 0; k < n; k++) {
+
+                T *ak = A + k * lda;
+                // !(d > 0) also catches NaN
+                if (!(ak[k] > T(0))) return k + 1;
+
+                const T d = std::sqrt(ak[k]);
+                ak[k] = d;
+                for (std::size_t i = k + 1; i < n; i++) ak[i] /= d;
+
+                for (std::size_t j = k + 1; j < n; j++) {
+                    T *aj = A + j * lda;
+                    const T ajk = ak[j];
+                    for (std::size_t i = j; i < n; i++) aj[i] -= ak[i] * ajk;
+                }
+            }
+
+            return 0;
+        }
+
+    };
+
+    /**
+     * @brief Factor the lower triangle of the n x n column-major matrix A in place, A = L L^T
+     *
+     * @return 0 on success, otherwise the 1-based column at which A was found not to be
+     *         positive definite. Columns before it hold a partial factor.
+     */
+    template <class T>
+    std::size_t potrf(std::size_t n, T *A, std::size_t lda, std::size_t block = 128) {
+
+        using blas::Op, blas::Side, blas::Uplo, blas::Diag;
+
+        if (block == 0) block = 128;
+
+        for (std::size_t j = 0; j < n; j += block) {
+
+            const std::size_t jb = std::min(block, n - j);
+            T *A11 = A + j + j * lda;
+
+            const std::size_t info = detail::potf2(jb, A11, lda);
+            if (info != 0) return info + j;
+
+            if (j + jb < n) {
+
+                const std::size_t r = n - j - jb;
+                T *A21 = A11 + jb;
+
+                blas::trsm(Side::Right, Uplo::Lower, Op::T, Diag::NonUnit, r, jb, T(1), A11, lda, A21, lda);
+                blas::syrk(Uplo::Lower, Op::N, r, jb, T(-1), A21, lda, T(1), A21 + jb * lda, lda);
+            }
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Reusable Cholesky factorization of a symmetric positive definite matrix
+     *
+     * @code
+     * linalg::Cholesky ch (K);
+     * if (!ch.is_spd()) ...
+     * auto X = ch.solve(B);   // K X = B
+     * auto z = ch.L() * e;    // correlated normal deviates from iid ones
+     * @endcode
+     *
+     * @tparam T floating point type
+     */
+    template <class T = double>
+    class Cholesky {
+
+    public:
+
+        // Factor a copy of A
+        Cholesky(const Matrix<T>& A, std::size_t block = 128) : Cholesky(A.clone(), block) {}
+
+        // Factor A in place, taking over its storage. Only the lower triangle is read.
+        Cholesky(Matrix<T>&& A, std::size_t block = 128)
+            : l_{std::move(A)}
+        {
+            if (!l_.is_square()) throw std::runtime_error("Cholesky factorization requires a square matrix");
+
+            const std::size_t n = l_.nrow();
+            info_ = potrf(n, l_.data.get(), n, block);
+
+            // clear the strict upper triangle so that factors() is exactly L
+            for (std::size_t j = 1; j < n; j++) {
+                for (std::size_t i = 0; i < j; i++) l_.data[i + j * n] = T(0);
+            }
+        }
+
+        std::size_t size() const { return l_.nrow(); }
+
+        // 1-based column at which the matrix was found not to be positive definite, 0 on success
+        std::size_t info() const { return info_; }
+        bool is_spd() const { return info_ == 0; }
+
+        const Matrix<T>& factors() const { return l_; }
+        Matrix<T> L() const { return l_.clone(); }
+
+        // Overwrite B with the solution X of A X = B: forward then back substitution
+        void solve_in_place(Matrix<T>& B) const {
+            check_spd();
+            forward_sub_in_place(l_, B);
+            forward_sub_in_place(l_, B, true);
+        }
+
+        Matrix<T> solve(const Matrix<T>& B) const {
+            Matrix<T> X = B.clone();
+            solve_in_place(X);
+            return X;
+        }
+
+        Matrix<T> inv() const {
+            Matrix<T> X = Matrix<T>::id(size());
+            solve_in_place(X);
+            return X;
+        }
+
+        T det() const {
+            check_spd();
+            const std::size_t n = size();
+            T d = 1;
+            for (std::size_t k = 0; k < n; k++) d *= l_.data[k + k * n];
+            return d * d;
+        }
+
+        // log det A = 2 sum log L_ii, which does not overflow for large matrices
+        T logdet() const {
+            check_spd();
+            const std::size_t n = size();
+            T out = 0;
+            for (std::size_t k = 0; k < n; k++) out += std::log(l_.data[k + k * n]);
+            return 2 * out;
+        }
+
+    private:
+
+        Matrix<T> l_;
+        std::size_t info_;
+
+        void check_spd() const {
+            if (!is_spd()) throw std::runtime_error("Matrix is not positive definite");
+        }
+
+    };
+
+    template <class T>
+    Cholesky<T> cholesky(const Matrix<T>& A, std::size_t block = 128) {
+        return Cholesky<T>(A, block);
+    }
+
+    };
+
+};
@@ -0,0 +1,157 @@
+/**========================================================================
+ * ?                          covariance.hpp
+ * @brief   : Gram, covariance and correlation matrices of data matrices
+ * @details : The rows of X are observations and its columns variables, so for
+ *            an n x p matrix the results are p x p. Only one triangle is
+ *            computed, with blas::syrk, and then mirrored.
+ *
+ *            cov and cor need the centered matrix X - 1 mu^T. It is never
+ *            formed: X is swept in blocks of rows, each block is centered into
+ *            a small buffer (which stays in cache) and accumulated with SYRK.
+ *            The blocks are shared out between threads, each holding a private
+ *            triangle, which is what keeps tall data (n >> p) parallel.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    namespace detail {
+
+        // Copy the lower triangle of the p x p matrix C into its upper triangle
+        template <class T>
+        void mirror_lower(std::size_t p, T *C) {
+            for (std::size_t j = 0; j < p; j++) {
+                for (std::size_t i = j + 1; i < p; i++) C[j + i * p] = C[i + j * p];
+            }
+        }
+
+        template <class T>
+        std::vector<T> column_means(const Matrix<T>& X) {
+            const std::size_t n = X.nrow(), p = X.ncol();
+            std::vector<T> mu (p);
+            #pragma omp parallel for if(n * p >= blas::parallel_flops) schedule(static)
+            for (std::size_t j = 0; j < p; j++) {
+                const T *x = X.data.get() + j * n;
+                T total = 0;
+                #pragma omp simd reduction(+:total)
+                for (std::size_t i = 0; i < n; i++) total += x[i];
+                mu[j] = total / T(n);
+            }
+            return mu;
+        }
+
+        // Lower triangle of (X - 1 mu^T)^T (X - 1 mu^T) into the p x p matrix C
+        template <class T>
+        void centered_gram(const Matrix<T>& X, const T *mu, T *C) {
+
+            const std::size_t n = X.nrow(), p = X.ncol();
+            const std::size_t rows = std::clamp<std::size_t>((1 << 17) / std::max<std::size_t>(p, 1), 64, 8192);
+            const std::size_t chunks = (n + rows - 1) / rows;
+            const std::size_t nthreads = std::max<std::size_t>(1, std::min<std::size_t>(
+                (n * p * p >= blas::parallel_flops) ? blas::max_threads() : 1, chunks));
+
+            std::vector<T> partial (nthreads * p * p, T(0));
+
+            #pragma omp parallel for num_threads(nthreads) schedule(static, 1)
+            for (std::size_t t = 0; t < nthreads; t++) {
+
+                std::vector<T> buf (std::min(rows, n) * p);
+                T *Ct = partial.data() + t * p * p;
+
+                for (std::size_t c = t; c < chunks; c += nthreads) {
+                    const std::size_t i0 = c * rows, r = std::min(rows, n - i0);
+                    for (std::size_t j = 0; j < p; j++) {
+                        const T *x = X.data.get() + i0 + j * n;
+                        T *b = buf.data() + j * r;
+                        const T m = mu[j];
+                        #pragma omp simd
+                        for (std::size_t i = 0; i < r; i++) b[i] = x[i] - m;
+                    }
+                    blas::syrk(blas::Uplo::Lower, blas::Op::T, p, r, T(1), buf.data(), r, T(1), Ct, p);
+                }
+            }
+
+            for (std::size_t j = 0; j < p; j++) {
+                for (std::size_t i = j; i < p; i++) {
+                    T total = 0;
+                    for (std::size_t t = 0; t < nthreads; t++) total += partial[t * p * p + i + j * p];
+                    C[i + j * p] = total;
+                }
+            }
+        }
+
+    };
+
+    /**
+     * @brief Gram matrix X^T X
+     */
+    template <class T>
+    Matrix<T> gram(const Matrix<T>& X) {
+        const std::size_t n = X.nrow(), p = X.ncol();
+        Matrix<T> G (p, p);
+        blas::syrk(blas::Uplo::Lower, blas::Op::T, p, n, T(1), X.data.get(), n, T(0), G.data.get(), p);
+        detail::mirror_lower(p, G.data.get());
+        return G;
+    }
+
+    /**
+     * @brief Sample covariance matrix of the columns of X, normalized by n - 1
+     */
+    template <class T>
+    Matrix<T> cov(const Matrix<T>& X) {
+        const std::size_t n = X.nrow(), p = X.ncol();
+        if (n < 2) throw std::runtime_error("The covariance needs at least two observations");
+
+        const auto mu = detail::column_means(X);
+        Matrix<T> C (p, p);
+        detail::centered_gram(X, mu.data(), C.data.get());
+
+        const T scale = T(1) / T(n - 1);
+        for (std::size_t j = 0; j < p; j++) {
+            for (std::size_t i = j; i < p; i++) C.data[i + j * p] *= scale;
+        }
+        detail::mirror_lower(p, C.data.get());
+        return C;
+    }
+
+    /**
+     * @brief Pearson correlation matrix of the columns of X
+     *
+     * Constant columns have no correlation and produce NaN entries, as in R.
+     */
+    template <class T>
+    Matrix<T> cor(const Matrix<T>& X) {
+        const std::size_t n = X.nrow(), p = X.ncol();
+        if (n < 2) throw std::runtime_error("The correlation needs at least two observations");
+
+        const auto mu = detail::column_means(X);
+        Matrix<T> C (p, p);
+        detail::centered_gram(X, mu.data(), C.data.get());
+
+        std::vector<T> inv_sd (p);
+        for (std::size_t j = 0; j < p; j++) inv_sd[j] = T(1) / std::sqrt(C.data[j + j * p]);
+
+        for (std::size_t j = 0; j < p; j++) {
+            for (std::size_t i = j + 1; i < p; i++) C.data[i + j * p] *= inv_sd[i] * inv_sd[j];
+            C.data[j + j * p] = std::isfinite(inv_sd[j]) ? T(1) : std::numeric_limits<T>::quiet_NaN();
+        }
+        detail::mirror_lower(p, C.data.get());
+        return C;
+    }
+
+    };
+
+};
@@ -0,0 +1,713 @@
+/**========================================================================
+ * ?                          eigen.hpp
+ * @brief   : Dense eigenvalue solvers
+ * @details : Symmetric matrices are reduced to tridiagonal form T = Q^T A Q
+ *            with Householder reflectors, then
+ *
+ *              - all eigenpairs: implicit QL with Wilkinson shifts on T, the
+ *                Givens rotations being accumulated into the explicit Q
+ *              - a range of eigenpairs: bisection on Sturm sequences for the
+ *                eigenvalues and inverse iteration on T for the eigenvectors,
+ *                which are then mapped back with the blocked reflectors of Q.
+ *                Only O(n k) tridiagonal work is needed for k pairs.
+ *
+ *            General matrices are reduced to upper Hessenberg form and their
+ *            eigenvalues found with the Francis double shift QR iteration.
+ *            Eigenvectors of a known real eigenvalue come from inverse
+ *            iteration on an LU factorization.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+#include "lu.hpp"
+#include "qr.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    // Eigenvalues in ascending order, as a column vector, and the matching orthonormal eigenvectors
+    template <class T = double>
+    struct SymmetricEigen {
+        Matrix<T> values;
+        Matrix<T> vectors;
+    };
+
+    // Eigenvalues of a general real matrix, as real and imaginary parts
+    template <class T = double>
+    struct Eigen {
+        Matrix<T> real;
+        Matrix<T> imag;
+    };
+
+    namespace detail {
+
+        /**
+         * @brief Reduce the lower triangle of the symmetric n x n matrix A to tridiagonal form
+         *
+         * On exit d holds the diagonal, e the subdiagonal and the reflectors defining Q are
+         * stored below the subdiagonal, with the scalars in tau (n - 1 of them).
+         */
+        template <class T>
+        void sytd2(std::size_t n, T *A, std::size_t lda, T *d, T *e, T *tau) {
+
+            if (n == 0) return;
+            std::vector<T> w (n);
+
+            for (std::size_t k = 0; k + 1 < n; k++) {
+
+                const std::size_t p = n - k - 1;
+                T *v = A + (k + 1) + k * lda;
+
+                tau[k] = larfg(p, v[0], v + 1);
+                e[k] = v[0];
+
+                if (tau[k] != T(0)) {
+
+                    v[0] = T(1);
+                    T *A22 = A + (k + 1) + (k + 1) * lda;
+
+                    // w = tau A22 v, reading the lower triangle only
+                    std::fill_n(w.begin(), p, T(0));
+                    for (std::size_t j = 0; j < p; j++) {
+                        const T *a = A22 + j * lda;
+                        const T t1 = tau[k] * v[j];
+                        T t2 = 0;
+                        w[j] += t1 * a[j];
+                        for (std::size_t i = j + 1; i < p; i++) {
+                            w[i] += t1 * a[i];
+                            t2 += a[i] * v[i];
+                        }
+                        w[j] += tau[k] * t2;
+                    }
+
+                    // w <- w - (tau / 2)(w^T v) v
+                    T wv = 0;
+                    for (std::size_t i = 0; i < p; i++) wv += w[i] * v[i];
+                    const T alpha = -T(0.5) * tau[k] * wv;
+                    for (std::size_t i = 0; i < p; i++) w[i] += alpha * v[i];
+
+                    // A22 <- A22 - v w^T - w v^T
+                    for (std::size_t j = 0; j < p; j++) {
+                        T *a = A22 + j * lda;
+                        const T vj = v[j], wj = w[j];
+                        for (std::size_t i = j; i < p; i++) a[i] -= v[i] * wj + w[i] * vj;
+                    }
+
+                    v[0] = e[k];
+                }
+
+                d[k] = A[k + k * lda];
+            }
+
+            d[n - 1] = A[(n - 1) + (n - 1) * lda];
+        }
+
+        // Z <- Q Z for the Q of sytd2, Z having n rows
+        template <class T>
+        void ormtr(std::size_t n, const T *A, std::size_t lda, const T *tau, T *Z, std::size_t ldz, std::size_t cols,
+                   std::size_t block = 32) {
+
+            if (n < 3) return;
+
+            // The reflectors are laid out like a QR factorization of A(1:n, 0:n-1)
+            const std::size_t m = n - 1, k = n - 2;
+            const T *V = A + 1;
+            std::vector<T> Tm (block * block);
+
+            for (std::size_t j = ((k - 1) / block) * block + block; j > 0;) {
+                j -= block;
+                const std::size_t jb = std::min(block, k - j);
+                const T *Vj = V + j + j * lda;
+                larft(m - j, jb, Vj, lda, tau + j, Tm.data(), block);
+                larfb(blas::Op::N, m - j, cols, jb, Vj, lda, Tm.data(), block, Z + 1 + j, ldz);
+            }
+        }
+
+        /**
+         * @brief Implicit QL with Wilkinson shifts on the symmetric tridiagonal (d, e)
+         *
+         * e[i] couples d[i] and d[i + 1]. When Z is not null, the rotations are applied
+         * to its n columns. The eigenvalues are left unsorted in d.
+         */
+        template <class T>
+        void tql(std::size_t n, T *d, T *e, T *Z, std::size_t zrows, std::size_t ldz) {
+
+            if (n == 0) return;
+            const T eps = std::numeric_limits<T>::epsilon();
+            e[n - 1] = T(0);
+
+            for (std::ptrdiff_t l = 0; l < static_cast<std::ptrdiff_t>(n); l++) {
+
+                int iter = 0;
+                std::ptrdiff_t m;
+
+                do {
+                    for (m = l; m < static_cast<std::ptrdiff_t>(n) - 1; m++) {
+                        const T dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                        if (std::abs(e[m]) <= eps * dd) break;
+                    }
+
+                    if (m != l) {
+
+                        if (iter++ == 60) throw std::runtime_error("Tridiagonal QL iteration did not converge");
+
+                        T g = (d[l + 1] - d[l]) / (2 * e[l]);
+                        T r = std::hypot(g, T(1));
+                        g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+
+                        T s = 1, c = 1, p = 0;
+                        std::ptrdiff_t i;
+
+                        for (i = m - 1; i >= l; i--) {
+
+                            T f = s * e[i];
+                            const T b = c * e[i];
+                            e[i + 1] = (r = std::hypot(f, g));
+
+                            if (r == T(0)) {
+                                d[i + 1] -= p;
+                                e[m] = T(0);
+                                break;
+                            }
+
+                            s = f / r;
+                            c = g / r;
+                            g = d[i + 1] - p;
+                            r = (d[i] - g) * s + 2 * c * b;
+                            d[i + 1] = g + (p = s * r);
+                            g = c * r - b;
+
+                            if (Z) {
+                                T *zi = Z + i * ldz;
+                                T *zi1 = Z + (i + 1) * ldz;
+                                for (std::size_t k = 0; k < zrows; k++) {
+                                    f = zi1[k];
+                                    zi1[k] = s * zi[k] + c * f;
+                                    zi[k] = c * zi[k] - s * f;
+                                }
+                            }
+                        }
+
+                        if (r == T(0) && i >= l) continue;
+                        d[l] -= p;
+                        e[l] = g;
+                        e[m] = T(0);
+                    }
+                } while (m != l);
+            }
+        }
+
+        // Number of eigenvalues of the tridiagonal (d, e) strictly less than x
+        template <class T>
+        std::size_t sturm_count(std::size_t n, const T *d, const T *e, T x) {
+
+            const T tiny = std::numeric_limits<T>::min();
+            std::size_t count = 0;
+            T q = d[0] - x;
+            if (q < 0) count++;
+
+            for (std::size_t i = 1; i < n; i++) {
+                if (q == T(0)) q = tiny;
+                q = d[i] - x - e[i - 1] * e[i - 1] / q;
+                if (q < 0) count++;
+            }
+            return count;
+        }
+
+        // k-th smallest (0-based) eigenvalue of the tridiagonal (d, e) by bisection in [lo, hi]
+        template <class T>
+        T bisect(std::size_t n, const T *d, const T *e, std::size_t k, T lo, T hi) {
+
+            const T eps = std::numeric_limits<T>::epsilon();
+            for (int it = 0; it < 200; it++) {
+                const T mid = lo + (hi - lo) / 2;
+                if (hi - lo <= 2 * eps * std::max(std::abs(lo), std::abs(hi)) || mid == lo || mid == hi) break;
+                if (sturm_count(n, d, e, mid) <= k) lo = mid; else hi = mid;
+            }
+            return lo + (hi - lo) / 2;
+        }
+
+        /**
+         * @brief Solve (T - shift I) x = b for the tridiagonal T = (d, e), overwriting b
+         *
+         * LU with partial pivoting; exactly zero pivots are nudged so that inverse
+         * iteration with a converged eigenvalue still produces a large, finite vector.
+         */
+        template <class T>
+        void tridiagonal_shifted_solve(std::size_t n, const T *d, const T *e, T shift, T *b, T tiny) {
+
+            std::vector<T> dl (e, e + n - 1), du (e, e + n - 1), dd (n), du2 (n, T(0));
+            std::vector<char> swapped (n, 0);
+            for (std::size_t i = 0; i < n; i++) dd[i] = d[i] - shift;
+
+            for (std::size_t i = 0; i + 1 < n; i++) {
+                if (std::abs(dd[i]) >= std::abs(dl[i])) {
+                    if (dd[i] == T(0)) dd[i] = tiny;
+                    const T fact = dl[i] / dd[i];
+                    dl[i] = fact;
+                    dd[i + 1] -= fact * du[i];
+                } else {
+                    const T fact = dd[i] / dl[i];
+                    dd[i] = dl[i];
+                    dl[i] = fact;
+                    const T temp = du[i];
+                    du[i] = dd[i + 1];
+                    dd[i + 1] = temp - fact * dd[i + 1];
+                    if (i + 2 < n) {
+                        du2[i] = du[i + 1];
+                        du[i + 1] = -fact * du[i + 1];
+                    }
+                    swapped[i] = 1;
+                }
+            }
+            if (dd[n - 1] == T(0)) dd[n - 1] = tiny;
+
+            for (std::size_t i = 0; i + 1 < n; i++) {
+                if (!swapped[i]) {
+                    b[i + 1] -= dl[i] * b[i];
+                } else {
+                    const T temp = b[i];
+                    b[i] = b[i + 1];
+                    b[i + 1] = temp - dl[i] * b[i];
+                }
+            }
+
+            b[n - 1] /= dd[n - 1];
+            if (n < 2) return;
+            b[n - 2] = (b[n - 2] - du[n - 2] * b[n - 1]) / dd[n - 2];
+            for (std::size_t i = n - 2; i-- > 0;) {
+                b[i] = (b[i] - du[i] * b[i + 1] - du2[i] * b[i + 2]) / dd[i];
+            }
+        }
+
+        template <class T>
+        T norm2(std::size_t n, const T *x) {
+            T s = 0;
+            #pragma omp simd reduction(+:s)
+            for (std::size_t i = 0; i < n; i++) s += x[i] * x[i];
+            return std::sqrt(s);
+        }
+
+        // Sort eigenvalues ascending, permuting the columns of Z along with them
+        template <class T>
+        void sort_eigenpairs(std::size_t n, T *d, T *Z, std::size_t zrows, std::size_t ldz) {
+
+            std::vector<std::size_t> idx (n);
+            std::iota(idx.begin(), idx.end(), 0);
+            std::stable_sort(idx.begin(), idx.end(), [&] (std::size_t a, std::size_t b) { return d[a] < d[b]; });
+
+            std::vector<T> dsorted (n);
+            for (std::size_t i = 0; i < n; i++) dsorted[i] = d[idx[i]];
+            std::copy(dsorted.begin(), dsorted.end(), d);
+
+            if (Z) {
+                std::vector<T> Zs (zrows * n);
+                for (std::size_t j = 0; j < n; j++) std::copy_n(Z + idx[j] * ldz, zrows, Zs.data() + j * zrows);
+                for (std::size_t j = 0; j < n; j++) std::copy_n(Zs.data() + j * zrows, zrows, Z + j * ldz);
+            }
+        }
+
+        /**
+         * @brief Eigenvalues of the upper Hessenberg matrix H by the Francis double shift QR
+         *
+         * Adapted from the EISPACK routine hqr. H is destroyed. Complex conjugate pairs
+         * are stored consecutively with the positive imaginary part first.
+         */
+        template <class T>
+        void hqr(std::size_t nsize, T *H, std::size_t ldh, T *wr_, T *wi_) {
+
+            const T eps = std::numeric_limits<T>::epsilon();
+            const int n = static_cast<int>(nsize);
+
+            // 1-based accessors, as in the original algorithm
+            auto a = [&] (int i, int j) -> T& { return H[(i - 1) + (j - 1) * ldh]; };
+            auto wr = [&] (int i) -> T& { return wr_[i - 1]; };
+            auto wi = [&] (int i) -> T& { return wi_[i - 1]; };
+
+            T anorm = 0;
+            for (int i = 1; i <= n; i++) {
+                for (int j = std::max(i - 1, 1); j <= n; j++) anorm += std::abs(a(i, j));
+            }
+
+            int nn = n, m = 0, l = 0;
+            T t = 0, p = 0, q = 0, r = 0, s = 0, w = 0, x = 0, y = 0, z = 0;
+
+            while (nn >= 1) {
+
+                int its = 0;
+
+                do {
+                    for (l = nn; l >= 2; l--) {
+                        s = std::abs(a(l - 1, l - 1)) + std::abs(a(l, l));
+                        if (s == T(0)) s = anorm;
+                        if (std::abs(a(l, l - 1)) <= eps * s) {
+                            a(l, l - 1) = T(0);
+                            break;
+                        }
+                    }
+
+                    x = a(nn, nn);
+
+                    if (l == nn) {
+                        // one root found
+                        wr(nn) = x + t;
+                        wi(nn--) = T(0);
+                    } else {
+
+                        y = a(nn - 1, nn - 1);
+                        w = a(nn, nn - 1) * a(nn - 1, nn);
+
+                        if (l == nn - 1) {
+                            // two roots found
+                            p = T(0.5) * (y - x);
+                            q = p * p + w;
+                            z = std::sqrt(std::abs(q));
+                            x += t;
+                            if (q >= T(0)) {
+                                z = p + std::copysign(z, p);
+                                wr(nn - 1) = wr(nn) = x + z;
+                                if (z != T(0)) wr(nn) = x - w / z;
+                                wi(nn - 1) = wi(nn) = T(0);
+                            } else {
+                                wr(nn - 1) = wr(nn) = x + p;
+                                wi(nn - 1) = z;
+                                wi(nn) = -z;
+                            }
+                            nn -= 2;
+
+                        } else {
+
+                            if (its == 60) throw std::runtime_error("Francis QR iteration did not converge");
+
+                            // exceptional shift
+                            if (its == 10 || its == 20) {
+                                t += x;
+                                for (int i = 1; i <= nn; i++) a(i, i) -= x;
+                                s = std::abs(a(nn, nn - 1)) + std::abs(a(nn - 1, nn - 2));
+                                y = x = T(0.75) * s;
+                                w = T(-0.4375) * s * s;
+                            }
+                            ++its;
+
+                            // look for two consecutive small subdiagonal elements
+                            for (m = nn - 2; m >= l; m--) {
+                                z = a(m, m);
+                                r = x - z;
+                                s = y - z;
+                                p = (r * s - w) / a(m + 1, m) + a(m, m + 1);
+                                q = a(m + 1, m + 1) - z - r - s;
+                                r = a(m + 2, m + 1);
+                                s = std::abs(p) + std::abs(q) + std::abs(r);
+                                p /= s;
+                                q /= s;
+                                r /= s;
+                                if (m == l) break;
+                                const T u = std::abs(a(m, m - 1)) * (std::abs(q) + std::abs(r));
+                                const T v = std::abs(p) * (std::abs(a(m - 1, m - 1)) + std::abs(z) + std::abs(a(m + 1, m + 1)));
+                                if (u <= eps * v) break;
+                            }
+
+                            for (int i = m + 2; i <= nn; i++) {
+                                a(i, i - 2) = T(0);
+                                if (i != m + 2) a(i, i - 3) = T(0);
+                            }
+
+                            // double QR step on rows l..nn, columns m..nn
+                            for (int k = m; k <= nn - 1; k++) {
+
+                                if (k != m) {
+                                    p = a(k, k - 1);
+                                    q = a(k + 1, k - 1);
+                                    r = T(0);
+                                    if (k != nn - 1) r = a(k + 2, k - 1);
+                                    if ((x = std::abs(p) + std::abs(q) + std::abs(r)) != T(0)) {
+                                        p /= x;
+                                        q /= x;
+                                        r /= x;
+                                    }
+                                }
+
+                                if ((s = std::copysign(std::sqrt(p * p + q * q + r * r), p)) != T(0)) {
+
+                                    if (k == m) {
+                                        if (l != m) a(k, k - 1) = -a(k, k - 1);
+                                    } else {
+                                        a(k, k - 1) = -s * x;
+                                    }
+
+                                    p += s;
+                                    x = p / s;
+                                    y = q / s;
+                                    z = r / s;
+                                    q /= p;
+                                    r /= p;
+
+                                    for (int j = k; j <= nn; j++) {
+                                        p = a(k, j) + q * a(k + 1, j);
+                                        if (k != nn - 1) {
+                                            p += r * a(k + 2, j);
+                                            a(k + 2, j) -= p * z;
+                                        }
+                                        a(k + 1, j) -= p * y;
+                                        a(k, j) -= p * x;
+                                    }
+
+                                    const int mmin = nn < k + 3 ? nn : k + 3;
+                                    for (int i = l; i <= mmin; i++) {
+                                        p = x * a(i, k) + y * a(i, k + 1);
+                                        if (k != nn - 1) {
+                                            p += z * a(i, k + 2);
+                                            a(i, k + 2) -= p * r;
+                                        }
+                                        a(i, k + 1) -= p * q;
+                                        a(i, k) -= p;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                } while (l < nn - 1);
+            }
+        }
+
+        // Reduce the general n x n matrix A to upper Hessenberg form by Householder similarity transforms
+        template <class T>
+        void gehd2(std::size_t n, T *A, std::size_t lda) {
+
+            std::vector<T> w (n);
+
+            for (std::size_t k = 0; k + 2 < n; k++) {
+
+                const std::size_t p = n - k - 1;
+                T *v = A + (k + 1) + k * lda;
+                const T tau = larfg(p, v[0], v + 1);
+                if (tau == T(0)) continue;
+
+                const T beta = v[0];
+                v[0] = T(1);
+
+                // A(:, k+1:n) <- A(:, k+1:n) H
+                std::fill(w.begin(), w.end(), T(0));
+                for (std::size_t j = 0; j < p; j++) {
+                    const T *a = A + (k + 1 + j) * lda;
+                    const T vj = v[j];
+                    for (std::size_t i = 0; i < n; i++) w[i] += a[i] * vj;
+                }
+                for (std::size_t j = 0; j < p; j++) {
+                    T *a = A + (k + 1 + j) * lda;
+                    const T c = tau * v[j];
+                    for (std::size_t i = 0; i < n; i++) a[i] -= w[i] * c;
+                }
+
+                // A(k+1:n, k+1:n) <- H A(k+1:n, k+1:n)
+                larf(p, p, v, tau, A + (k + 1) + (k + 1) * lda, lda);
+
+                v[0] = beta;
+                for (std::size_t i = 1; i < p; i++) v[i] = T(0);
+            }
+        }
+
+    };
+
+    /**
+     * @brief Eigen decomposition of a symmetric matrix, A = V diag(values) V^T
+     *
+     * Only the lower triangle of A is read. With `vectors = false`, only the eigenvalues
+     * are computed, in O(n^2) after the reduction.
+     */
+    template <class T>
+    SymmetricEigen<T> eigh(const Matrix<T>& A, bool vectors = true) {
+
+        if (!A.is_square()) throw std::runtime_error("eigh requires a square matrix");
+
+        const std::size_t n = A.nrow();
+        Matrix<T> work = A.clone();
+        std::vector<T> e (n), tau (n);
+
+        SymmetricEigen<T> out {Matrix<T>(n, 1), Matrix<T>::null()};
+        T *d = out.values.data.get();
+
+        detail::sytd2(n, work.data.get(), n, d, e.data(), tau.data());
+
+        if (vectors) {
+            out.vectors = Matrix<T>::id(n);
+            detail::ormtr(n, work.data.get(), n, tau.data(), out.vectors.data.get(), n, n);
+            detail::tql(n, d, e.data(), out.vectors.data.get(), n, n);
+            detail::sort_eigenpairs(n, d, out.vectors.data.get(), n, n);
+        } else {
+            detail::tql(n, d, e.data(), static_cast<T *>(nullptr), 0, 0);
+            std::sort(d, d + n);
+        }
+
+        return out;
+    }
+
+    /**
+     * @brief Eigenpairs il through iu (1-based, inclusive, counted in ascending order)
+     *
+     * Bisection and inverse iteration on the tridiagonal form: the cost beyond the
+     * reduction is proportional to the number of requested pairs, which makes this
+     * the method of choice for a few extreme eigenvalues of a large matrix.
+     */
+    template <class T>
+    SymmetricEigen<T> eigh(const Matrix<T>& A, std::size_t il, std::size_t iu, bool vectors = true) {
+
+        if (!A.is_square()) throw std::runtime_error("eigh requires a square matrix");
+
+        const std::size_t n = A.nrow();
+        if (il < 1 || iu > n || il > iu) throw std::runtime_error("Eigenvalue index range is out of bounds");
+
+        const std::size_t k = iu - il + 1;
+        Matrix<T> work = A.clone();
+        std::vector<T> d (n), e (n), tau (n);
+        detail::sytd2(n, work.data.get(), n, d.data(), e.data(), tau.data());
+
+        // Gershgorin bounds for the bisection
+        T lo = d[0], hi = d[0], tnorm = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            const T r = (i > 0 ? std::abs(e[i - 1]) : T(0)) + (i + 1 < n ? std::abs(e[i]) : T(0));
+            lo = std::min(lo, d[i] - r);
+            hi = std::max(hi, d[i] + r);
+            tnorm = std::max(tnorm, std::abs(d[i]) + r);
+        }
+        const T pad = std::numeric_limits<T>::epsilon() * std::max(tnorm, T(1)) * n;
+        lo -= pad;
+        hi += pad;
+
+        SymmetricEigen<T> out {Matrix<T>(k, 1), Matrix<T>::null()};
+        for (std::size_t j = 0; j < k; j++) {
+            out.values.data[j] = detail::bisect(n, d.data(), e.data(), il - 1 + j, lo, hi);
+        }
+        if (!vectors) return out;
+
+        Matrix<T> Z (n, k);
+        const T tiny = std::numeric_limits<T>::epsilon() * std::max(tnorm, T(1));
+        const T cluster = T(1e-3) * std::max(tnorm, T(1));
+
+        for (std::size_t j = 0; j < k; j++) {
+
+            T *z = Z.data.get() + j * n;
+            for (std::size_t i = 0; i < n; i++) z[i] = T(1) + T(0.1) * std::sin(T(i + 1) * T(j + 1));
+
+            for (int it = 0; it < 4; it++) {
+
+                detail::tridiagonal_shifted_solve(n, d.data(), e.data(), out.values.data[j], z, tiny);
+
+                // stay orthogonal to earlier vectors of the same cluster
+                for (std::size_t c = 0; c < j; c++) {
+                    if (std::abs(out.values.data[j] - out.values.data[c]) > cluster) continue;
+                    const T *zc = Z.data.get() + c * n;
+                    T dot = 0;
+                    for (std::size_t i = 0; i < n; i++) dot += zc[i] * z[i];
+                    for (std::size_t i = 0; i < n; i++) z[i] -= dot * zc[i];
+                }
+
+                const T nrm = detail::norm2(n, z);
+                for (std::size_t i = 0; i < n; i++) z[i] /= nrm;
+            }
+        }
+
+        detail::ormtr(n, work.data.get(), n, tau.data(), Z.data.get(), n, k);
+        out.vectors = std::move(Z);
+        return out;
+    }
+
+    // Eigenvalues of a symmetric matrix in ascending order
+    template <class T>
+    Matrix<T> eigvalsh(const Matrix<T>& A) {
+        return eigh(A, false).values;
+    }
+
+    /**
+     * @brief Eigenvalues of a general real matrix
+     *
+     * Hessenberg reduction followed by the Francis double shift QR. The eigenvalues are
+     * sorted by decreasing modulus, so for a transition matrix the first one is 1 and
+     * 1 - |second| is the spectral gap.
+     */
+    template <class T>
+    Eigen<T> eig(const Matrix<T>& A) {
+
+        if (!A.is_square()) throw std::runtime_error("eig requires a square matrix");
+
+        const std::size_t n = A.nrow();
+        Matrix<T> H = A.clone();
+        std::vector<T> wr (n), wi (n);
+
+        detail::gehd2(n, H.data.get(), n);
+        detail::hqr(n, H.data.get(), n, wr.data(), wi.data());
+
+        std::vector<std::size_t> idx (n);
+        std::iota(idx.begin(), idx.end(), 0);
+        std::stable_sort(idx.begin(), idx.end(), [&] (std::size_t a, std::size_t b) {
+            const T ma = std::hypot(wr[a], wi[a]), mb = std::hypot(wr[b], wi[b]);
+            if (ma != mb) return ma > mb;
+            if (wr[a] != wr[b]) return wr[a] > wr[b];
+            return wi[a] > wi[b];
+        });
+
+        Eigen<T> out {Matrix<T>(n, 1), Matrix<T>(n, 1)};
+        for (std::size_t i = 0; i < n; i++) {
+            out.real.data[i] = wr[idx[i]];
+            out.imag.data[i] = wi[idx[i]];
+        }
+        return out;
+    }
+
+    /**
+     * @brief Unit eigenvector of A for the (real) eigenvalue lambda, by inverse iteration
+     *
+     * The shift is moved off lambda by a relative 1e-10 so that the LU factorization
+     * of A - shift I exists; a few solves then amplify the wanted eigenvector by ~1e10.
+     * If the shifted matrix is still exactly singular, the offset is widened and the
+     * factorization redone.
+     */
+    template <class T>
+    Matrix<T> eigvec(const Matrix<T>& A, T lambda, int iterations = 3) {
+
+        if (!A.is_square()) throw std::runtime_error("eigvec requires a square matrix");
+
+        const std::size_t n = A.nrow();
+        const T scale = std::max(std::abs(lambda), T(1));
+
+        auto factor = [&] (T offset) {
+            Matrix<T> S = A.clone();
+            for (std::size_t i = 0; i < n; i++) S.data[i + i * n] -= lambda + offset * scale;
+            return LU<T>(std::move(S));
+        };
+
+        T offset = T(1e-10);
+        LU<T> lu = factor(offset);
+        for (int widen = 0; lu.is_singular(); widen++) {
+            if (widen == 6) throw std::runtime_error("eigvec: A - shift I stays singular near lambda");
+            offset *= T(100);
+            lu = factor(offset);
+        }
+
+        Matrix<T> x (n, 1);
+        for (std::size_t i = 0; i < n; i++) x.data[i] = T(1) + T(0.1) * std::sin(T(i + 1));
+
+        for (int it = 0; it < std::max(iterations, 1); it++) {
+            lu.solve_in_place(x);
+            const T nrm = detail::norm2(n, x.data.get());
+            if (!(nrm > T(0)) || !std::isfinite(nrm)) throw std::runtime_error("eigvec: inverse iteration broke down");
+            for (std::size_t i = 0; i < n; i++) x.data[i] /= nrm;
+        }
+
+        return x;
+    }
+
+    };
+
+};
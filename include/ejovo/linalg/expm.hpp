@@ -0,0 +1,166 @@
+/**========================================================================
+ * ?                          expm.hpp
+ * @brief   : Matrix exponential by scaling and squaring
+ * @details : exp(A) is approximated by the diagonal Padé approximant
+ *
+ *                r_m(A) = q_m(A)^{-1} p_m(A),   p_m(A) = U + V,  q_m(A) = -U + V,
+ *
+ *            with U holding the odd and V the even powers of A. Following
+ *            Higham (2005), the lowest degree m in {3, 5, 7, 9, 13} whose
+ *            backward error bound theta_m covers ||A||_1 is used; past theta_13
+ *            A is scaled by 2^{-s} and the result squared s times. Each
+ *            evaluation costs a handful of GEMMs and one LU solve.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+#include "strassen.hpp"
+#include "lu.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    namespace detail {
+
+        // Maximum absolute column sum
+        template <class T>
+        T norm1(const Matrix<T>& A) {
+            T out = 0;
+            for (std::size_t j = 0; j < A.ncol(); j++) {
+                T total = 0;
+                for (std::size_t i = 0; i < A.nrow(); i++) total += std::abs(A.data[i + j * A.nrow()]);
+                out = std::max(out, total);
+            }
+            return out;
+        }
+
+        // sum_i c[i] P[i], P[0] being the identity
+        template <class T, std::size_t K>
+        Matrix<T> combine(const std::array<double, K>& c, const std::array<const Matrix<T>*, K>& P, std::size_t n) {
+            Matrix<T> out = Matrix<T>::zeros(n, n);
+            for (std::size_t i = 0; i < n; i++) out.data[i + i * n] = T(c[0]);
+            for (std::size_t k = 1; k < K; k++) {
+                const T ck = T(c[k]);
+                const T *p = P[k]->data.get();
+                T *o = out.data.get();
+                #pragma omp simd
+                for (std::size_t i = 0; i < n * n; i++) o[i] += ck * p[i];
+            }
+            return out;
+        }
+
+        // (U, V) for the Padé approximant of degree m in {3, 5, 7, 9}, b being its coefficients
+        template <class T, std::size_t K>
+        std::pair<Matrix<T>, Matrix<T>> pade_low(const Matrix<T>& A, const std::array<double, 2 * K>& b,
+                                                  const std::array<const Matrix<T>*, K>& P) {
+            const std::size_t n = A.nrow();
+            std::array<double, K> odd, even;
+            for (std::size_t k = 0; k < K; k++) {
+                even[k] = b[2 * k];
+                odd[k] = b[2 * k + 1];
+            }
+            return {A * combine(odd, P, n), combine(even, P, n)};
+        }
+
+    };
+
+    /**
+     * @brief Matrix exponential exp(A) of a square matrix
+     *
+     * For the generator Q of a continuous-time Markov chain, expm(Q * t) is the
+     * transition matrix over a time t.
+     */
+    template <class T>
+    Matrix<T> expm(const Matrix<T>& A) {
+
+        if (!A.is_square()) throw std::runtime_error("The matrix exponential is only defined for square matrices");
+
+        const std::size_t n = A.nrow();
+        if (n == 0) return A;
+
+        constexpr std::array<double, 5> theta {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                                               2.097847961257068e0, 5.371920351148152e0};
+        const T a1 = detail::norm1(A);
+
+        auto pade_solve = [] (const Matrix<T>& U, const Matrix<T>& V) {
+            // (V - U) X = (V + U)
+            LU<T> lu (V - U);
+            Matrix<T> X = V + U;
+            lu.solve_in_place(X);
+            return X;
+        };
+
+        const Matrix<T> I = Matrix<T>::id(n);
+
+        if (a1 <= theta[3]) {
+
+            const Matrix<T> A2 = A * A;
+
+            if (a1 <= theta[0]) {
+                constexpr std::array<double, 4> b {120, 60, 12, 1};
+                auto [U, V] = detail::pade_low<T, 2>(A, b, {&I, &A2});
+                return pade_solve(U, V);
+            }
+
+            const Matrix<T> A4 = A2 * A2;
+            if (a1 <= theta[1]) {
+                constexpr std::array<double, 6> b {30240, 15120, 3360, 420, 30, 1};
+                auto [U, V] = detail::pade_low<T, 3>(A, b, {&I, &A2, &A4});
+                return pade_solve(U, V);
+            }
+
+            const Matrix<T> A6 = A4 * A2;
+            if (a1 <= theta[2]) {
+                constexpr std::array<double, 8> b {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+                auto [U, V] = detail::pade_low<T, 4>(A, b, {&I, &A2, &A4, &A6});
+                return pade_solve(U, V);
+            }
+
+            constexpr std::array<double, 10> b {17643225600, 8821612800, 2075673600, 302702400, 30270240,
+                                                2162160, 110880, 3960, 90, 1};
+            const Matrix<T> A8 = A6 * A2;
+            auto [U, V] = detail::pade_low<T, 5>(A, b, {&I, &A2, &A4, &A6, &A8});
+            return pade_solve(U, V);
+        }
+
+        // Degree 13 on A / 2^s
+        const int s = std::max(0, static_cast<int>(std::ceil(std::log2(a1 / theta[4]))));
+        const Matrix<T> As = A * T(std::ldexp(1.0, -s));
+        const Matrix<T> A2 = As * As, A4 = A2 * A2, A6 = A4 * A2;
+
+        constexpr std::array<double, 14> b {64764752532480000, 32382376266240000, 7771770303897600,
+                                            1187353796428800, 129060195264000, 10559470521600,
+                                            670442572800, 33522128640, 1323241920, 40840800,
+                                            960960, 16380, 182, 1};
+
+        // U = A [A6 (b13 A6 + b11 A4 + b9 A2) + b7 A6 + b5 A4 + b3 A2 + b1 I]
+        const Matrix<T> Uh = A6 * detail::combine<T, 4>({0, b[9], b[11], b[13]}, {&I, &A2, &A4, &A6}, n);
+        Matrix<T> U = As * (Uh + detail::combine<T, 4>({b[1], b[3], b[5], b[7]}, {&I, &A2, &A4, &A6}, n));
+
+        // V = A6 (b12 A6 + b10 A4 + b8 A2) + b6 A6 + b4 A4 + b2 A2 + b0 I
+        const Matrix<T> Vh = A6 * detail::combine<T, 4>({0, b[8], b[10], b[12]}, {&I, &A2, &A4, &A6}, n);
+        Matrix<T> V = Vh + detail::combine<T, 4>({b[0], b[2], b[4], b[6]}, {&I, &A2, &A4, &A6}, n);
+
+        Matrix<T> X = pade_solve(U, V);
+
+        // Square s times, ping-ponging between two buffers
+        Matrix<T> tmp (n, n);
+        for (int i = 0; i < s; i++) {
+            blas::multiply<T>(n, n, n, X.data.get(), n, X.data.get(), n, tmp.data.get(), n);
+            X.data.swap(tmp.data);
+        }
+
+        return X;
+    }
+
+    };
+
+};
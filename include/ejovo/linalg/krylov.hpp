@@ -0,0 +1,628 @@
+/**========================================================================
+ * ?                          krylov.hpp
+ * @brief   : Krylov subspace solvers over matrix-free operators
+ * @details : Linear systems A x = b
+ *
+ *              cg        symmetric positive definite A
+ *              bicgstab  general A, short recurrences
+ *              gmres     general A, restarted every `restart` iterations
+ *
+ *            are solved with an optional (right) preconditioner such as
+ *            Jacobi or ILU0. A few extreme eigenpairs come from lanczos
+ *            (symmetric A) or arnoldi (general A). A is only ever used through
+ *            y = A x, see operator.hpp.
+ *
+ *            Every buffer is allocated once before iterating; the iterations
+ *            themselves only run the operator and the threaded vector kernels.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+#include "operator.hpp"
+#include "eigen.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    struct KrylovOptions {
+        double tol = 1e-10;             // stop when ||b - A x|| <= tol ||b||
+        std::size_t max_iter = 1000;    // total number of operator applications in the main loop
+        std::size_t restart = 30;       // Krylov dimension between GMRES restarts
+    };
+
+    struct KrylovResult {
+        std::size_t iterations = 0;
+        double residual = 0;            // relative residual ||b - A x|| / ||b||
+        bool converged = false;
+    };
+
+    namespace detail {
+
+        template <class Op, class T>
+        void check_system(const Op& A, const Matrix<T>& b, Matrix<T>& x) {
+            if (A.nrow() != A.ncol()) throw std::runtime_error("Krylov solvers require a square operator");
+            if (b.size() != A.nrow()) throw std::runtime_error("Right hand side has the wrong length");
+            if (x.size() != b.size()) x = Matrix<T>::zeros(b.nrow(), b.ncol());
+        }
+
+        // r = b - A x
+        template <class Op, class T>
+        void residual(const Op& A, const T *b, const T *x, T *r, std::size_t n) {
+            A.apply(x, r);
+            #pragma omp parallel for simd if(n >= parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) r[i] = b[i] - r[i];
+        }
+
+    };
+
+    /**========================================================================
+     *!                           Linear systems
+     *========================================================================**/
+    /**
+     * @brief Preconditioned conjugate gradient for symmetric positive definite A
+     *
+     * @param x initial guess on entry (resized to zeros if it has the wrong length), solution on exit
+     */
+    template <class T, LinearOperator<T> Op, Preconditioner<T> Pre>
+    KrylovResult cg(const Op& A, const Matrix<T>& b, Matrix<T>& x, const Pre& M, KrylovOptions opts = {}) {
+
+        detail::check_system(A, b, x);
+        const std::size_t n = b.size();
+        std::vector<T> r (n), z (n), p (n), Ap (n);
+        T *xp = x.data.get();
+
+        KrylovResult out;
+        const T bnorm = std::max(detail::nrm2(n, b.data.get()), std::numeric_limits<T>::min());
+
+        detail::residual(A, b.data.get(), xp, r.data(), n);
+        M.solve(r.data(), z.data());
+        std::copy(z.begin(), z.end(), p.begin());
+        T rz = detail::dot(n, r.data(), z.data());
+        out.residual = detail::nrm2(n, r.data()) / bnorm;
+
+        while (out.residual > opts.tol && out.iterations < opts.max_iter) {
+
+            A.apply(p.data(), Ap.data());
+            const T pAp = detail::dot(n, p.data(), Ap.data());
+            if (pAp <= T(0)) break;     // A is not positive definite along p
+
+            const T alpha = rz / pAp;
+            detail::axpy(n, alpha, p.data(), xp);
+            detail::axpy(n, -alpha, Ap.data(), r.data());
+            out.iterations++;
+
+            out.residual = detail::nrm2(n, r.data()) / bnorm;
+            if (out.residual <= opts.tol) break;
+
+            M.solve(r.data(), z.data());
+            const T rz_new = detail::dot(n, r.data(), z.data());
+            detail::xpby(n, z.data(), rz_new / rz, p.data());
+            rz = rz_new;
+        }
+
+        out.converged = out.residual <= opts.tol;
+        return out;
+    }
+
+    /**
+     * @brief Right-preconditioned BiCGSTAB for general A
+     */
+    template <class T, LinearOperator<T> Op, Preconditioner<T> Pre>
+    KrylovResult bicgstab(const Op& A, const Matrix<T>& b, Matrix<T>& x, const Pre& M, KrylovOptions opts = {}) {
+
+        detail::check_system(A, b, x);
+        const std::size_t n = b.size();
+        std::vector<T> r (n), r0 (n), p (n, T(0)), v (n, T(0)), s (n), t (n), phat (n), shat (n);
+        T *xp = x.data.get();
+
+        KrylovResult out;
+        const T bnorm = std::max(detail::nrm2(n, b.data.get()), std::numeric_limits<T>::min());
+
+        detail::residual(A, b.data.get(), xp, r.data(), n);
+        std::copy(r.begin(), r.end(), r0.begin());
+        out.residual = detail::nrm2(n, r.data()) / bnorm;
+
+        T rho = 1, alpha = 1, omega = 1;
+
+        while (out.residual > opts.tol && out.iterations < opts.max_iter) {
+
+            const T rho_new = detail::dot(n, r0.data(), r.data());
+            if (rho_new == T(0)) break;     // breakdown
+
+            const T beta = (rho_new / rho) * (alpha / omega);
+            #pragma omp parallel for simd if(n >= detail::parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+            M.solve(p.data(), phat.data());
+            A.apply(phat.data(), v.data());
+            alpha = rho_new / detail::dot(n, r0.data(), v.data());
+
+            #pragma omp parallel for simd if(n >= detail::parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) s[i] = r[i] - alpha * v[i];
+
+            out.iterations++;
+            const T snorm = detail::nrm2(n, s.data()) / bnorm;
+            if (snorm <= opts.tol) {
+                detail::axpy(n, alpha, phat.data(), xp);
+                out.residual = snorm;
+                break;
+            }
+
+            M.solve(s.data(), shat.data());
+            A.apply(shat.data(), t.data());
+            const T tt = detail::dot(n, t.data(), t.data());
+            omega = (tt == T(0)) ? T(0) : detail::dot(n, t.data(), s.data()) / tt;
+
+            #pragma omp parallel for simd if(n >= detail::parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) {
+                xp[i] += alpha * phat[i] + omega * shat[i];
+                r[i] = s[i] - omega * t[i];
+            }
+
+            out.residual = detail::nrm2(n, r.data()) / bnorm;
+            rho = rho_new;
+            if (omega == T(0)) break;
+        }
+
+        out.converged = out.residual <= opts.tol;
+        return out;
+    }
+
+    /**
+     * @brief Restarted, right-preconditioned GMRES(m) with m = opts.restart
+     *
+     * The Arnoldi basis is orthogonalized with modified Gram-Schmidt and the small
+     * least squares problem is updated with Givens rotations, so the residual norm
+     * is known at every step without forming x.
+     */
+    template <class T, LinearOperator<T> Op, Preconditioner<T> Pre>
+    KrylovResult gmres(const Op& A, const Matrix<T>& b, Matrix<T>& x, const Pre& M, KrylovOptions opts = {}) {
+
+        detail::check_system(A, b, x);
+        const std::size_t n = b.size();
+        const std::size_t m = std::max<std::size_t>(1, std::min(opts.restart, n));
+
+        std::vector<T> V (n * (m + 1)), H ((m + 1) * m), cs (m), sn (m), g (m + 1), y (m), w (n), z (n);
+        T *xp = x.data.get();
+        auto h = [&] (std::size_t i, std::size_t j) -> T& { return H[i + j * (m + 1)]; };
+
+        KrylovResult out;
+        const T bnorm = std::max(detail::nrm2(n, b.data.get()), std::numeric_limits<T>::min());
+
+        detail::residual(A, b.data.get(), xp, V.data(), n);
+        T beta = detail::nrm2(n, V.data());
+        out.residual = beta / bnorm;
+
+        while (out.residual > opts.tol && out.iterations < opts.max_iter) {
+
+            detail::scal(n, T(1) / beta, V.data());
+            std::fill(g.begin(), g.end(), T(0));
+            g[0] = beta;
+
+            std::size_t k = 0;
+            while (k < m && out.iterations < opts.max_iter) {
+
+                T *vk1 = V.data() + (k + 1) * n;
+                M.solve(V.data() + k * n, z.data());
+                A.apply(z.data(), vk1);
+
+                for (std::size_t i = 0; i <= k; i++) {
+                    const T *vi = V.data() + i * n;
+                    h(i, k) = detail::dot(n, vk1, vi);
+                    detail::axpy(n, -h(i, k), vi, vk1);
+                }
+                h(k + 1, k) = detail::nrm2(n, vk1);
+                if (h(k + 1, k) != T(0)) detail::scal(n, T(1) / h(k + 1, k), vk1);
+
+                for (std::size_t i = 0; i < k; i++) {
+                    const T temp = cs[i] * h(i, k) + sn[i] * h(i + 1, k);
+                    h(i + 1, k) = -sn[i] * h(i, k) + cs[i] * h(i + 1, k);
+                    h(i, k) = temp;
+                }
+
+                const T rnorm = std::hypot(h(k, k), h(k + 1, k));
+                cs[k] = (rnorm == T(0)) ? T(1) : h(k, k) / rnorm;
+                sn[k] = (rnorm == T(0)) ? T(0) : h(k + 1, k) / rnorm;
+                h(k, k) = rnorm;
+                h(k + 1, k) = T(0);
+                g[k + 1] = -sn[k] * g[k];
+                g[k] = cs[k] * g[k];
+
+                k++;
+                out.iterations++;
+                out.residual = std::abs(g[k]) / bnorm;
+                if (out.residual <= opts.tol) break;
+            }
+
+            // y = H(0:k, 0:k)^{-1} g, then x += M^{-1} V y
+            for (std::size_t i = k; i-- > 0;) {
+                T total = g[i];
+                for (std::size_t j = i + 1; j < k; j++) total -= h(i, j) * y[j];
+                y[i] = total / h(i, i);
+            }
+            blas::gemv(blas::Op::N, n, k, T(1), V.data(), n, y.data(), T(0), w.data());
+            M.solve(w.data(), z.data());
+            detail::axpy(n, T(1), z.data(), xp);
+
+            // restart from the true residual
+            detail::residual(A, b.data.get(), xp, V.data(), n);
+            beta = detail::nrm2(n, V.data());
+            out.residual = beta / bnorm;
+            if (beta == T(0)) break;
+        }
+
+        out.converged = out.residual <= opts.tol;
+        return out;
+    }
+
+    // Unpreconditioned overloads
+    template <class T, LinearOperator<T> Op>
+    KrylovResult cg(const Op& A, const Matrix<T>& b, Matrix<T>& x, KrylovOptions opts = {}) {
+        return cg(A, b, x, IdentityPreconditioner<T>{b.size()}, opts);
+    }
+
+    template <class T, LinearOperator<T> Op>
+    KrylovResult bicgstab(const Op& A, const Matrix<T>& b, Matrix<T>& x, KrylovOptions opts = {}) {
+        return bicgstab(A, b, x, IdentityPreconditioner<T>{b.size()}, opts);
+    }
+
+    template <class T, LinearOperator<T> Op>
+    KrylovResult gmres(const Op& A, const Matrix<T>& b, Matrix<T>& x, KrylovOptions opts = {}) {
+        return gmres(A, b, x, IdentityPreconditioner<T>{b.size()}, opts);
+    }
+
+    /**========================================================================
+     *!                           Eigenpairs
+     *========================================================================**/
+    enum class Which { Largest, Smallest };
+
+    struct KrylovEigenOptions {
+        double tol = 1e-10;             // residual ||A v - theta v|| relative to the largest |theta|
+        std::size_t subspace = 0;       // Krylov dimension per restart, 0 picks max(2k + 20, 40)
+        std::size_t max_restarts = 20;
+    };
+
+    // Eigenpairs of a general operator; vectors are only filled for real eigenvalues
+    template <class T = double>
+    struct KrylovEigen {
+        Matrix<T> real;
+        Matrix<T> imag;
+        Matrix<T> vectors;
+        bool converged = false;
+    };
+
+    namespace detail {
+
+        // Orthogonalize w against the first k columns of V, twice for stability
+        template <class T>
+        void reorthogonalize(std::size_t n, std::size_t k, const T *V, T *w, T *coef) {
+            if (k == 0) return;
+            for (int pass = 0; pass < 2; pass++) {
+                blas::gemv(blas::Op::T, n, k, T(1), V, n, w, T(0), coef);
+                blas::gemv(blas::Op::N, n, k, T(-1), V, n, coef, T(1), w);
+            }
+        }
+
+        // Deterministic, dense starting vector; `seed` gives linearly independent alternatives
+        template <class T>
+        void start_vector(std::size_t n, T *v, std::size_t seed = 0) {
+            const T freq = T(0.7071) + T(0.3183) * T(seed);
+            for (std::size_t i = 0; i < n; i++) v[i] = T(1) + T(0.5) * std::sin(T(i + 1) * freq) + T(seed) * std::cos(T(i + 1) * freq * freq);
+            scal(n, T(1) / nrm2(n, v), v);
+        }
+
+        /**
+         * @brief Unit eigenvector of the upper Hessenberg H (n x n, ld = n) for the complex theta
+         *
+         * Inverse iteration with a complex LU of H - shift I, where only the subdiagonal is
+         * eliminated. As in eigvec, the shift is moved off theta by a relative 1e-10; a pivot
+         * that is still exactly zero is replaced by a tiny one. The largest entry is made real
+         * and positive, so that conjugate values get conjugate vectors.
+         */
+        template <class T>
+        std::vector<std::complex<T>> hessenberg_eigvec(std::size_t n, const T *H, std::complex<T> theta, int iterations = 3) {
+
+            using C = std::complex<T>;
+            const T scale = std::max(std::abs(theta), T(1));
+            const C shift = theta + C(T(1e-10) * scale, T(0));
+            const T tiny = std::numeric_limits<T>::epsilon() * scale;
+
+            std::vector<C> U (n * n), l (n, C(0)), x (n);
+            std::vector<char> swapped (n, 0);
+            for (std::size_t j = 0; j < n; j++) {
+                for (std::size_t i = 0; i < std::min(n, j + 2); i++) U[i + j * n] = H[i + j * n];
+                U[j + j * n] -= shift;
+            }
+
+            for (std::size_t j = 0; j < n; j++) {
+                if (j + 1 < n && std::abs(U[(j + 1) + j * n]) > std::abs(U[j + j * n])) {
+                    swapped[j] = 1;
+                    for (std::size_t c = j; c < n; c++) std::swap(U[j + c * n], U[(j + 1) + c * n]);
+                }
+                if (U[j + j * n] == C(0)) U[j + j * n] = tiny;
+                if (j + 1 == n) break;
+                l[j] = U[(j + 1) + j * n] / U[j + j * n];
+                for (std::size_t c = j + 1; c < n; c++) U[(j + 1) + c * n] -= l[j] * U[j + c * n];
+                U[(j + 1) + j * n] = C(0);
+            }
+
+            for (std::size_t i = 0; i < n; i++) x[i] = T(1) + T(0.1) * std::sin(T(i + 1));
+
+            for (int it = 0; it < std::max(iterations, 1); it++) {
+                for (std::size_t j = 0; j + 1 < n; j++) {
+                    if (swapped[j]) std::swap(x[j], x[j + 1]);
+                    x[j + 1] -= l[j] * x[j];
+                }
+                for (std::size_t i = n; i-- > 0;) {
+                    C acc = x[i];
+                    for (std::size_t c = i + 1; c < n; c++) acc -= U[i + c * n] * x[c];
+                    x[i] = acc / U[i + i * n];
+                }
+                T nrm = 0;
+                for (const auto& z : x) nrm = std::hypot(nrm, std::abs(z));
+                if (!(nrm > T(0)) || !std::isfinite(nrm)) throw std::runtime_error("hessenberg_eigvec: inverse iteration broke down");
+                for (auto& z : x) z /= nrm;
+            }
+
+            std::size_t imax = 0;
+            for (std::size_t i = 1; i < n; i++) if (std::abs(x[i]) > std::abs(x[imax])) imax = i;
+            const C phase = std::conj(x[imax]) / std::abs(x[imax]);
+            for (auto& z : x) z *= phase;
+            return x;
+        }
+
+    };
+
+    /**
+     * @brief k extreme eigenpairs of a symmetric operator by the Lanczos process
+     *
+     * Each restart runs `subspace` Lanczos steps with full reorthogonalization.
+     * Ritz pairs whose residual beta |s_m| is small are locked, and later restarts
+     * run in the orthogonal complement of the locked vectors from a fresh start
+     * vector, which is what lets repeated eigenvalues appear with their full
+     * multiplicity. The values are returned in increasing order, like eigh.
+     */
+    template <class T = double, LinearOperator<T> Op>
+    SymmetricEigen<T> lanczos(const Op& A, std::size_t k, Which which = Which::Largest, KrylovEigenOptions opts = {}) {
+
+        const std::size_t n = A.nrow();
+        if (A.ncol() != n) throw std::runtime_error("Lanczos requires a square operator");
+        if (k == 0 || k > n) throw std::runtime_error("Invalid number of eigenpairs");
+
+        const bool largest = which == Which::Largest;
+        auto better = [largest] (T a, T b) { return largest ? a > b : a < b; };
+
+        std::size_t m = std::min(n, opts.subspace ? opts.subspace : std::max<std::size_t>(2 * k + 20, 40));
+
+        // W = [locked vectors | Lanczos basis], so one gemv reorthogonalizes against both
+        std::vector<T> W, coef, alpha, beta, locked;
+        std::vector<T> candidates, cand_vectors;    // unconverged Ritz pairs of the last run
+        T scale = std::numeric_limits<T>::min();
+
+        for (std::size_t restart = 0; restart <= opts.max_restarts; restart++) {
+
+            const std::size_t l = locked.size();
+            const std::size_t mm = std::min(m, n - l);
+            if (mm == 0) break;
+
+            W.resize(n * (l + mm + 1));
+            coef.resize(l + mm + 1);
+            alpha.assign(mm, T(0));
+            beta.assign(mm, T(0));
+
+            T *V = W.data() + l * n;
+            detail::start_vector(n, V, restart);
+            detail::reorthogonalize(n, l, W.data(), V, coef.data());
+            detail::scal(n, T(1) / detail::nrm2(n, V), V);
+
+            std::size_t steps = mm;
+            for (std::size_t j = 0; j < mm; j++) {
+
+                T *vj = V + j * n;
+                T *w = vj + n;
+                A.apply(vj, w);
+                alpha[j] = detail::dot(n, w, vj);
+                detail::reorthogonalize(n, l + j + 1, W.data(), w, coef.data());
+                beta[j] = detail::nrm2(n, w);
+
+                if (beta[j] <= std::numeric_limits<T>::epsilon() * (std::abs(alpha[j]) + scale) * n) {
+                    steps = j + 1;      // invariant subspace: the Ritz values are exact
+                    beta[j] = T(0);
+                    break;
+                }
+                if (j + 1 < mm) detail::scal(n, T(1) / beta[j], w);
+            }
+
+            // Ritz pairs of the tridiagonal projection, in increasing order
+            std::vector<T> d (alpha.begin(), alpha.begin() + steps), e (steps, T(0));
+            for (std::size_t j = 0; j + 1 < steps; j++) e[j] = beta[j];
+            Matrix<T> S = Matrix<T>::id(steps);
+            detail::tql(steps, d.data(), e.data(), S.data.get(), steps, steps);
+            detail::sort_eigenpairs(steps, d.data(), S.data.get(), steps, steps);
+            for (std::size_t i = 0; i < steps; i++) scale = std::max(scale, std::abs(d[i]));
+
+            // k-th best locked value before this run
+            std::vector<T> sorted (locked);
+            std::sort(sorted.begin(), sorted.end(), better);
+            const bool had_k = sorted.size() >= k;
+            const T kth = had_k ? sorted[k - 1] : T(0);
+
+            // Lock converged pairs from the wanted end, stopping at the first unconverged one
+            std::size_t taken = 0;
+            for (; taken < steps; taken++) {
+                const std::size_t i = largest ? steps - 1 - taken : taken;
+                if (std::abs(beta[steps - 1] * S.data[(steps - 1) + i * steps]) > opts.tol * scale) break;
+            }
+
+            const std::size_t nlocked = std::min(taken, n - l);
+            W.resize(n * (l + mm + 1 + nlocked));
+            for (std::size_t t = 0; t < nlocked; t++) {
+                const std::size_t i = largest ? steps - 1 - t : t;
+                locked.push_back(d[i]);
+                // Ritz vector V s_i, appended after the basis and then moved into the locked block
+                T *ritz = W.data() + (l + mm + 1 + t) * n;
+                blas::gemv(blas::Op::N, n, steps, T(1), W.data() + l * n, n, S.data.get() + i * steps, T(0), ritz);
+            }
+
+            candidates.clear();
+            cand_vectors.clear();
+            for (std::size_t t = nlocked; t < std::min(steps, k); t++) {
+                const std::size_t i = largest ? steps - 1 - t : t;
+                candidates.push_back(d[i]);
+                cand_vectors.resize(cand_vectors.size() + n);
+                blas::gemv(blas::Op::N, n, steps, T(1), W.data() + l * n, n, S.data.get() + i * steps,
+                           T(0), cand_vectors.data() + cand_vectors.size() - n);
+            }
+
+            for (std::size_t t = 0; t < nlocked; t++) {
+                std::copy_n(W.data() + (l + mm + 1 + t) * n, n, W.data() + (l + t) * n);
+            }
+
+            W.resize(n * (l + nlocked));
+
+            // Done once the complement of k locked vectors holds nothing better than the k-th
+            if (had_k && taken > 0 && !better(d[largest ? steps - 1 : 0], kth + (largest ? 1 : -1) * T(opts.tol) * scale)) break;
+            if (taken == 0) m = std::min(n, 2 * m);
+        }
+
+        // Best k locked pairs (topped up with the last unconverged Ritz pairs), in increasing order
+        std::vector<std::pair<T, const T*>> pairs;
+        for (std::size_t i = 0; i < locked.size(); i++) pairs.emplace_back(locked[i], W.data() + i * n);
+        for (std::size_t i = 0; i < candidates.size(); i++) pairs.emplace_back(candidates[i], cand_vectors.data() + i * n);
+        std::stable_sort(pairs.begin(), pairs.end(), [&] (const auto& a, const auto& b) { return better(a.first, b.first); });
+        pairs.resize(std::min(k, pairs.size()));
+        std::sort(pairs.begin(), pairs.end(), [] (const auto& a, const auto& b) { return a.first < b.first; });
+
+        SymmetricEigen<T> out;
+        out.values = Matrix<T>(pairs.size(), 1);
+        out.vectors = Matrix<T>(n, pairs.size());
+        for (std::size_t i = 0; i < pairs.size(); i++) {
+            out.values.data[i] = pairs[i].first;
+            std::copy_n(pairs[i].second, n, out.vectors.data.get() + i * n);
+        }
+        return out;
+    }
+
+    /**
+     * @brief k eigenvalues of largest modulus of a general operator by the Arnoldi process
+     *
+     * Every restart runs `subspace` Arnoldi steps into the same basis. The Hessenberg
+     * projection is solved with the Francis QR, and each wanted Ritz pair, real or
+     * complex, is converged once its residual |h y_last| is small. The next restart
+     * begins from the sum of the wanted Ritz vectors (the real and imaginary parts of
+     * complex ones), so it stays in real arithmetic. Ritz vectors are returned for the
+     * real Ritz values (the columns of complex ones are zero).
+     */
+    template <class T = double, LinearOperator<T> Op>
+    KrylovEigen<T> arnoldi(const Op& A, std::size_t k, KrylovEigenOptions opts = {}) {
+
+        const std::size_t n = A.nrow();
+        if (A.ncol() != n) throw std::runtime_error("Arnoldi requires a square operator");
+        if (k == 0 || k > n) throw std::runtime_error("Invalid number of eigenpairs");
+
+        std::size_t m = std::min(n, opts.subspace ? opts.subspace : std::max<std::size_t>(2 * k + 20, 40));
+        m = std::max(m, k);
+
+        // Column m of V is the last residual, then the next start vector
+        std::vector<T> V (n * (m + 1)), coef (m + 1), c2 (m + 1), s (m);
+        Matrix<T> Hm = Matrix<T>::zeros(m + 1, m);
+        detail::start_vector(n, V.data());
+        KrylovEigen<T> out;
+
+        for (std::size_t restart = 0; ; restart++) {
+
+            std::size_t steps = m;
+            for (std::size_t j = 0; j < m; j++) {
+
+                T *w = V.data() + (j + 1) * n;
+                A.apply(V.data() + j * n, w);
+                const T wnorm = detail::nrm2(n, w);
+
+                // Gram-Schmidt coefficients are the Hessenberg entries
+                std::fill(coef.begin(), coef.end(), T(0));
+                for (int pass = 0; pass < 2; pass++) {
+                    blas::gemv(blas::Op::T, n, j + 1, T(1), V.data(), n, w, T(0), c2.data());
+                    blas::gemv(blas::Op::N, n, j + 1, T(-1), V.data(), n, c2.data(), T(1), w);
+                    for (std::size_t i = 0; i <= j; i++) coef[i] += c2[i];
+                }
+                for (std::size_t i = 0; i <= j; i++) Hm.data[i + j * (m + 1)] = coef[i];
+
+                const T h = detail::nrm2(n, w);
+                Hm.data[(j + 1) + j * (m + 1)] = h;
+                if (h <= std::numeric_limits<T>::epsilon() * n * wnorm) {
+                    steps = j + 1;      // invariant subspace: the Ritz values are exact
+                    Hm.data[(j + 1) + j * (m + 1)] = T(0);
+                    break;
+                }
+                detail::scal(n, T(1) / h, w);
+            }
+
+            Matrix<T> H (steps, steps);
+            for (std::size_t j = 0; j < steps; j++) {
+                std::copy_n(Hm.data.get() + j * (m + 1), steps, H.data.get() + j * steps);
+            }
+            const T h_last = Hm.data[steps + (steps - 1) * (m + 1)];
+
+            const auto ritz = eig(H);
+            const std::size_t kk = std::min(k, steps);
+
+            T scale = std::max(std::hypot(ritz.real.data[0], ritz.imag.data[0]), std::numeric_limits<T>::min());
+            bool converged = kk == k;
+
+            out.real = Matrix<T>(kk, 1);
+            out.imag = Matrix<T>(kk, 1);
+            out.vectors = Matrix<T>::zeros(n, kk);
+            std::fill(s.begin(), s.end(), T(0));
+
+            for (std::size_t i = 0; i < kk; i++) {
+
+                const T re = ritz.real.data[i], im = ritz.imag.data[i];
+                out.real.data[i] = re;
+                out.imag.data[i] = im;
+
+                if (im == T(0)) {
+                    const Matrix<T> y = eigvec(H, re);
+                    blas::gemv(blas::Op::N, n, steps, T(1), V.data(), n, y.data.get(), T(0), out.vectors.data.get() + i * n);
+                    if (std::abs(h_last * y.data[steps - 1]) > opts.tol * scale) converged = false;
+                    for (std::size_t j = 0; j < steps; j++) s[j] += y.data[j];
+                } else {
+                    // complex Ritz values have no real eigenvector, their columns stay zero
+                    const auto y = detail::hessenberg_eigvec(steps, H.data.get(), std::complex<T>(re, im));
+                    if (std::abs(h_last * y[steps - 1]) > opts.tol * scale) converged = false;
+                    const T sign = im > T(0) ? T(1) : T(-1);
+                    for (std::size_t j = 0; j < steps; j++) s[j] += y[j].real() + sign * y[j].imag();
+                }
+            }
+
+            if (converged || restart >= opts.max_restarts || steps < m || m == n) {
+                out.converged = converged;
+                break;
+            }
+
+            T *start = V.data() + m * n;
+            blas::gemv(blas::Op::N, n, steps, T(1), V.data(), n, s.data(), T(0), start);
+            const T snorm = detail::nrm2(n, start);
+            if (snorm == T(0)) detail::start_vector(n, V.data(), restart + 1);
+            else {
+                detail::scal(n, T(1) / snorm, start);
+                std::copy_n(start, n, V.data());
+            }
+        }
+
+        return out;
+    }
+
+    };
+
+};
@@ -0,0 +1,373 @@
+/**========================================================================
+ * ?                          lu.hpp
+ * @brief   : Blocked LU factorization with partial pivoting
+ * @details : P A = L U is computed in place, right-looking, one panel of
+ *            `block` columns at a time:
+ *
+ *              1. factor the tall panel with an unblocked, pivoting kernel
+ *              2. apply its row interchanges to the columns left and right of it
+ *              3. A12 <- L11^{-1} A12                (trsm)
+ *              4. A22 <- A22 - A21 A12                (gemm)
+ *
+ *            Almost all of the flops land in step 4, which runs through the
+ *            packed, threaded blas::gemm. The factors share the storage of the
+ *            input: L is unit lower triangular below the diagonal, U is upper
+ *            triangular on and above it. Pivots are stored 0-based, LAPACK style:
+ *            row k was interchanged with row ipiv[k].
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+#include "triangular.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    namespace detail {
+
+        // Unblocked, pivoting LU of the m x n panel A. Pivots are relative to the panel.
+        // Returns the 1-based index of the first zero pivot, 0 if there is none.
+        template <class T>
+        std::size_t getf2(std::size_t m, std::size_t n, T *A, std::size_t lda, int *ipiv) {
+
+            std::size_t info = 0;
+            const std::size_t mn = std::min(m, n);
+
+            for (std::size_t k = 0; k < mn; k++) {
+
+                T *ak = A + k * lda;
+
+                std::size_t p = k;
+                T amax = std::abs(ak[k]);
+                for (std::size_t i = k + 1; i < m; i++) {
+                    if (std::abs(ak[i]) > amax) {
+                        amax = std::abs(ak[i]);
+                        p = i;
+                    }
+                }
+                ipiv[k] = p;
+
+                if (ak[p] == T(0)) {
+                    if (info == 0) info = k + 1;
+                    continue;
+                }
+
+                if (p != k) {
+                    for (std::size_t j = 0; j < n; j++) std::swap(A[k + j * lda], A[p + j * lda]);
+                }
+
+                const T inv_pivot = T(1) / ak[k];
+                for (std::size_t i = k + 1; i < m; i++) ak[i] *= inv_pivot;
+
+                // rank-1 update of the rest of the panel
+                if (k + 1 < n) {
+                    blas::ger(m - k - 1, n - k - 1, T(-1), ak + k + 1, 1, A + k + (k + 1) * lda, lda,
+                              A + (k + 1) + (k + 1) * lda, lda);
+                }
+            }
+
+            return info;
+        }
+
+    };
+
+    /**
+     * @brief Factor the m x n column-major matrix A in place, P A = L U
+     *
+     * @param ipiv holds min(m, n) 0-based row interchanges on exit
+     * @return the 1-based index of the first exactly zero pivot of U, 0 when U is nonsingular
+     */
+    template <class T>
+    std::size_t getrf(std::size_t m, std::size_t n, T *A, std::size_t lda, int *ipiv, std::size_t block = 64) {
+
+        using blas::Op, blas::Side, blas::Uplo, blas::Diag;
+
+        std::size_t info = 0;
+        const std::size_t mn = std::min(m, n);
+        if (block == 0) block = 64;
+
+        for (std::size_t j = 0; j < mn; j += block) {
+
+            const std::size_t jb = std::min(block, mn - j);
+
+            // 1. panel
+            const std::size_t panel_info = detail::getf2(m - j, jb, A + j + j * lda, lda, ipiv + j);
+            if (info == 0 && panel_info != 0) info = panel_info + j;
+            for (std::size_t k = j; k < j + jb; k++) ipiv[k] += j;
+
+            // 2. interchanges on both sides of the panel
+            blas::laswp(j, A, lda, j, j + jb, ipiv);
+
+            if (j + jb < n) {
+
+                const std::size_t nr = n - j - jb;
+                T *A12 = A + j + (j + jb) * lda;
+
+                blas::laswp(nr, A + (j + jb) * lda, lda, j, j + jb, ipiv);
+
+                // 3. block row of U
+                blas::trsm(Side::Left, Uplo::Lower, Op::N, Diag::Unit, jb, nr, T(1),
+                           A + j + j * lda, lda, A12, lda);
+
+                // 4. Schur complement
+                if (j + jb < m) {
+                    blas::gemm(Op::N, Op::N, m - j - jb, nr, jb, T(-1),
+                               A + (j + jb) + j * lda, lda, A12, lda,
+                               T(1), A + (j + jb) + (j + jb) * lda, lda);
+                }
+            }
+        }
+
+        return info;
+    }
+
+    /**
+     * @brief Reusable LU factorization of a square matrix
+     *
+     * The factorization is computed once and can then solve any number of systems,
+     * or give the determinant, inverse and an estimate of the condition number
+     * without refactoring.
+     *
+     * @code
+     * linalg::LU lu (A);
+     * auto X = lu.solve(B);      // every column of B is a right hand side
+     * double d = lu.det();
+     * @endcode
+     *
+     * @tparam T floating point type
+     */
+    template <class T = double>
+    class LU {
+
+    public:
+
+        // Factor a copy of A
+        LU(const Matrix<T>& A, std::size_t block = 64) : LU(A.clone(), block) {}
+
+        // Factor A in place, taking over its storage
+        LU(Matrix<T>&& A, std::size_t block = 64)
+            : lu_{std::move(A)}
+        {
+            if (!lu_.is_square()) throw std::runtime_error("LU factorization requires a square matrix");
+
+            const std::size_t n = lu_.nrow();
+            anorm_ = norm1(lu_);
+            ipiv_.resize(n);
+            info_ = getrf(n, n, lu_.data.get(), n, ipiv_.data(), block);
+        }
+
+        std::size_t size() const { return lu_.nrow(); }
+
+        // L and U packed in a single matrix, the unit diagonal of L is implied
+        const Matrix<T>& factors() const { return lu_; }
+        // 0-based row interchanges: row k was swapped with row pivots()[k]
+        const std::vector<int>& pivots() const { return ipiv_; }
+        // 1-based index of the first zero pivot of U, 0 when A is nonsingular
+        std::size_t info() const { return info_; }
+        bool is_singular() const { return info_ != 0; }
+
+        Matrix<T> L() const {
+            const std::size_t n = size();
+            Matrix<T> out = Matrix<T>::zeros(n, n);
+            for (std::size_t j = 0; j < n; j++) {
+                out.data[j + j * n] = T(1);
+                for (std::size_t i = j + 1; i < n; i++) out.data[i + j * n] = lu_.data[i + j * n];
+            }
+            return out;
+        }
+
+        Matrix<T> U() const {
+            const std::size_t n = size();
+            Matrix<T> out = Matrix<T>::zeros(n, n);
+            for (std::size_t j = 0; j < n; j++) {
+                for (std::size_t i = 0; i <= j; i++) out.data[i + j * n] = lu_.data[i + j * n];
+            }
+            return out;
+        }
+
+        // Permutation matrix such that P A = L U
+        Matrix<T> P() const {
+            const std::size_t n = size();
+            Matrix<T> out = Matrix<T>::id(n);
+            blas::laswp(n, out.data.get(), n, 0, n, ipiv_.data());
+            return out;
+        }
+
+        /**
+         * @brief Overwrite B with the solution X of A X = B
+         *
+         * A row vector of length n is treated as a single right hand side.
+         */
+        void solve_in_place(Matrix<T>& B) const {
+
+            using blas::Op, blas::Side, blas::Uplo, blas::Diag;
+
+            check_solvable();
+            const std::size_t n = size();
+            const auto [m, nrhs] = detail::rhs_shape(B, n);
+
+            T *b = B.data.get();
+            blas::laswp(nrhs, b, m, 0, n, ipiv_.data());
+            blas::trsm(Side::Left, Uplo::Lower, Op::N, Diag::Unit, n, nrhs, T(1), lu_.data.get(), n, b, m);
+            blas::trsm(Side::Left, Uplo::Upper, Op::N, Diag::NonUnit, n, nrhs, T(1), lu_.data.get(), n, b, m);
+        }
+
+        // Overwrite B with the solution X of A^T X = B
+        void solve_transpose_in_place(Matrix<T>& B) const {
+
+            using blas::Op, blas::Side, blas::Uplo, blas::Diag;
+
+            check_solvable();
+            const std::size_t n = size();
+            const auto [m, nrhs] = detail::rhs_shape(B, n);
+
+            T *b = B.data.get();
+            blas::trsm(Side::Left, Uplo::Upper, Op::T, Diag::NonUnit, n, nrhs, T(1), lu_.data.get(), n, b, m);
+            blas::trsm(Side::Left, Uplo::Lower, Op::T, Diag::Unit, n, nrhs, T(1), lu_.data.get(), n, b, m);
+            blas::laswp(nrhs, b, m, 0, n, ipiv_.data(), false);
+        }
+
+        Matrix<T> solve(const Matrix<T>& B) const {
+            Matrix<T> X = B.clone();
+            solve_in_place(X);
+            return X;
+        }
+
+        Matrix<T> solve_transpose(const Matrix<T>& B) const {
+            Matrix<T> X = B.clone();
+            solve_transpose_in_place(X);
+            return X;
+        }
+
+        T det() const {
+            const std::size_t n = size();
+            T d = 1;
+            for (std::size_t k = 0; k < n; k++) {
+                d *= lu_.data[k + k * n];
+                if (static_cast<std::size_t>(ipiv_[k]) != k) d = -d;
+            }
+            return d;
+        }
+
+        Matrix<T> inv() const {
+            Matrix<T> X = Matrix<T>::id(size());
+            solve_in_place(X);
+            return X;
+        }
+
+        /**
+         * @brief Estimate the reciprocal condition number 1 / (||A||_1 ||A^{-1}||_1)
+         *
+         * ||A^{-1}||_1 is estimated with Hager's method as refined by Higham, using a
+         * handful of solves with A and A^T instead of forming the inverse. The
+         * estimate is a lower bound on ||A^{-1}||_1 and is almost always within a
+         * factor of 3 of it. Returns 0 for a singular matrix.
+         */
+        T rcond() const {
+
+            if (is_singular()) return T(0);
+            if (anorm_ == T(0)) return T(0);
+
+            const std::size_t n = size();
+            if (n == 0) return T(1);
+
+            Matrix<T> x (n, 1);
+            for (std::size_t i = 0; i < n; i++) x.data[i] = T(1) / n;
+
+            T est = 0;
+            std::size_t j_last = n;
+
+            for (int iter = 0; iter < 5; iter++) {
+
+                solve_in_place(x);
+                const T est_new = sum_abs(x);
+                if (iter > 0 && est_new <= est) break;
+                est = est_new;
+
+                for (std::size_t i = 0; i < n; i++) x.data[i] = (x.data[i] >= 0) ? T(1) : T(-1);
+                solve_transpose_in_place(x);
+
+                std::size_t j = 0;
+                for (std::size_t i = 1; i < n; i++) {
+                    if (std::abs(x.data[i]) > std::abs(x.data[j])) j = i;
+                }
+                if (j == j_last) break;
+                j_last = j;
+
+                for (std::size_t i = 0; i < n; i++) x.data[i] = T(0);
+                x.data[j] = T(1);
+            }
+
+            // Higham's alternating vector guards against the worst cases of Hager's method
+            for (std::size_t i = 0; i < n; i++) {
+                const T sign = (i % 2 == 0) ? T(1) : T(-1);
+                x.data[i] = sign * (T(1) + (n > 1 ? T(i) / T(n - 1) : T(0)));
+            }
+            solve_in_place(x);
+            est = std::max(est, 2 * sum_abs(x) / (3 * T(n)));
+
+            return T(1) / (anorm_ * est);
+        }
+
+    private:
+
+        Matrix<T> lu_;
+        std::vector<int> ipiv_;
+        std::size_t info_;
+        T anorm_;
+
+        // Maximum absolute column sum
+        static T norm1(const Matrix<T>& A) {
+            T out = 0;
+            for (std::size_t j = 0; j < A.ncol(); j++) {
+                T col = 0;
+                for (std::size_t i = 0; i < A.nrow(); i++) col += std::abs(A.data[i + j * A.nrow()]);
+                out = std::max(out, col);
+            }
+            return out;
+        }
+
+        static T sum_abs(const Matrix<T>& x) {
+            T out = 0;
+            for (std::size_t i = 0; i < x.size(); i++) out += std::abs(x.data[i]);
+            return out;
+        }
+
+        void check_solvable() const {
+            if (is_singular()) throw std::runtime_error("Matrix is singular to working precision");
+        }
+
+    };
+
+    template <class T>
+    LU<T> lu(const Matrix<T>& A, std::size_t block = 64) {
+        return LU<T>(A, block);
+    }
+
+    // Solve A X = B with a pivoted LU factorization of A
+    template <class T>
+    Matrix<T> solve(const Matrix<T>& A, const Matrix<T>& B) {
+        return LU<T>(A).solve(B);
+    }
+
+    template <class T>
+    T det(const Matrix<T>& A) {
+        return LU<T>(A).det();
+    }
+
+    template <class T>
+    Matrix<T> inv(const Matrix<T>& A) {
+        return LU<T>(A).inv();
+    }
+
+    };
+
+};
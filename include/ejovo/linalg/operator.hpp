@@ -0,0 +1,162 @@
+/**========================================================================
+ * ?                          operator.hpp
+ * @brief   : Matrix-free linear operators and preconditioners
+ * @details : Iterative solvers only ever need y = A x. Anything exposing
+ *
+ *                std::size_t nrow() const;
+ *                std::size_t ncol() const;
+ *                void apply(const T *x, T *y) const;     // y = A x
+ *
+ *            models LinearOperator<Op, T>: Matrix, linalg::SparseMatrix, the
+ *            Kronecker operators, and any lambda wrapped with make_operator.
+ *            Preconditioners model Preconditioner<P, T> by exposing
+ *            `void solve(const T *r, T *z) const` with z = M^{-1} r.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <concepts>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "types.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    template <class Op, class T>
+    concept LinearOperator = requires (const Op& op, const T *x, T *y) {
+        { op.nrow() } -> std::convertible_to<std::size_t>;
+        { op.ncol() } -> std::convertible_to<std::size_t>;
+        op.apply(x, y);
+    };
+
+    template <class P, class T>
+    concept Preconditioner = requires (const P& p, const T *r, T *z) {
+        p.solve(r, z);
+    };
+
+    /**
+     * @brief LinearOperator wrapping a callable f(const T *x, T *y) that writes y = A x
+     */
+    template <class T, class F>
+    class FunctionOperator {
+
+    public:
+
+        FunctionOperator(std::size_t m, std::size_t n, F f) : m_{m}, n_{n}, f_{std::move(f)} {}
+
+        std::size_t nrow() const { return m_; }
+        std::size_t ncol() const { return n_; }
+        void apply(const T *x, T *y) const { f_(x, y); }
+
+    private:
+
+        std::size_t m_;
+        std::size_t n_;
+        F f_;
+
+    };
+
+    // Square n x n operator from a callable f(const T *x, T *y)
+    template <class T = double, class F>
+    FunctionOperator<T, F> make_operator(std::size_t n, F f) {
+        return FunctionOperator<T, F>(n, n, std::move(f));
+    }
+
+    template <class T = double, class F>
+    FunctionOperator<T, F> make_operator(std::size_t m, std::size_t n, F f) {
+        return FunctionOperator<T, F>(m, n, std::move(f));
+    }
+
+    /**========================================================================
+     *!                           Vector kernels
+     *========================================================================**/
+    // Threaded level-1 kernels shared by the Krylov solvers
+    namespace detail {
+
+        inline constexpr std::size_t parallel_length = 1 << 15;
+
+        template <class T>
+        T dot(std::size_t n, const T *x, const T *y) {
+            T total = 0;
+            #pragma omp parallel for simd reduction(+:total) if(n >= parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) total += x[i] * y[i];
+            return total;
+        }
+
+        template <class T>
+        T nrm2(std::size_t n, const T *x) {
+            return std::sqrt(dot(n, x, x));
+        }
+
+        // y <- y + a x
+        template <class T>
+        void axpy(std::size_t n, T a, const T *x, T *y) {
+            #pragma omp parallel for simd if(n >= parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) y[i] += a * x[i];
+        }
+
+        // y <- x + b y
+        template <class T>
+        void xpby(std::size_t n, const T *x, T b, T *y) {
+            #pragma omp parallel for simd if(n >= parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) y[i] = x[i] + b * y[i];
+        }
+
+        template <class T>
+        void scal(std::size_t n, T a, T *x) {
+            #pragma omp parallel for simd if(n >= parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) x[i] *= a;
+        }
+
+    };
+
+    /**========================================================================
+     *!                           Preconditioners
+     *========================================================================**/
+    // M = I
+    template <class T = double>
+    struct IdentityPreconditioner {
+        void solve(const T *r, T *z) const { std::copy(r, r + n, z); }
+        std::size_t n;
+    };
+
+    /**
+     * @brief Jacobi (diagonal) preconditioner, M = diag(A)
+     */
+    template <class T = double>
+    class Jacobi {
+
+    public:
+
+        // From the diagonal of anything exposing (i, j) element access, such as a Matrix
+        template <class M>
+        explicit Jacobi(const M& A) : inv_diag_(A.nrow(), 1) {
+            for (std::size_t i = 0; i < A.nrow(); i++) set(i, A(i + 1, i + 1));
+        }
+
+        void solve(const T *r, T *z) const {
+            const std::size_t n = inv_diag_.size();
+            const T *d = inv_diag_.data.get();
+            #pragma omp parallel for simd if(n >= detail::parallel_length) schedule(static)
+            for (std::size_t i = 0; i < n; i++) z[i] = d[i] * r[i];
+        }
+
+    private:
+
+        Matrix<T> inv_diag_;
+
+        void set(std::size_t i, T d) {
+            if (d == T(0)) throw std::runtime_error("Jacobi preconditioner requires a nonzero diagonal");
+            inv_diag_.data[i] = T(1) / d;
+        }
+
+    };
+
+    };
+
+};
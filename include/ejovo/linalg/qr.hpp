@@ -0,0 +1,575 @@
+/**========================================================================
+ * ?                          qr.hpp
+ * @brief   : Blocked Householder QR, TSQR and least squares
+ * @details : A = Q R is computed in place, LAPACK style: R on and above the
+ *            diagonal, the Householder vectors v_i (with an implied leading 1)
+ *            below it, and the scalars tau_i in a separate array, so that
+ *
+ *                Q = H_1 H_2 ... H_k,   H_i = I - tau_i v_i v_i^T.
+ *
+ *            Each panel of `block` reflectors is accumulated in compact-WY form
+ *            H_1 ... H_b = I - V T V^T (T upper triangular, b x b), which turns
+ *            the update of the trailing matrix into two gemm calls. Q is never
+ *            formed unless asked for; apply_qt / apply_q run the same blocked
+ *            updates on any right hand side.
+ *
+ *            For very tall and skinny matrices, TSQR factors independent row
+ *            blocks in parallel and then factors the stack of their R factors.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+#include "triangular.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    namespace detail {
+
+        /**
+         * @brief Generate a reflector H = I - tau v v^T with H [alpha; x] = [beta; 0]
+         *
+         * On exit alpha holds beta and x holds v(1:), v(0) = 1 being implied.
+         */
+        template <class T>
+        T larfg(std::size_t n, T& alpha, T *x) {
+
+            if (n <= 1) return T(0);
+
+            T xnorm = 0;
+            const std::size_t nx = n - 1;
+            #pragma omp simd reduction(+:xnorm)
+            for (std::size_t i = 0; i < nx; i++) xnorm += x[i] * x[i];
+            xnorm = std::sqrt(xnorm);
+            if (xnorm == T(0)) return T(0);
+
+            const T beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+            const T tau = (beta - alpha) / beta;
+            const T scale = T(1) / (alpha - beta);
+            for (std::size_t i = 0; i < nx; i++) x[i] *= scale;
+            alpha = beta;
+
+            return tau;
+        }
+
+        // Apply H = I - tau v v^T from the left to the m x n matrix C
+        template <class T>
+        void larf(std::size_t m, std::size_t n, const T *v, T tau, T *C, std::size_t ldc) {
+
+            if (tau == T(0)) return;
+
+            for (std::size_t j = 0; j < n; j++) {
+                T *c = C + j * ldc;
+                T w = 0;
+                #pragma omp simd reduction(+:w)
+                for (std::size_t i = 0; i < m; i++) w += v[i] * c[i];
+                w *= tau;
+                for (std::size_t i = 0; i < m; i++) c[i] -= w * v[i];
+            }
+        }
+
+        // Unblocked QR of the m x n matrix A
+        template <class T>
+        void geqr2(std::size_t m, std::size_t n, T *A, std::size_t lda, T *tau) {
+
+            const std::size_t k = std::min(m, n);
+
+            for (std::size_t i = 0; i < k; i++) {
+
+                T *aii = A + i + i * lda;
+                tau[i] = larfg(m - i, *aii, aii + 1);
+
+                if (i + 1 < n) {
+                    const T diag = *aii;
+                    *aii = T(1);
+                    larf(m - i, n - i - 1, aii, tau[i], aii + lda, lda);
+                    *aii = diag;
+                }
+            }
+        }
+
+        /**
+         * @brief Form the k x k upper triangular T with H_1 ... H_k = I - V T V^T
+         *
+         * V is m x k unit lower trapezoidal, stored below the diagonal of its columns.
+         * The inner products V^T V are formed with one gemm over the dense rows of V.
+         */
+        template <class T>
+        void larft(std::size_t m, std::size_t k, const T *V, std::size_t ldv, const T *tau,
+                   T *Tm, std::size_t ldt) {
+
+            // G(j, i) = v_j^T v_i for j < i: the unit head of V by hand, its dense tail by gemm
+            std::vector<T> G (k * k, T(0));
+            if (m > k) blas::gemm(blas::Op::T, blas::Op::N, k, k, m - k, T(1), V + k, ldv, V + k, ldv, T(0), G.data(), k);
+            for (std::size_t i = 0; i < k; i++) {
+                const T *vi = V + i * ldv;
+                for (std::size_t j = 0; j < i; j++) {
+                    const T *vj = V + j * ldv;
+                    T total = vj[i];
+                    for (std::size_t r = i + 1; r < std::min(k, m); r++) total += vj[r] * vi[r];
+                    G[j + i * k] += total;
+                }
+            }
+
+            for (std::size_t i = 0; i < k; i++) {
+
+                T *ti = Tm + i * ldt;
+
+                if (tau[i] == T(0)) {
+                    for (std::size_t r = 0; r <= i; r++) ti[r] = T(0);
+                    continue;
+                }
+
+                // T(0:i, i) = -tau_i T(0:i, 0:i) V(:, 0:i)^T v_i
+                const T *w = G.data() + i * k;
+                for (std::size_t r = 0; r < i; r++) {
+                    T total = 0;
+                    for (std::size_t c = r; c < i; c++) total += Tm[r + c * ldt] * w[c];
+                    ti[r] = -tau[i] * total;
+                }
+                ti[i] = tau[i];
+            }
+        }
+
+        /**
+         * @brief Apply H = I - V T V^T (op N) or H^T (op T) from the left to the m x n matrix C
+         *
+         * V is m x k unit lower trapezoidal. W = V^T C is formed with gemm on the dense
+         * part of V and a small triangular product on its unit k x k head.
+         */
+        template <class T>
+        void larfb(blas::Op op, std::size_t m, std::size_t n, std::size_t k,
+                   const T *V, std::size_t ldv, const T *Tm, std::size_t ldt, T *C, std::size_t ldc) {
+
+            using blas::Op;
+
+            if (m == 0 || n == 0 || k == 0) return;
+
+            std::vector<T> W (k * n);
+
+            // W = V1^T C1, V1 unit lower triangular k x k
+            for (std::size_t j = 0; j < n; j++) {
+                const T *c = C + j * ldc;
+                T *w = W.data() + j * k;
+                for (std::size_t i = 0; i < k; i++) {
+                    const T *vi = V + i * ldv;
+                    T total = c[i];
+                    for (std::size_t r = i + 1; r < k; r++) total += vi[r] * c[r];
+                    w[i] = total;
+                }
+            }
+
+            // W += V2^T C2
+            if (m > k) blas::gemm(Op::T, Op::N, k, n, m - k, T(1), V + k, ldv, C + k, ldc, T(1), W.data(), k);
+
+            // W = T W or T^T W, T upper triangular
+            for (std::size_t j = 0; j < n; j++) {
+                T *w = W.data() + j * k;
+                if (op == Op::N) {
+                    for (std::size_t i = 0; i < k; i++) {
+                        T total = 0;
+                        for (std::size_t c = i; c < k; c++) total += Tm[i + c * ldt] * w[c];
+                        w[i] = total;
+                    }
+                } else {
+                    for (std::size_t i = k; i-- > 0;) {
+                        T total = 0;
+                        for (std::size_t c = 0; c <= i; c++) total += Tm[c + i * ldt] * w[c];
+                        w[i] = total;
+                    }
+                }
+            }
+
+            // C2 -= V2 W
+            if (m > k) blas::gemm(Op::N, Op::N, m - k, n, k, T(-1), V + k, ldv, W.data(), k, T(1), C + k, ldc);
+
+            // C1 -= V1 W
+            for (std::size_t j = 0; j < n; j++) {
+                T *c = C + j * ldc;
+                const T *w = W.data() + j * k;
+                for (std::size_t i = 0; i < k; i++) {
+                    T total = w[i];
+                    for (std::size_t r = 0; r < i; r++) total += V[i + r * ldv] * w[r];
+                    c[i] -= total;
+                }
+            }
+        }
+
+        /**
+         * @brief Recursive panel QR (Elmroth & Gustavson)
+         *
+         * The left half of the panel is factored, applied to the right half in
+         * compact-WY form and the right half is factored in turn. For tall panels
+         * this moves most of the work out of the memory bound geqr2 and into gemm.
+         */
+        template <class T>
+        void geqr_rec(std::size_t m, std::size_t n, T *A, std::size_t lda, T *tau) {
+
+            if (n <= 8 || m <= n) {
+                geqr2(m, n, A, lda, tau);
+                return;
+            }
+
+            const std::size_t n1 = n / 2;
+            std::vector<T> Tm (n1 * n1);
+
+            geqr_rec(m, n1, A, lda, tau);
+            larft(m, n1, A, lda, tau, Tm.data(), n1);
+            larfb(blas::Op::T, m, n - n1, n1, A, lda, Tm.data(), n1, A + n1 * lda, lda);
+            geqr_rec(m - n1, n - n1, A + n1 + n1 * lda, lda, tau + n1);
+        }
+
+    };
+
+    /**
+     * @brief Factor the m x n column-major matrix A in place, A = Q R
+     *
+     * @param tau   min(m, n) reflector scalars on exit
+     * @param Ts    when not null, receives the T factor of each panel, block x block apiece
+     */
+    template <class T>
+    void geqrf(std::size_t m, std::size_t n, T *A, std::size_t lda, T *tau, std::size_t block = 32, T *Ts = nullptr) {
+
+        const std::size_t k = std::min(m, n);
+        if (block == 0) block = 32;
+
+        std::vector<T> tmp;
+        if (!Ts) tmp.resize(block * block);
+
+        for (std::size_t j = 0; j < k; j += block) {
+
+            const std::size_t jb = std::min(block, k - j);
+            T *panel = A + j + j * lda;
+            T *Tj = Ts ? Ts + (j / block) * block * block : tmp.data();
+
+            detail::geqr_rec(m - j, jb, panel, lda, tau + j);
+            detail::larft(m - j, jb, panel, lda, tau + j, Tj, block);
+
+            if (j + jb < n) {
+                detail::larfb(blas::Op::T, m - j, n - j - jb, jb, panel, lda, Tj, block, panel + jb * lda, lda);
+            }
+        }
+    }
+
+    /**
+     * @brief Reusable Householder QR factorization of an m x n matrix
+     *
+     * @code
+     * linalg::QR qr (A);
+     * auto Q = qr.Q();               // m x min(m, n), qr.Q(true) for the full m x m factor
+     * auto R = qr.R();
+     * auto c = qr.apply_qt(b);       // Q^T b without forming Q
+     * auto x = qr.solve(b);          // least squares solution of A x = b
+     * @endcode
+     *
+     * @tparam T floating point type
+     */
+    template <class T = double>
+    class QR {
+
+    public:
+
+        // Factor a copy of A
+        QR(const Matrix<T>& A, std::size_t block = 32) : QR(A.clone(), block) {}
+
+        // Factor A in place, taking over its storage
+        QR(Matrix<T>&& A, std::size_t block = 32)
+            : qr_{std::move(A)}
+            , block_{block == 0 ? 32 : block}
+        {
+            const std::size_t k = rank_bound();
+            tau_.resize(k);
+            ts_.resize(((k + block_ - 1) / block_) * block_ * block_);
+            geqrf(m(), n(), qr_.data.get(), m(), tau_.data(), block_, ts_.data());
+        }
+
+        std::size_t m() const { return qr_.nrow(); }
+        std::size_t n() const { return qr_.ncol(); }
+
+        // R above the diagonal, Householder vectors below it
+        const Matrix<T>& factors() const { return qr_; }
+        const std::vector<T>& tau() const { return tau_; }
+
+        // Economy R, min(m, n) x n upper trapezoidal
+        Matrix<T> R() const {
+            const std::size_t k = rank_bound();
+            Matrix<T> out = Matrix<T>::zeros(k, n());
+            for (std::size_t j = 0; j < n(); j++) {
+                for (std::size_t i = 0; i <= std::min(j, k - 1); i++) out.data[i + j * k] = qr_.data[i + j * m()];
+            }
+            return out;
+        }
+
+        // Economy Q (m x min(m, n)) with orthonormal columns, or the full m x m factor
+        Matrix<T> Q(bool full = false) const {
+            const std::size_t cols = full ? m() : rank_bound();
+            Matrix<T> out = Matrix<T>::id(m(), cols);
+            apply_q_in_place(out);
+            return out;
+        }
+
+        // Overwrite the m-row matrix B with Q^T B
+        void apply_qt_in_place(Matrix<T>& B) const {
+            const auto [ldb, nrhs] = detail::rhs_shape(B, m());
+            for (std::size_t j = 0; j < rank_bound(); j += block_) {
+                apply_block(blas::Op::T, j, B.data.get(), ldb, nrhs);
+            }
+        }
+
+        // Overwrite the m-row matrix B with Q B
+        void apply_q_in_place(Matrix<T>& B) const {
+            const auto [ldb, nrhs] = detail::rhs_shape(B, m());
+            const std::size_t k = rank_bound();
+            if (k == 0) return;
+            for (std::size_t j = ((k - 1) / block_) * block_ + block_; j > 0;) {
+                j -= block_;
+                apply_block(blas::Op::N, j, B.data.get(), ldb, nrhs);
+            }
+        }
+
+        Matrix<T> apply_qt(const Matrix<T>& B) const {
+            Matrix<T> out = B.clone();
+            apply_qt_in_place(out);
+            return out;
+        }
+
+        Matrix<T> apply_q(const Matrix<T>& B) const {
+            Matrix<T> out = B.clone();
+            apply_q_in_place(out);
+            return out;
+        }
+
+        /**
+         * @brief Least squares solution of A X = B for m >= n
+         *
+         * Minimizes ||A x - b||_2 for every column b of B using R x = (Q^T b)(0:n),
+         * which keeps the conditioning of A instead of squaring it like the normal
+         * equations do. Throws if R is singular, i.e. A is rank deficient.
+         */
+        Matrix<T> solve(const Matrix<T>& B) const {
+
+            if (m() < n()) throw std::runtime_error("QR::solve requires at least as many rows as columns, use lstsq");
+            check_full_rank();
+
+            Matrix<T> C = apply_qt(B);
+            const auto [ldb, nrhs] = detail::rhs_shape(C, m());
+
+            Matrix<T> X (n(), nrhs);
+            for (std::size_t j = 0; j < nrhs; j++) {
+                for (std::size_t i = 0; i < n(); i++) X.data[i + j * n()] = C.data[i + j * ldb];
+            }
+            blas::trsm(blas::Side::Left, blas::Uplo::Upper, blas::Op::N, blas::Diag::NonUnit,
+                       n(), nrhs, T(1), qr_.data.get(), m(), X.data.get(), n());
+
+            return (B.nrow() == 1 && m() != 1) ? X.as_rowvec() : X;
+        }
+
+        // Solve R^T Y = B in place, for the minimum norm solution of an underdetermined system
+        void solve_rt_in_place(Matrix<T>& B) const {
+            check_full_rank();
+            const auto [ldb, nrhs] = detail::rhs_shape(B, n());
+            blas::trsm(blas::Side::Left, blas::Uplo::Upper, blas::Op::T, blas::Diag::NonUnit,
+                       n(), nrhs, T(1), qr_.data.get(), m(), B.data.get(), ldb);
+        }
+
+    private:
+
+        Matrix<T> qr_;
+        std::vector<T> tau_;
+        std::vector<T> ts_;
+        std::size_t block_;
+
+        std::size_t rank_bound() const { return std::min(m(), n()); }
+
+        void apply_block(blas::Op op, std::size_t j, T *B, std::size_t ldb, std::size_t nrhs) const {
+            const std::size_t jb = std::min(block_, rank_bound() - j);
+            detail::larfb(op, m() - j, nrhs, jb, qr_.data.get() + j + j * m(), m(),
+                          ts_.data() + (j / block_) * block_ * block_, block_, B + j, ldb);
+        }
+
+        void check_full_rank() const {
+            for (std::size_t i = 0; i < rank_bound(); i++) {
+                if (qr_.data[i + i * m()] == T(0)) throw std::runtime_error("Matrix is rank deficient");
+            }
+        }
+
+    };
+
+    /**
+     * @brief Tall-skinny QR for m >> n
+     *
+     * The rows are split into `p` contiguous blocks which are factored in parallel;
+     * their p stacked n x n R factors are then factored once more. Only the small
+     * stacked problem is sequential, so the cost is one parallel pass over A.
+     *
+     * @tparam T floating point type
+     */
+    template <class T = double>
+    class TSQR {
+
+    public:
+
+        // p = 0 picks one block per thread, as long as every block has at least 2n rows
+        TSQR(const Matrix<T>& A, std::size_t p = 0) {
+
+            const std::size_t m = A.nrow(), n = A.ncol();
+            if (m < n) throw std::runtime_error("TSQR requires at least as many rows as columns");
+
+            if (p == 0) p = blas::max_threads();
+            p = std::max<std::size_t>(1, std::min(p, m / std::max<std::size_t>(2 * n, 1)));
+
+            m_ = m;
+            n_ = n;
+            offsets_.resize(p + 1);
+            for (std::size_t b = 0; b <= p; b++) offsets_[b] = (m * b) / p;
+
+            // Row blocks of a column-major matrix are strided; copy each into its own storage
+            std::vector<Matrix<T>> blocks (p);
+            for (std::size_t b = 0; b < p; b++) {
+                const std::size_t rows = offsets_[b + 1] - offsets_[b];
+                blocks[b] = Matrix<T>(rows, n);
+                for (std::size_t j = 0; j < n; j++) {
+                    std::copy_n(A.data.get() + offsets_[b] + j * m, rows, blocks[b].data.get() + j * rows);
+                }
+            }
+
+            local_.resize(p);
+            #pragma omp parallel for schedule(static) if(p > 1)
+            for (std::size_t b = 0; b < p; b++) {
+                local_[b] = std::make_unique<QR<T>>(std::move(blocks[b]));
+            }
+
+            Matrix<T> stacked = Matrix<T>::zeros(p * n, n);
+            for (std::size_t b = 0; b < p; b++) {
+                const Matrix<T> R = local_[b]->R();
+                for (std::size_t j = 0; j < n; j++) {
+                    for (std::size_t i = 0; i <= j; i++) stacked.data[b * n + i + j * p * n] = R.data[i + j * n];
+                }
+            }
+            top_ = std::make_unique<QR<T>>(std::move(stacked));
+        }
+
+        std::size_t blocks() const { return local_.size(); }
+
+        // n x n upper triangular factor
+        Matrix<T> R() const { return top_->R(); }
+
+        // First n rows of Q^T B
+        Matrix<T> apply_qt_head(const Matrix<T>& B) const {
+
+            const auto [ldb, nrhs] = detail::rhs_shape(B, m_);
+            const std::size_t p = blocks();
+
+            Matrix<T> stacked (p * n_, nrhs);
+
+            #pragma omp parallel for schedule(static) if(p > 1)
+            for (std::size_t b = 0; b < p; b++) {
+                const std::size_t rows = offsets_[b + 1] - offsets_[b];
+                Matrix<T> Bb (rows, nrhs);
+                for (std::size_t j = 0; j < nrhs; j++) {
+                    std::copy_n(B.data.get() + offsets_[b] + j * ldb, rows, Bb.data.get() + j * rows);
+                }
+                local_[b]->apply_qt_in_place(Bb);
+                for (std::size_t j = 0; j < nrhs; j++) {
+                    std::copy_n(Bb.data.get() + j * rows, n_, stacked.data.get() + b * n_ + j * p * n_);
+                }
+            }
+
+            top_->apply_qt_in_place(stacked);
+
+            Matrix<T> out (n_, nrhs);
+            for (std::size_t j = 0; j < nrhs; j++) {
+                std::copy_n(stacked.data.get() + j * p * n_, n_, out.data.get() + j * n_);
+            }
+            return out;
+        }
+
+        // Economy Q, m x n
+        Matrix<T> Q() const {
+
+            const std::size_t p = blocks();
+            const Matrix<T> Qs = top_->Q();     // p n x n
+            Matrix<T> out (m_, n_);
+
+            #pragma omp parallel for schedule(static) if(p > 1)
+            for (std::size_t b = 0; b < p; b++) {
+                const std::size_t rows = offsets_[b + 1] - offsets_[b];
+                Matrix<T> E = Matrix<T>::zeros(rows, n_);
+                for (std::size_t j = 0; j < n_; j++) {
+                    std::copy_n(Qs.data.get() + b * n_ + j * p * n_, n_, E.data.get() + j * rows);
+                }
+                local_[b]->apply_q_in_place(E);
+                for (std::size_t j = 0; j < n_; j++) {
+                    std::copy_n(E.data.get() + j * rows, rows, out.data.get() + offsets_[b] + j * m_);
+                }
+            }
+            return out;
+        }
+
+        // Least squares solution of A X = B
+        Matrix<T> solve(const Matrix<T>& B) const {
+            Matrix<T> X = apply_qt_head(B);
+            const Matrix<T>& top = top_->factors();
+            blas::trsm(blas::Side::Left, blas::Uplo::Upper, blas::Op::N, blas::Diag::NonUnit,
+                       n_, X.ncol(), T(1), top.data.get(), top.nrow(), X.data.get(), n_);
+            return (B.nrow() == 1 && m_ != 1) ? X.as_rowvec() : X;
+        }
+
+    private:
+
+        std::size_t m_;
+        std::size_t n_;
+        std::vector<std::size_t> offsets_;
+        std::vector<std::unique_ptr<QR<T>>> local_;
+        std::unique_ptr<QR<T>> top_;
+
+    };
+
+    template <class T>
+    QR<T> qr(const Matrix<T>& A, std::size_t block = 32) {
+        return QR<T>(A, block);
+    }
+
+    /**
+     * @brief Least squares solution of A X = B via Householder QR
+     *
+     * For m >= n, X minimizes ||A X - B||; very tall inputs go through TSQR.
+     * For m < n, X is the minimum norm solution, computed from the QR factorization
+     * of A^T: A = R^T Q^T, so X = Q R^{-T} B.
+     */
+    template <class T>
+    Matrix<T> lstsq(const Matrix<T>& A, const Matrix<T>& B) {
+
+        const std::size_t m = A.nrow(), n = A.ncol();
+
+        if (m >= n) {
+            if (m >= 64 * n && m * n >= (1 << 16) && blas::max_threads() > 1) return TSQR<T>(A).solve(B);
+            return QR<T>(A).solve(B);
+        }
+
+        QR<T> qrt (A.t());
+        const auto [ldb, nrhs] = detail::rhs_shape(B, m);
+
+        // Y = R^{-T} B, then X = Q [Y; 0]
+        Matrix<T> Y (m, nrhs);
+        std::copy_n(B.data.get(), m * nrhs, Y.data.get());
+        qrt.solve_rt_in_place(Y);
+
+        Matrix<T> X = Matrix<T>::zeros(n, nrhs);
+        for (std::size_t j = 0; j < nrhs; j++) std::copy_n(Y.data.get() + j * m, m, X.data.get() + j * n);
+        qrt.apply_q_in_place(X);
+        return (B.nrow() == 1 && m != 1) ? X.as_rowvec() : X;
+    }
+
+    };
+
+};
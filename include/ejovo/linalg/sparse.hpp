@@ -0,0 +1,225 @@
+/**========================================================================
+ * ?                          sparse.hpp
+ * @brief   : Compressed sparse row matrices and the ILU(0) preconditioner
+ * @details : SparseMatrix stores the nonzeros of each row contiguously with
+ *            sorted column indices (CSR). It models linalg::LinearOperator,
+ *            with a row-parallel SpMV, so it can be handed to any of the
+ *            Krylov solvers. Element access (i, j) is 1-based, like Matrix.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "operator.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    /**
+     * @brief Sparse matrix in compressed sparse row format
+     *
+     * @tparam T any arithmetic type
+     */
+    template <class T = double>
+    class SparseMatrix {
+
+    public:
+
+        // (row, column, value) with 1-based indices
+        using triplet = std::tuple<std::size_t, std::size_t, T>;
+
+        SparseMatrix() : m_{0}, n_{0}, row_ptr_(1, 0) {}
+
+        // Build from triplets; duplicate entries are summed
+        SparseMatrix(std::size_t m, std::size_t n, std::vector<triplet> entries)
+            : m_{m}
+            , n_{n}
+            , row_ptr_(m + 1, 0)
+        {
+            for (const auto& [i, j, v] : entries) {
+                if (i < 1 || i > m || j < 1 || j > n) throw std::runtime_error("Sparse entry out of bounds");
+            }
+
+            std::sort(entries.begin(), entries.end(), [] (const triplet& a, const triplet& b) {
+                return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+            });
+
+            std::size_t prev_i = 0, prev_j = 0;
+            for (const auto& [i, j, v] : entries) {
+                if (i == prev_i && j == prev_j) {
+                    val_.back() += v;
+                    continue;
+                }
+                col_.push_back(j - 1);
+                val_.push_back(v);
+                row_ptr_[i]++;
+                prev_i = i;
+                prev_j = j;
+            }
+
+            // counts to offsets
+            for (std::size_t i = 0; i < m; i++) row_ptr_[i + 1] += row_ptr_[i];
+        }
+
+        // Keep the entries of a dense matrix whose magnitude exceeds `drop`
+        explicit SparseMatrix(const Matrix<T>& A, T drop = T(0))
+            : m_{A.nrow()}
+            , n_{A.ncol()}
+            , row_ptr_(A.nrow() + 1, 0)
+        {
+            for (std::size_t i = 0; i < m_; i++) {
+                for (std::size_t j = 0; j < n_; j++) {
+                    const T v = A.data[i + j * m_];
+                    if (std::abs(v) > drop) {
+                        col_.push_back(j);
+                        val_.push_back(v);
+                    }
+                }
+                row_ptr_[i + 1] = col_.size();
+            }
+        }
+
+        std::size_t nrow() const { return m_; }
+        std::size_t ncol() const { return n_; }
+        std::size_t nnz() const { return val_.size(); }
+
+        // Element (i, j), 1-based, zero when not stored
+        T operator()(std::size_t i, std::size_t j) const {
+            const auto b = col_.begin() + row_ptr_[i - 1];
+            const auto e = col_.begin() + row_ptr_[i];
+            const auto it = std::lower_bound(b, e, j - 1);
+            return (it != e && *it == j - 1) ? val_[it - col_.begin()] : T(0);
+        }
+
+        // y = A x
+        void apply(const T *x, T *y) const {
+            #pragma omp parallel for if(nnz() >= (1 << 15)) schedule(static)
+            for (std::size_t i = 0; i < m_; i++) {
+                T total = 0;
+                for (std::size_t k = row_ptr_[i]; k < row_ptr_[i + 1]; k++) total += val_[k] * x[col_[k]];
+                y[i] = total;
+            }
+        }
+
+        Matrix<T> operator*(const Matrix<T>& x) const {
+            if (x.size() != n_) throw std::runtime_error("Sparse matrix and vector have incompatible dimensions");
+            Matrix<T> y (m_, 1);
+            apply(x.data.get(), y.data.get());
+            return y;
+        }
+
+        Matrix<T> to_matrix() const {
+            Matrix<T> out = Matrix<T>::zeros(m_, n_);
+            for (std::size_t i = 0; i < m_; i++) {
+                for (std::size_t k = row_ptr_[i]; k < row_ptr_[i + 1]; k++) out.data[i + col_[k] * m_] = val_[k];
+            }
+            return out;
+        }
+
+        const std::vector<std::size_t>& row_ptr() const { return row_ptr_; }
+        const std::vector<std::size_t>& col_idx() const { return col_; }
+        const std::vector<T>& values() const { return val_; }
+        std::vector<T>& values() { return val_; }
+
+    private:
+
+        std::size_t m_;
+        std::size_t n_;
+        std::vector<std::size_t> row_ptr_;
+        std::vector<std::size_t> col_;
+        std::vector<T> val_;
+
+    };
+
+    /**
+     * @brief Incomplete LU factorization with zero fill-in
+     *
+     * L and U keep exactly the sparsity pattern of A (L unit lower, U upper), so
+     * applying M^{-1} = (LU)^{-1} costs one sparse forward and back substitution.
+     * Every row of A must store its diagonal entry.
+     */
+    template <class T = double>
+    class ILU0 {
+
+    public:
+
+        explicit ILU0(const SparseMatrix<T>& A) : lu_{A}, diag_(A.nrow()) {
+
+            if (A.nrow() != A.ncol()) throw std::runtime_error("ILU(0) requires a square matrix");
+
+            const std::size_t n = A.nrow();
+            const auto& rp = lu_.row_ptr();
+            const auto& ci = lu_.col_idx();
+            auto& v = lu_.values();
+
+            for (std::size_t i = 0; i < n; i++) {
+                const auto b = ci.begin() + rp[i], e = ci.begin() + rp[i + 1];
+                const auto it = std::lower_bound(b, e, i);
+                if (it == e || *it != i) throw std::runtime_error("ILU(0) requires every diagonal entry to be stored");
+                diag_[i] = it - ci.begin();
+            }
+
+            // IKJ variant, restricted to the pattern of A
+            std::vector<std::ptrdiff_t> pos (n, -1);
+
+            for (std::size_t i = 1; i < n; i++) {
+
+                for (std::size_t k = rp[i]; k < rp[i + 1]; k++) pos[ci[k]] = k;
+
+                for (std::size_t kk = rp[i]; kk < rp[i + 1] && ci[kk] < i; kk++) {
+
+                    const std::size_t k = ci[kk];
+                    const T pivot = v[diag_[k]];
+                    if (pivot == T(0)) throw std::runtime_error("Zero pivot in ILU(0)");
+
+                    v[kk] /= pivot;
+                    const T lik = v[kk];
+
+                    for (std::size_t jj = diag_[k] + 1; jj < rp[k + 1]; jj++) {
+                        const std::ptrdiff_t p = pos[ci[jj]];
+                        if (p >= 0) v[p] -= lik * v[jj];
+                    }
+                }
+
+                for (std::size_t k = rp[i]; k < rp[i + 1]; k++) pos[ci[k]] = -1;
+            }
+        }
+
+        // z = (LU)^{-1} r
+        void solve(const T *r, T *z) const {
+
+            const std::size_t n = lu_.nrow();
+            const auto& rp = lu_.row_ptr();
+            const auto& ci = lu_.col_idx();
+            const auto& v = lu_.values();
+
+            for (std::size_t i = 0; i < n; i++) {
+                T total = r[i];
+                for (std::size_t k = rp[i]; k < diag_[i]; k++) total -= v[k] * z[ci[k]];
+                z[i] = total;
+            }
+
+            for (std::size_t i = n; i-- > 0;) {
+                T total = z[i];
+                for (std::size_t k = diag_[i] + 1; k < rp[i + 1]; k++) total -= v[k] * z[ci[k]];
+                z[i] = total / v[diag_[i]];
+            }
+        }
+
+    private:
+
+        SparseMatrix<T> lu_;
+        std::vector<std::size_t> diag_;
+
+    };
+
+    };
+
+};
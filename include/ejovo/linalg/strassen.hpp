@@ -0,0 +1,231 @@
+/**========================================================================
+ * ?                          strassen.hpp
+ * @brief   : Strassen-Winograd multiplication on top of the packed gemm
+ * @details : One level of the Winograd variant of Strassen's algorithm
+ *            multiplies 2 x 2 block matrices with 7 half-size products and 15
+ *            block additions instead of 8 products, so recursing down to a
+ *            crossover dimension n0 costs O(n^2.81) flops. Below n0, and for
+ *            the odd row or column peeled off at every level, blas::gemm does
+ *            the work.
+ *
+ *            The scheme is off by default: it is only enabled through
+ *            strassen_config(), and Matrix::operator* and operator^ then use
+ *            it for products whose three dimensions all reach the crossover,
+ *            which autotune_strassen() can measure on the current machine.
+ *
+ *            Error bound (Higham, Accuracy and Stability of Numerical
+ *            Algorithms, §23.2.2): for n x n operands, n / n0 a power of 2,
+ *
+ *                max|C - Ĉ| <= [(n/n0)^{log2 18} (n0^2 + 6 n0) - 6 n] u max|A| max|B|,
+ *
+ *            with u the unit roundoff. This is normwise only: unlike the
+ *            classical product, small entries of C can carry large relative
+ *            errors. With n0 = 1024 and n = 4096 the constant is about
+ *            18^2 / 4^2 ~ 20 times that of the classical bound n^2 u max|A| max|B|.
+ *
+ *            The 3 temporaries of every level are carved out of a single arena
+ *            allocated once per product, so the recursion itself never allocates.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+#include "blas.hpp"
+
+namespace ejovo {
+
+    namespace blas {
+
+    struct StrassenConfig {
+        bool enabled = false;               // used by Matrix::operator* and operator^ when true
+        std::size_t crossover = 1024;       // recurse while min(m, n, k) >= crossover
+    };
+
+    inline StrassenConfig& strassen_config() {
+        static StrassenConfig config;
+        return config;
+    }
+
+    namespace detail {
+
+        // C = A + sign B, all m x n
+        template <class T>
+        void madd(std::size_t m, std::size_t n, const T *A, std::size_t lda, const T *B, std::size_t ldb,
+                  T sign, T *C, std::size_t ldc) {
+            #pragma omp parallel for if(m * n >= parallel_flops) schedule(static)
+            for (std::size_t j = 0; j < n; j++) {
+                const T *a = A + j * lda, *b = B + j * ldb;
+                T *c = C + j * ldc;
+                #pragma omp simd
+                for (std::size_t i = 0; i < m; i++) c[i] = a[i] + sign * b[i];
+            }
+        }
+
+        // Workspace needed by strassen_rec for an m x n x k product
+        inline std::size_t strassen_workspace(std::size_t m, std::size_t n, std::size_t k, std::size_t n0) {
+            std::size_t total = 0;
+            while (std::min({m, n, k}) >= std::max<std::size_t>(n0, 2)) {
+                m /= 2; n /= 2; k /= 2;
+                total += m * k + k * n + m * n;
+            }
+            return total;
+        }
+
+        /**
+         * @brief C = A B with A m x k and B k x n, recursing while min(m, n, k) >= n0
+         *
+         * `work` holds at least strassen_workspace(m, n, k, n0) values.
+         */
+        template <class T>
+        void strassen_rec(std::size_t m, std::size_t n, std::size_t k, const T *A, std::size_t lda,
+                          const T *B, std::size_t ldb, T *C, std::size_t ldc, std::size_t n0, T *work) {
+
+            if (std::min({m, n, k}) < std::max<std::size_t>(n0, 2)) {
+                gemm(Op::N, Op::N, m, n, k, T(1), A, lda, B, ldb, T(0), C, ldc);
+                return;
+            }
+
+            // Even part by Winograd, the odd row, column and inner index peeled off afterwards
+            const std::size_t mh = m / 2, nh = n / 2, kh = k / 2;
+
+            const T *A11 = A, *A12 = A + kh * lda, *A21 = A + mh, *A22 = A + mh + kh * lda;
+            const T *B11 = B, *B12 = B + nh * ldb, *B21 = B + kh, *B22 = B + kh + nh * ldb;
+            T *C11 = C, *C12 = C + nh * ldc, *C21 = C + mh, *C22 = C + mh + nh * ldc;
+
+            T *X = work, *Y = X + mh * kh, *Z = Y + kh * nh, *next = Z + mh * nh;
+
+            auto mult = [&] (const T *a, std::size_t la, const T *b, std::size_t lb, T *c, std::size_t lc) {
+                strassen_rec(mh, nh, kh, a, la, b, lb, c, lc, n0, next);
+            };
+
+            madd(mh, kh, A11, lda, A21, lda, T(-1), X, mh);     // S3 = A11 - A21
+            madd(kh, nh, B22, ldb, B12, ldb, T(-1), Y, kh);     // T3 = B22 - B12
+            mult(X, mh, Y, kh, C21, ldc);                       // P7 = S3 T3
+
+            madd(mh, kh, A21, lda, A22, lda, T(1), X, mh);      // S1 = A21 + A22
+            madd(kh, nh, B12, ldb, B11, ldb, T(-1), Y, kh);     // T1 = B12 - B11
+            mult(X, mh, Y, kh, C22, ldc);                       // P5 = S1 T1
+
+            madd(mh, kh, X, mh, A11, lda, T(-1), X, mh);        // S2 = S1 - A11
+            madd(kh, nh, B22, ldb, Y, kh, T(-1), Y, kh);        // T2 = B22 - T1
+            mult(X, mh, Y, kh, C12, ldc);                       // P6 = S2 T2
+
+            madd(mh, kh, A12, lda, X, mh, T(-1), X, mh);        // S4 = A12 - S2
+            mult(X, mh, B22, ldb, C11, ldc);                    // P3 = S4 B22
+
+            mult(A11, lda, B11, ldb, Z, mh);                    // P1 = A11 B11
+            madd(mh, nh, Z, mh, C12, ldc, T(1), C12, ldc);      // U2 = P1 + P6
+            madd(mh, nh, C12, ldc, C21, ldc, T(1), C21, ldc);   // U3 = U2 + P7
+            madd(mh, nh, C12, ldc, C22, ldc, T(1), C12, ldc);   // U4 = U2 + P5
+            madd(mh, nh, C21, ldc, C22, ldc, T(1), C22, ldc);   // C22 = U7 = U3 + P5
+            madd(mh, nh, C12, ldc, C11, ldc, T(1), C12, ldc);   // C12 = U5 = U4 + P3
+
+            madd(kh, nh, Y, kh, B21, ldb, T(-1), Y, kh);        // T4 = T2 - B21
+            mult(A22, lda, Y, kh, C11, ldc);                    // P4 = A22 T4
+            madd(mh, nh, C21, ldc, C11, ldc, T(-1), C21, ldc);  // C21 = U6 = U3 - P4
+
+            mult(A12, lda, B21, ldb, C11, ldc);                 // P2 = A12 B21
+            madd(mh, nh, C11, ldc, Z, mh, T(1), C11, ldc);      // C11 = U1 = P1 + P2
+
+            const std::size_t m2 = 2 * mh, n2 = 2 * nh, k2 = 2 * kh;
+
+            // odd inner index: C(0:m2, 0:n2) += A(0:m2, k-1) B(k-1, 0:n2)
+            if (k2 < k) ger(m2, n2, T(1), A + (k - 1) * lda, 1, B + (k - 1), ldb, C, ldc);
+
+            // odd column of C: C(:, n-1) = A B(:, n-1)
+            if (n2 < n) gemv(Op::N, m, k, T(1), A, lda, B + (n - 1) * ldb, T(0), C + (n - 1) * ldc);
+
+            // odd row of C: C(m-1, 0:n2) = A(m-1, :) B(:, 0:n2)
+            if (m2 < m) {
+                for (std::size_t j = 0; j < n2; j++) {
+                    const T *b = B + j * ldb;
+                    T total = 0;
+                    for (std::size_t l = 0; l < k; l++) total += A[(m - 1) + l * lda] * b[l];
+                    C[(m - 1) + j * ldc] = total;
+                }
+            }
+        }
+
+    };
+
+    /**
+     * @brief C = A B by Strassen-Winograd recursion, A m x k, B k x n
+     *
+     * @param n0 crossover dimension, strassen_config().crossover when 0
+     */
+    template <class T>
+    void strassen(std::size_t m, std::size_t n, std::size_t k, const T *A, std::size_t lda,
+                  const T *B, std::size_t ldb, T *C, std::size_t ldc, std::size_t n0 = 0) {
+        if (n0 == 0) n0 = strassen_config().crossover;
+        std::vector<T> arena (detail::strassen_workspace(m, n, k, n0));
+        detail::strassen_rec(m, n, k, A, lda, B, ldb, C, ldc, n0, arena.data());
+    }
+
+    /**
+     * @brief C = A B, through Strassen-Winograd when it is enabled and the product is large enough
+     *
+     * This is the entry point of Matrix::operator* and operator^.
+     */
+    template <class T>
+    void multiply(std::size_t m, std::size_t n, std::size_t k, const T *A, std::size_t lda,
+                  const T *B, std::size_t ldb, T *C, std::size_t ldc) {
+        const auto& config = strassen_config();
+        if (config.enabled && std::min({m, n, k}) >= config.crossover) {
+            strassen(m, n, k, A, lda, B, ldb, C, ldc, config.crossover);
+        } else {
+            gemm(Op::N, Op::N, m, n, k, T(1), A, lda, B, ldb, T(0), C, ldc);
+        }
+    }
+
+    /**
+     * @brief Measure the smallest square size at which one Strassen level beats gemm
+     *
+     * Sizes 256, 384, 576, ... up to max_n are timed (best of 3); the first one
+     * where the one-level product is at least 5% faster becomes the crossover and the scheme is
+     * enabled. If gemm always wins the configuration is left disabled. Returns
+     * the crossover, 0 when none was found.
+     */
+    template <class T = double>
+    std::size_t autotune_strassen(std::size_t max_n = 2048) {
+
+        using clock = std::chrono::steady_clock;
+        auto time = [] (auto&& f) {
+            double best = std::numeric_limits<double>::max();
+            for (int rep = 0; rep < 3; rep++) {
+                const auto t0 = clock::now();
+                f();
+                best = std::min(best, std::chrono::duration<double>(clock::now() - t0).count());
+            }
+            return best;
+        };
+
+        for (std::size_t n = 256; n <= max_n; n += n / 2) {
+
+            std::vector<T> A (n * n), B (n * n), C (n * n);
+            for (std::size_t i = 0; i < n * n; i++) {
+                A[i] = T((i * 7 + 3) % 13) / T(13) - T(0.5);
+                B[i] = T((i * 5 + 1) % 11) / T(11) - T(0.5);
+            }
+
+            const double classical = time([&] { gemm(Op::N, Op::N, n, n, n, T(1), A.data(), n, B.data(), n, T(0), C.data(), n); });
+            const double fast = time([&] { strassen(n, n, n, A.data(), n, B.data(), n, C.data(), n, n); });
+
+            if (fast < 0.95 * classical) {
+                strassen_config().crossover = n;
+                strassen_config().enabled = true;
+                return n;
+            }
+        }
+
+        strassen_config().enabled = false;
+        return 0;
+    }
+
+    };
+
+};
@@ -0,0 +1,351 @@
+/**========================================================================
+ * ?                          svd.hpp
+ * @brief   : Singular value decomposition and randomized low-rank approximation
+ * @details : svd computes the thin SVD A = U diag(S) V^T. A is first reduced to
+ *            its square R factor with QR, which is then diagonalized by the
+ *            one-sided (Hestenes) Jacobi method: plane rotations orthogonalize
+ *            the columns of R, leaving R V = U diag(S). Jacobi is accurate to
+ *            high relative precision and is only ever run on small matrices here.
+ *
+ *            rsvd approximates the leading k singular triplets of a large A with
+ *            the Halko-Martinsson-Tropp range finder
+ *
+ *                Y = (A A^T)^q A Omega,   Q = orth(Y),   B = Q^T A,
+ *
+ *            where Omega has k + oversample random columns, and takes the exact
+ *            SVD of the small B. Every product is a GEMM and the power iterations
+ *            are re-orthonormalized with QR.
+ *
+ *            StreamingSVD sees every row of A exactly once (a file that is mmap'd
+ *            or read in chunks) and uses the single pass sketch of Tropp et al.:
+ *            alongside Y = A Omega it accumulates W = Psi A and Psi Y, and recovers
+ *            B from Psi A ~ (Psi Y)(Psi Y)^+ Psi A without revisiting A.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+#include "qr.hpp"
+#include "operator.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    // Thin SVD A = U diag(S) Vt, singular values in decreasing order as a column vector
+    template <class T = double>
+    struct SVD {
+        Matrix<T> U;
+        Matrix<T> S;
+        Matrix<T> Vt;
+    };
+
+    struct RandomizedOptions {
+        std::size_t oversample = 10;    // extra sample columns beyond the target rank
+        std::size_t power_iters = 2;    // passes of (A A^T), sharpen a slowly decaying spectrum
+    };
+
+    namespace detail {
+
+        /**
+         * @brief One-sided Jacobi SVD of an m x n matrix with m >= n
+         *
+         * On exit the columns of A are U diag(s), s holds the column norms and V
+         * (n x n, ldv) accumulates the rotations. Returns the number of sweeps.
+         */
+        template <class T>
+        std::size_t gesvj(std::size_t m, std::size_t n, T *A, std::size_t lda, T *s, T *V, std::size_t ldv, std::size_t max_sweeps = 60) {
+
+            const T tol = std::numeric_limits<T>::epsilon() * std::sqrt(T(m));
+            std::size_t sweep = 0;
+
+            for (; sweep < max_sweeps; sweep++) {
+
+                bool rotated = false;
+
+                for (std::size_t p = 0; p + 1 < n; p++) {
+                    for (std::size_t q = p + 1; q < n; q++) {
+
+                        T *ap = A + p * lda, *aq = A + q * lda;
+                        T alpha = 0, beta = 0, gamma = 0;
+                        #pragma omp simd reduction(+:alpha, beta, gamma)
+                        for (std::size_t i = 0; i < m; i++) {
+                            alpha += ap[i] * ap[i];
+                            beta += aq[i] * aq[i];
+                            gamma += ap[i] * aq[i];
+                        }
+
+                        if (std::abs(gamma) <= tol * std::sqrt(alpha * beta) || gamma == T(0)) continue;
+                        rotated = true;
+
+                        const T zeta = (beta - alpha) / (2 * gamma);
+                        const T t = std::copysign(T(1), zeta) / (std::abs(zeta) + std::sqrt(1 + zeta * zeta));
+                        const T c = 1 / std::sqrt(1 + t * t);
+                        const T sn = c * t;
+
+                        #pragma omp simd
+                        for (std::size_t i = 0; i < m; i++) {
+                            const T x = ap[i], y = aq[i];
+                            ap[i] = c * x - sn * y;
+                            aq[i] = sn * x + c * y;
+                        }
+
+                        T *vp = V + p * ldv, *vq = V + q * ldv;
+                        #pragma omp simd
+                        for (std::size_t i = 0; i < n; i++) {
+                            const T x = vp[i], y = vq[i];
+                            vp[i] = c * x - sn * y;
+                            vq[i] = sn * x + c * y;
+                        }
+                    }
+                }
+
+                if (!rotated) break;
+            }
+
+            for (std::size_t j = 0; j < n; j++) s[j] = nrm2(m, A + j * lda);
+            return sweep;
+        }
+
+        // Orthonormal basis of the range of a full column rank Y, taking over its storage
+        template <class T>
+        Matrix<T> orthonormalize(Matrix<T>&& Y) {
+            const std::size_t m = Y.nrow(), n = Y.ncol();
+            if (m >= 64 * n && m * n >= (1 << 16) && blas::max_threads() > 1) return TSQR<T>(Y).Q();
+            return QR<T>(std::move(Y)).Q();
+        }
+
+        // Keep the leading k triplets
+        template <class T>
+        void truncate(SVD<T>& f, std::size_t k) {
+            k = std::min(k, f.S.size());
+            if (k == f.S.size()) return;
+            const std::size_t n = f.Vt.ncol();
+            Matrix<T> U (f.U.nrow(), k), S (k, 1), Vt (k, n);
+            std::copy_n(f.U.data.get(), f.U.nrow() * k, U.data.get());
+            std::copy_n(f.S.data.get(), k, S.data.get());
+            for (std::size_t j = 0; j < n; j++) std::copy_n(f.Vt.data.get() + j * f.Vt.nrow(), k, Vt.data.get() + j * k);
+            f = SVD<T>{std::move(U), std::move(S), std::move(Vt)};
+        }
+
+    };
+
+    /**
+     * @brief Thin singular value decomposition
+     *
+     * For an m x n matrix A with r = min(m, n), returns U (m x r) and V (n x r) with
+     * orthonormal columns and S (r x 1) decreasing such that A = U diag(S) V^T.
+     * Columns of U paired with an exactly zero singular value are left zero.
+     */
+    template <class T>
+    SVD<T> svd(const Matrix<T>& A) {
+
+        const std::size_t m = A.nrow(), n = A.ncol();
+        if (m * n == 0) return SVD<T>{Matrix<T>(m, 0), Matrix<T>(0, 1), Matrix<T>(0, n)};
+
+        // A^T = U' S V'^T  =>  A = V' S U'^T
+        if (m < n) {
+            SVD<T> f = svd(A.t());
+            return SVD<T>{f.Vt.t(), std::move(f.S), f.U.t()};
+        }
+
+        // A = Q R, then R = U_r S V^T and U = Q U_r
+        QR<T> qr (A);
+        Matrix<T> R = qr.R();
+        Matrix<T> V = Matrix<T>::id(n);
+        std::vector<T> s (n);
+        detail::gesvj(n, n, R.data.get(), n, s.data(), V.data.get(), n);
+
+        std::vector<std::size_t> order (n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&] (std::size_t a, std::size_t b) { return s[a] > s[b]; });
+
+        Matrix<T> Ur = Matrix<T>::zeros(m, n);
+        SVD<T> out {Matrix<T>(), Matrix<T>(n, 1), Matrix<T>(n, n)};
+
+        for (std::size_t j = 0; j < n; j++) {
+            const std::size_t c = order[j];
+            out.S.data[j] = s[c];
+            if (s[c] > T(0)) {
+                for (std::size_t i = 0; i < n; i++) Ur.data[i + j * m] = R.data[i + c * n] / s[c];
+            }
+            for (std::size_t i = 0; i < n; i++) out.Vt.data[j + i * n] = V.data[i + c * n];
+        }
+
+        qr.apply_q_in_place(Ur);
+        out.U = std::move(Ur);
+        return out;
+    }
+
+    // Singular values only, in decreasing order
+    template <class T>
+    Matrix<T> svdvals(const Matrix<T>& A) {
+        return svd(A).S;
+    }
+
+    /**
+     * @brief Randomized truncated SVD of rank k (Halko, Martinsson and Tropp)
+     *
+     * Costs (2 q + 2) passes over A, each a GEMM with k + oversample columns.
+     * The leading singular values are accurate when the spectrum decays past k;
+     * more power iterations trade passes for accuracy otherwise.
+     */
+    template <class T>
+    SVD<T> rsvd(const Matrix<T>& A, std::size_t k, RandomizedOptions opts = {}) {
+
+        using blas::Op;
+        const std::size_t m = A.nrow(), n = A.ncol();
+        if (k == 0 || k > std::min(m, n)) throw std::runtime_error("Invalid rank for the randomized SVD");
+
+        const std::size_t l = std::min(k + opts.oversample, std::min(m, n));
+        const T *a = A.data.get();
+
+        // Y = A Omega
+        Matrix<T> Omega = Matrix<T>::rand(n, l, -1, 1);
+        Matrix<T> Y (m, l);
+        blas::gemm(Op::N, Op::N, m, l, n, T(1), a, m, Omega.data.get(), n, T(0), Y.data.get(), m);
+        Matrix<T> Q = detail::orthonormalize(std::move(Y));
+
+        // Subspace iteration, orthonormalizing after every product
+        for (std::size_t it = 0; it < opts.power_iters; it++) {
+            Matrix<T> Z (n, l);
+            blas::gemm(Op::T, Op::N, n, l, m, T(1), a, m, Q.data.get(), m, T(0), Z.data.get(), n);
+            Z = detail::orthonormalize(std::move(Z));
+            Y = Matrix<T>(m, l);
+            blas::gemm(Op::N, Op::N, m, l, n, T(1), a, m, Z.data.get(), n, T(0), Y.data.get(), m);
+            Q = detail::orthonormalize(std::move(Y));
+        }
+
+        // B = Q^T A is l x n
+        Matrix<T> B (l, n);
+        blas::gemm(Op::T, Op::N, l, n, m, T(1), Q.data.get(), m, a, m, T(0), B.data.get(), l);
+
+        SVD<T> small = svd(B);
+        detail::truncate(small, k);
+
+        Matrix<T> U (m, small.S.size());
+        blas::gemm(Op::N, Op::N, m, U.ncol(), l, T(1), Q.data.get(), m, small.U.data.get(), l, T(0), U.data.get(), m);
+
+        return SVD<T>{std::move(U), std::move(small.S), std::move(small.Vt)};
+    }
+
+    /**
+     * @brief Single pass randomized SVD over a matrix delivered in blocks of rows
+     *
+     * @code
+     * linalg::StreamingSVD<double> sketch (n, k);
+     * for (auto& chunk : source) sketch.push(chunk);       // r x n blocks, any r
+     * auto [U, S, Vt] = sketch.finish();
+     * @endcode
+     *
+     * Rows that live in a raw row-major buffer (an mmap'd file of samples) can be
+     * pushed without copying with push(ptr, rows). Only the m x (k + p) sketch Y
+     * and two small matrices are kept, never A itself. Power iterations need a
+     * second pass, so the accuracy is that of rsvd with power_iters = 0.
+     */
+    template <class T = double>
+    class StreamingSVD {
+
+    public:
+
+        StreamingSVD(std::size_t n, std::size_t k, RandomizedOptions opts = {})
+            : n_{n}
+            , k_{k}
+            , l_{std::min(k + opts.oversample, n)}
+            , s_{2 * l_ + 1}
+            , omega_{Matrix<T>::rand(n, l_, -1, 1)}
+            , W_{Matrix<T>::zeros(s_, n)}
+            , psiY_{Matrix<T>::zeros(s_, l_)}
+        {
+            if (k == 0 || k > n) throw std::runtime_error("Invalid rank for the randomized SVD");
+        }
+
+        std::size_t rows() const { return m_; }
+
+        // Append an r x n block of rows
+        void push(const Matrix<T>& rows) {
+            if (rows.ncol() != n_) throw std::runtime_error("Block has the wrong number of columns");
+            accumulate(rows.nrow(), rows.data.get(), blas::Op::N);
+        }
+
+        // Append r rows stored contiguously in row-major order (r * n values)
+        void push(const T *rows, std::size_t r) {
+            accumulate(r, rows, blas::Op::T);
+        }
+
+        // Rank-k approximation of all the rows pushed so far
+        SVD<T> finish() const {
+
+            using blas::Op;
+            if (m_ < l_) throw std::runtime_error("StreamingSVD needs at least k + oversample rows");
+
+            // Y = Q R, so Psi A ~ Psi Y X and B = Q^T A ~ R X with X = (Psi Y)^+ W
+            Matrix<T> Y (m_, l_);
+            std::size_t offset = 0;
+            for (const auto& blk : Y_) {
+                const std::size_t r = blk.nrow();
+                for (std::size_t j = 0; j < l_; j++) std::copy_n(blk.data.get() + j * r, r, Y.data.get() + offset + j * m_);
+                offset += r;
+            }
+
+            QR<T> qr (std::move(Y));
+            const Matrix<T> X = QR<T>(psiY_).solve(W_);
+            Matrix<T> B (l_, n_);
+            const Matrix<T> R = qr.R();
+            blas::gemm(Op::N, Op::N, l_, n_, l_, T(1), R.data.get(), l_, X.data.get(), l_, T(0), B.data.get(), l_);
+
+            SVD<T> small = svd(B);
+            detail::truncate(small, k_);
+
+            Matrix<T> U = Matrix<T>::zeros(m_, small.S.size());
+            for (std::size_t j = 0; j < U.ncol(); j++) std::copy_n(small.U.data.get() + j * l_, l_, U.data.get() + j * m_);
+            qr.apply_q_in_place(U);
+
+            return SVD<T>{std::move(U), std::move(small.S), std::move(small.Vt)};
+        }
+
+    private:
+
+        std::size_t n_;
+        std::size_t k_;
+        std::size_t l_;                 // range sketch size
+        std::size_t s_;                 // co-range sketch size
+        std::size_t m_ = 0;             // rows seen
+        Matrix<T> omega_;               // n x l
+        Matrix<T> W_;                   // Psi A, s x n
+        Matrix<T> psiY_;                // Psi Y, s x l
+        std::vector<Matrix<T>> Y_;      // A Omega, one r x l block per push
+
+        // `op` is N for a column-major r x n block, T for a row-major one (seen as n x r)
+        void accumulate(std::size_t r, const T *a, blas::Op op) {
+
+            using blas::Op;
+            if (r == 0) return;
+            const std::size_t lda = op == Op::N ? r : n_;
+
+            Matrix<T> Yi (r, l_);
+            blas::gemm(op, Op::N, r, l_, n_, T(1), a, lda, omega_.data.get(), n_, T(0), Yi.data.get(), r);
+
+            // The columns of Psi for these rows are drawn once and never needed again
+            Matrix<T> psi = Matrix<T>::rand(s_, r, -1, 1);
+            blas::gemm(Op::N, op == Op::N ? Op::N : Op::T, s_, n_, r, T(1), psi.data.get(), s_, a, lda, T(1), W_.data.get(), s_);
+            blas::gemm(Op::N, Op::N, s_, l_, r, T(1), psi.data.get(), s_, Yi.data.get(), r, T(1), psiY_.data.get(), s_);
+
+            Y_.push_back(std::move(Yi));
+            m_ += r;
+        }
+
+    };
+
+    };
+
+};
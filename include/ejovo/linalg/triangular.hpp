@@ -0,0 +1,74 @@
+/**========================================================================
+ * ?                          triangular.hpp
+ * @brief   : Forward and back substitution with many right hand sides
+ * @details : Thin Matrix wrappers over blas::trsm. Only the relevant triangle
+ *            of the coefficient matrix is read, so the packed output of a
+ *            factorization can be passed directly. A row vector of matching
+ *            length is treated as a single right hand side.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <stdexcept>
+
+#include "types.hpp"
+#include "blas.hpp"
+
+namespace ejovo {
+
+    namespace linalg {
+
+    namespace detail {
+
+        // (leading dimension, number of right hand sides) of B against an n x n system
+        template <class T>
+        std::pair<std::size_t, std::size_t> rhs_shape(const Matrix<T>& B, std::size_t n) {
+            if (B.nrow() == n) return {n, B.ncol()};
+            if (B.nrow() == 1 && B.ncol() == n) return {n, 1};
+            throw std::runtime_error("Right hand side has the wrong number of rows");
+        }
+
+        template <class T>
+        void substitute(blas::Uplo uplo, blas::Op op, blas::Diag diag, const Matrix<T>& A, Matrix<T>& B) {
+            if (!A.is_square()) throw std::runtime_error("Triangular solve requires a square matrix");
+            const std::size_t n = A.nrow();
+            const auto [ldb, nrhs] = rhs_shape(B, n);
+            blas::trsm(blas::Side::Left, uplo, op, diag, n, nrhs, T(1), A.data.get(), n, B.data.get(), ldb);
+        }
+
+    };
+
+    // Overwrite B with L^{-1} B (or L^{-T} B when `transpose`), L lower triangular
+    template <class T>
+    void forward_sub_in_place(const Matrix<T>& L, Matrix<T>& B, bool transpose = false, bool unit = false) {
+        detail::substitute(blas::Uplo::Lower, transpose ? blas::Op::T : blas::Op::N,
+                           unit ? blas::Diag::Unit : blas::Diag::NonUnit, L, B);
+    }
+
+    // Overwrite B with U^{-1} B (or U^{-T} B when `transpose`), U upper triangular
+    template <class T>
+    void back_sub_in_place(const Matrix<T>& U, Matrix<T>& B, bool transpose = false, bool unit = false) {
+        detail::substitute(blas::Uplo::Upper, transpose ? blas::Op::T : blas::Op::N,
+                           unit ? blas::Diag::Unit : blas::Diag::NonUnit, U, B);
+    }
+
+    // Solve L X = B for lower triangular L
+    template <class T>
+    Matrix<T> forward_sub(const Matrix<T>& L, const Matrix<T>& B) {
+        Matrix<T> X = B.clone();
+        forward_sub_in_place(L, X);
+        return X;
+    }
+
+    // Solve U X = B for upper triangular U
+    template <class T>
+    Matrix<T> back_sub(const Matrix<T>& U, const Matrix<T>& B) {
+        Matrix<T> X = B.clone();
+        back_sub_in_place(U, X);
+        return X;
+    }
+
+    };
+
+};
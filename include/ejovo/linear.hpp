@@ -1,41 +1,47 @@
 // Definitions for linear algebra functions that operate on symmetric positive definite matrices
 
+#pragma once
+
 #include "types.hpp"
 #include "core.hpp"
+#include "linalg/kronecker.hpp"
+#include "linalg/blas.hpp"
+#include "linalg/lu.hpp"
+#include "linalg/triangular.hpp"
+#include "linalg/cholesky.hpp"
+#include "linalg/qr.hpp"
+#include "linalg/eigen.hpp"
+#include "linalg/svd.hpp"
+#include "linalg/expm.hpp"
+#include "linalg/covariance.hpp"
+#include "linalg/chain.hpp"
+#include "linalg/batched.hpp"
+#include "linalg/operator.hpp"
+#include "linalg/sparse.hpp"
+#include "linalg/krylov.hpp"
 
 namespace ejovo {
 
     // Take a positive definite symmetric matrix and return the cholesky decomposition
+    // K = L L^T. Only the lower triangle of K is read. Returns a null matrix when K is
+    // not positive definite.
     template<class T>
     Matrix<T> chol(const Matrix<T>& K) {
 
         if (!K.is_square()) return K.null();
 
-        const std::size_t n = K.nrow();
-        Matrix<T> L (n, n);
-
-        for (std::size_t i = 1; i <= n; i++) {
-
-            for (std::size_t j = 1; j <= i; j++) {
-
-                T sum = 0;
-
-                for (std::size_t k = 1; k < i; k++) {
-                    sum += L(i, k) * L(j, k);
-                }
-
-                if (i == j) {
-                    L(i, j) = std::sqrt(K(i, i) - sum);
-                } else {
-                    L(i, j) = (1.0 / L(i, j) * (K(i, j) - sum));
-                }
-
-            }
+        linalg::Cholesky<T> ch (K);
+        if (!ch.is_spd()) {
+            std::cerr << "Matrix is not positive definite (failed at column " << ch.info() << ")\n";
+            return K.null();
         }
 
-        return L;
+        return ch.L();
     }
 
+    // Left-looking "gaxpy" Cholesky (Golub & Van Loan, Alg. 4.2.1): column j of L is
+    // A(j:n, j) - L(j:n, 1:j-1) L(j, 1:j-1)^T scaled by the square root of its first
+    // entry. Kept as an unblocked reference for chol.
     template <class T>
     Matrix<T> chol_gaxpy(const Matrix<T>& K) {
 
@@ -43,37 +49,26 @@ namespace ejovo {
         const std::size_t n = K.nrow();
 
         auto A = K.clone();
+        T *a = A.data.get();
 
-        A.print();
+        for (std::size_t j = 0; j < n; j++) {
 
-        for (std::size_t j = 1; j <= n; j++) {
-
-            if (j > 1) {
-
-                std::cout << "j := " << j << "\n";
-
-                auto col = A.get_col_view(j, j, n);
-
-
-                std::cout << "j:n := ";
-                seq<int>(j, n).print();
-                seq<int>(1, j - 1).print();
-
-                auto sub = A(seq<int>(j, n), seq<int>(1, j - 1));
-                // auto tmat = (A.get_row_view(j, 1, j - 1)).to_matrix().transpose();
-
-                col.print();
-                sub.print();
-                // tmat.print();
-
-                // A(j:n, j)
-                // col = col - sub.dot(tmat);
+            T *aj = a + j * n;
 
+            for (std::size_t k = 0; k < j; k++) {
+                const T *ak = a + k * n;
+                const T ljk = ak[j];
+                for (std::size_t i = j; i < n; i++) aj[i] -= ak[i] * ljk;
             }
 
-            auto col2 = A.get_col_view(j, j, n);
-            col2 = col2 / std::sqrt(A(j, j));
+            if (!(aj[j] > 0)) {
+                std::cerr << "Matrix is not positive definite (failed at column " << j + 1 << ")\n";
+                return K.null();
+            }
 
+            const T d = std::sqrt(aj[j]);
+            for (std::size_t i = j; i < n; i++) aj[i] /= d;
+            for (std::size_t i = 0; i < j; i++) aj[i] = 0;
         }
 
         return A;
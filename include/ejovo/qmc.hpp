@@ -0,0 +1,353 @@
+/**========================================================================
+ * ?                          qmc.hpp
+ * @brief   : Quasi-Monte Carlo point sets: Sobol, Halton, Latin hypercube
+ * @details : Low-discrepancy sequences fill [0, 1)^d far more evenly than
+ *            pseudo-random points: for smooth integrands the error of an
+ *            equal-weight rule falls like (log n)^d / n instead of n^-1/2.
+ *
+ *            Sobol: base-2 digital sequence with the Joe & Kuo direction
+ *            numbers ("Constructing Sobol sequences with better two-dimensional
+ *            projections", SIAM J. Sci. Comput. 30, 2008; file new-joe-kuo-6,
+ *            first 40 dimensions), 32-bit precision. Successive points are one
+ *            xor per coordinate apart in Gray-code order (Antonov & Saleev);
+ *            point n is also available directly, in O(32 d).
+ *
+ *            Halton: radical inverses in the first d primes, optionally
+ *            scrambled by a random permutation of the digits of each base,
+ *            which breaks the correlations between high-dimensional coordinates.
+ *
+ *            Both expose the same sequential interface (next, seek, discard)
+ *            so that a parallel chunk can start anywhere in the sequence, and
+ *            points(n), an n x d Matrix with one point per row.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <bit>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "ejovo/rng/engine.hpp"
+
+namespace ejovo {
+
+    namespace qmc {
+
+    namespace detail {
+
+        // Primitive polynomial x^s + a_1 x^{s-1} + ... + a_{s-1} x + 1 (a holds a_1 ... a_{s-1})
+        // and initial direction numbers m_1, ..., m_s of one Sobol dimension
+        struct SobolRow {
+            uint8_t s;
+            uint8_t a;
+            uint16_t m[8];
+        };
+
+        // Dimensions 2 to 40 of new-joe-kuo-6.21201 (dimension 1 is the van der Corput sequence)
+        inline constexpr SobolRow joe_kuo[] = {
+            {1, 0, {1}},
+            {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}},
+            {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}},
+            {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}},
+            {5, 4, {1, 1, 5, 5, 5}},
+            {5, 7, {1, 1, 7, 11, 19}},
+            {5, 11, {1, 1, 5, 1, 1}},
+            {5, 13, {1, 1, 1, 3, 11}},
+            {5, 14, {1, 3, 5, 5, 31}},
+            {6, 1, {1, 3, 3, 9, 7, 49}},
+            {6, 13, {1, 1, 1, 15, 21, 21}},
+            {6, 16, {1, 3, 1, 13, 27, 49}},
+            {6, 19, {1, 1, 1, 15, 7, 5}},
+            {6, 22, {1, 3, 1, 15, 13, 25}},
+            {6, 25, {1, 1, 5, 5, 19, 61}},
+            {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+            {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+            {7, 7, {1, 1, 3, 13, 7, 35, 63}},
+            {7, 8, {1, 3, 5, 9, 1, 25, 53}},
+            {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+            {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+            {7, 21, {1, 1, 5, 11, 19, 41, 61}},
+            {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+            {7, 31, {1, 1, 7, 13, 1, 19, 1}},
+            {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+            {7, 37, {1, 1, 3, 9, 25, 29, 41}},
+            {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+            {7, 42, {1, 3, 7, 3, 13, 59, 17}},
+            {7, 50, {1, 3, 1, 3, 5, 53, 69}},
+            {7, 55, {1, 1, 5, 5, 23, 33, 13}},
+            {7, 56, {1, 1, 7, 7, 1, 61, 123}},
+            {7, 59, {1, 1, 7, 9, 13, 61, 49}},
+            {7, 62, {1, 3, 3, 5, 3, 55, 33}},
+            {8, 14, {1, 3, 1, 15, 31, 13, 49, 245}},
+            {8, 21, {1, 3, 5, 15, 31, 59, 63, 97}},
+            {8, 22, {1, 3, 1, 11, 11, 11, 77, 249}},
+        };
+
+        // The first n primes
+        inline std::vector<uint32_t> primes(std::size_t n) {
+            std::vector<uint32_t> out;
+            out.reserve(n);
+            for (uint32_t c = 2; out.size() < n; c++) {
+                bool prime = true;
+                for (uint32_t p : out) {
+                    if (p * p > c) break;
+                    if (c % p == 0) {
+                        prime = false;
+                        break;
+                    }
+                }
+                if (prime) out.push_back(c);
+            }
+            return out;
+        }
+
+        // High and low 64 bits of the 128 bit product a b
+        inline uint64_t mul_wide(uint64_t a, uint64_t b, uint64_t& lo) {
+        #ifdef __SIZEOF_INT128__
+            const unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+            lo = static_cast<uint64_t>(p);
+            return static_cast<uint64_t>(p >> 64);
+        #else
+            const uint64_t a0 = a & 0xffffffff, a1 = a >> 32, b0 = b & 0xffffffff, b1 = b >> 32;
+            const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+            const uint64_t mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+            lo = (mid << 32) | (p00 & 0xffffffff);
+            return p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+        #endif
+        }
+
+        // Unbiased integer in [0, n), n > 0 (Lemire's multiply-shift with rejection)
+        template <class G>
+        uint64_t below(G& g, uint64_t n) {
+            uint64_t lo;
+            uint64_t hi = mul_wide(g.next(), n, lo);
+            if (lo < n) {
+                const uint64_t t = (0 - n) % n;     // 2^64 mod n
+                while (lo < t) hi = mul_wide(g.next(), n, lo);
+            }
+            return hi;
+        }
+
+        // The next n points of a point set, one per row
+        template <class P>
+        Matrix<double> take(P& set, int n) {
+            if (n <= 0) return Matrix<double>::null();
+            const std::size_t d = set.dim();
+            Matrix<double> out(n, d);
+            for (int i = 0; i < n; i++) set.next(out.data.get() + i, n);
+            return out;
+        }
+
+    };
+
+    /**
+     * @brief The Sobol sequence in [0, 1)^d
+     *
+     * @code
+     * qmc::Sobol sobol (3);
+     * auto X = sobol.points(1024);   // 1024 x 3, one point per row
+     * @endcode
+     */
+    class Sobol {
+
+    public:
+
+        static constexpr std::size_t bits = 32;
+        static constexpr std::size_t max_dim = std::size(detail::joe_kuo) + 1;
+
+        explicit Sobol(std::size_t dim) : dim_{dim}, v_(bits * dim), x_(dim, 0), shift_(dim, 0) {
+
+            if (dim == 0 || dim > max_dim) throw std::runtime_error("Sobol sequences are available in 1 to 40 dimensions");
+
+            // dimension 1: v_k = 2^{-k}
+            for (std::size_t k = 0; k < bits; k++) v_[k * dim] = uint32_t(1) << (bits - 1 - k);
+
+            for (std::size_t j = 1; j < dim; j++) {
+                const auto& row = detail::joe_kuo[j - 1];
+                const std::size_t s = row.s;
+                auto v = [&] (std::size_t k) -> uint32_t& { return v_[k * dim + j]; };
+                for (std::size_t k = 0; k < s; k++) v(k) = uint32_t(row.m[k]) << (bits - 1 - k);
+                // v_k = a_1 v_{k-1} ^ ... ^ a_{s-1} v_{k-s+1} ^ v_{k-s} ^ (v_{k-s} >> s)
+                for (std::size_t k = s; k < bits; k++) {
+                    uint32_t w = v(k - s) ^ (v(k - s) >> s);
+                    for (std::size_t i = 1; i < s; i++) {
+                        if ((row.a >> (s - 1 - i)) & 1) w ^= v(k - i);
+                    }
+                    v(k) = w;
+                }
+            }
+        }
+
+        std::size_t dim() const { return dim_; }
+
+        // Index of the next point
+        uint64_t index() const { return index_; }
+
+        /**
+         * @brief Random digital shift: xor every point with a random vector
+         *
+         * The shifted sequence keeps its net structure and is uniformly
+         * distributed, so independent shifts give unbiased replicates of an
+         * estimate (randomized QMC) and an error bar.
+         */
+        Sobol& scramble(uint64_t seed) {
+            rng::Xoshiro g (seed);
+            for (std::size_t j = 0; j < dim_; j++) shift_[j] = static_cast<uint32_t>(g.next() >> 32);
+            return seek(index_);
+        }
+
+        // Write the next point to x[0], x[stride], ...
+        void next(double *x, std::size_t stride = 1) {
+            if (index_ >> bits) throw std::runtime_error("Sobol sequence exhausted (2^32 points)");
+            for (std::size_t j = 0; j < dim_; j++) x[j * stride] = to_unit(x_[j]);
+            // Gray code: the following point differs by the direction of the lowest zero bit of index
+            const std::size_t c = std::countr_one(index_);
+            if (c < bits) {
+                const uint32_t *v = &v_[c * dim_];
+                for (std::size_t j = 0; j < dim_; j++) x_[j] ^= v[j];
+            }
+            index_++;
+        }
+
+        // Position the sequence at point n
+        Sobol& seek(uint64_t n) {
+            for (std::size_t j = 0; j < dim_; j++) x_[j] = coordinate(n, j);
+            index_ = n;
+            return *this;
+        }
+
+        Sobol& discard(uint64_t n) { return seek(index_ + n); }
+
+        // Point n (in Gray-code order), without moving the sequence
+        void point(uint64_t n, double *x, std::size_t stride = 1) const {
+            for (std::size_t j = 0; j < dim_; j++) x[j * stride] = to_unit(coordinate(n, j));
+        }
+
+        // The next n points, one per row
+        Matrix<double> points(int n) { return detail::take(*this, n); }
+
+    private:
+
+        std::size_t dim_;
+        uint64_t index_ = 0;
+        std::vector<uint32_t> v_;       // direction numbers, v_[k * dim + j]
+        std::vector<uint32_t> x_;       // integer coordinates of point index_
+        std::vector<uint32_t> shift_;
+
+        uint32_t coordinate(uint64_t n, std::size_t j) const {
+            uint64_t gray = n ^ (n >> 1);
+            uint32_t x = shift_[j];
+            for (std::size_t k = 0; gray; k++, gray >>= 1) {
+                if (gray & 1) x ^= v_[k * dim_ + j];
+            }
+            return x;
+        }
+
+        static double to_unit(uint32_t x) { return double(x) * 0x1.0p-32; }
+
+    };
+
+    /**
+     * @brief The Halton sequence in [0, 1)^d: coordinate j of point n is the radical inverse of n in the j-th prime
+     */
+    class Halton {
+
+    public:
+
+        explicit Halton(std::size_t dim) : bases_(detail::primes(dim)), offset_(dim + 1, 0) {
+            if (dim == 0) throw std::runtime_error("Halton sequences need at least one dimension");
+            for (std::size_t j = 0; j < dim; j++) offset_[j + 1] = offset_[j] + bases_[j];
+            perm_.resize(offset_[dim]);
+            for (std::size_t j = 0; j < dim; j++) {
+                std::iota(perm_.begin() + offset_[j], perm_.begin() + offset_[j + 1], 0u);
+            }
+        }
+
+        std::size_t dim() const { return bases_.size(); }
+        uint64_t index() const { return index_; }
+
+        /**
+         * @brief Replace the digits 1, ..., b - 1 of each base b by a random permutation of them
+         *
+         * Digit 0 is kept so that the radical inverses stay finite sums.
+         */
+        Halton& scramble(uint64_t seed) {
+            rng::Xoshiro g (seed);
+            for (std::size_t j = 0; j < dim(); j++) {
+                uint32_t *p = perm_.data() + offset_[j];
+                std::iota(p, p + bases_[j], 0u);
+                for (uint32_t i = bases_[j] - 1; i > 1; i--) std::swap(p[i], p[1 + detail::below(g, i)]);
+            }
+            return *this;
+        }
+
+        void next(double *x, std::size_t stride = 1) {
+            point(index_++, x, stride);
+        }
+
+        Halton& seek(uint64_t n) {
+            index_ = n;
+            return *this;
+        }
+
+        Halton& discard(uint64_t n) { return seek(index_ + n); }
+
+        void point(uint64_t n, double *x, std::size_t stride = 1) const {
+            for (std::size_t j = 0; j < dim(); j++) {
+                const uint32_t b = bases_[j];
+                const uint32_t *p = perm_.data() + offset_[j];
+                const double inv = 1.0 / b;
+                double f = inv, r = 0;
+                for (uint64_t k = n; k; k /= b, f *= inv) r += p[k % b] * f;
+                x[j * stride] = r;
+            }
+        }
+
+        Matrix<double> points(int n) { return detail::take(*this, n); }
+
+    private:
+
+        std::vector<uint32_t> bases_;
+        std::vector<std::size_t> offset_;   // digit permutation of base j in perm_[offset_[j], offset_[j + 1])
+        std::vector<uint32_t> perm_;
+        uint64_t index_ = 0;
+
+    };
+
+    /**
+     * @brief Latin hypercube design of n points in [0, 1)^d, one per row
+     *
+     * Every column has exactly one point in each of the n strata [i / n, (i + 1) / n),
+     * at a uniform position within it; the strata are matched across columns by
+     * independent random permutations.
+     */
+    template <class G>
+    Matrix<double> latin_hypercube(int n, std::size_t d, G& g) {
+        if (n <= 0 || d == 0) return Matrix<double>::null();
+        Matrix<double> out(n, d);
+        std::vector<uint32_t> perm (n);
+        for (std::size_t j = 0; j < d; j++) {
+            std::iota(perm.begin(), perm.end(), 0u);
+            for (std::size_t i = n - 1; i > 0; i--) std::swap(perm[i], perm[detail::below(g, i + 1)]);
+            double *col = out.data.get() + j * n;
+            for (int i = 0; i < n; i++) col[i] = (perm[i] + double(g.next() >> 11) * 0x1.0p-53) / n;
+        }
+        return out;
+    }
+
+    inline Matrix<double> latin_hypercube(int n, std::size_t d) {
+        return latin_hypercube(n, d, rng::engine());
+    }
+
+    };
+
+};
@@ -4,6 +4,7 @@
 #include "types.hpp"
 #include "Interval.hpp"
 #include "discrete.hpp"
+#include "views.hpp"
 
 namespace ejovo {
 
@@ -25,7 +26,7 @@ namespace ejovo {
         Matrix<X> interv = ejovo::discrete::midpoints(a, b, n); // equdistant intervals
         X dx = interv(2) - interv(1);
 
-        return dx * ejovo::sum(interv.map(fn));
+        return dx * (interv | views::map(fn) | views::sum());
     }
 
     template double ejovo::quad::midpoint(const double&, const double&, std::function<double(double)>, int);
@@ -43,7 +44,8 @@ namespace ejovo {
 
         X left = fn(interv(1));
         X right = fn(interv(n + 1));
-        X mid = interv(ejovo::seq(2, n)).map(fn).sum();
+        // interior points interv(2), ..., interv(n), evaluated in a single lazy pass
+        X mid = interv | views::drop(1) | views::take(n - 1) | views::map(fn) | views::sum();
 
         return (dx / 2) * (left + 2 * mid + right);
     }
@@ -6,14 +6,16 @@
 #include <climits>
 #include <cmath>
 #include <iostream>
+#include <vector>
 #include "types.hpp"
+#include "distributions.hpp"
 
 namespace ejovo {
 
     namespace rng {
 
 
-        class Xoshiro {
+        class Xoshiro : public Distributions<Xoshiro> {
 
         public:
             // std::unique_ptr<uint64_t [4]> state;
@@ -22,27 +24,16 @@ namespace ejovo {
             Xoshiro(); // initialize with random noise from the operating system
             // Xoshiro(std::initializer_list<uint64_t> list);
             Xoshiro(uint64_t, uint64_t, uint64_t, uint64_t);
+            explicit Xoshiro(uint64_t seed); // state expanded from a single seed by splitmix64
 
             inline Xoshiro& seed();
             // Xoshiro& seed(std::initializer_list<uint64_t> list);
             inline Xoshiro& seed(uint64_t, uint64_t, uint64_t, uint64_t);
+            inline Xoshiro& seed(uint64_t);
 
             inline uint64_t next();
-            inline double next_double();
-            inline int next_int();
-
-            inline int unif(int a, int b);
-            inline double unifd(double a, double e);
-            // double unif(); // Return X ~ U(0, 1)
-            inline double norm();
-            inline double norm(double mean, double sd);
-            inline double exp(double rate = 1);
-            inline double pareto(double xm, double alpha); // return a value from the pareto distribution with parameters xm and alpha
-            inline int binom(int size, double p = 0.5);
-            inline int hyper(int ndraws, int N, int K);
-            inline bool bernouilli(double p = 0.5); // return true or false
-            template <class T> inline std::size_t categorical(const Grid1D<T>& p); // return an integer i from 1 to k representing the category of the p(i)
-            std::size_t categorical(std::vector<double> p); // For now we will assume that the probabilites are not sorted.
+            inline Xoshiro& jump();      // advance by 2^128 draws
+            inline Xoshiro& long_jump(); // advance by 2^192 draws
 
             friend std::ostream& operator<<(std::ostream &out, Xoshiro& rhs) {
 
@@ -62,10 +53,22 @@ namespace ejovo {
             return (x << k) | (x >> (64 - k));
         }
 
+        // Expand a 64 bit seed into well mixed words, as recommended for seeding xoshiro
+        inline uint64_t splitmix64(uint64_t& x) {
+            uint64_t z = (x += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
         Xoshiro::Xoshiro() {
             this->seed();
         }
 
+        inline Xoshiro::Xoshiro(uint64_t s) {
+            this->seed(s);
+        }
+
         Xoshiro::Xoshiro(uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
             this->seed(a, b, c, d);
         }
@@ -83,6 +86,11 @@ namespace ejovo {
             return *this;
         }
 
+        inline Xoshiro& Xoshiro::seed(uint64_t s) {
+            for (auto& word : this->state) word = splitmix64(s);
+            return *this;
+        }
+
         inline uint64_t Xoshiro::next()
         {
             uint64_t *s = state;
@@ -100,133 +108,51 @@ namespace ejovo {
             return result;
         }
 
-        inline int Xoshiro::next_int() {
-        // interpret the first 32 bits of the 64 bits as an integer. - this returns a uniform X ~ [0, 2147483647]
-            int *iptr = nullptr;
-            uint64_t bits = this->next();
-            iptr = (int *) &bits;
-            return std::abs(iptr[1]);
-            // return iptr[1];
-        }
-
-        // get a double in the range [0, 1]
-        inline double Xoshiro::next_double() {
-            uint64_t val = this->next();
-            return (double) val / (double) ULONG_MAX; // This is how we "take the top 53 bits I think........."
-        }
-
-        inline int Xoshiro::unif(int a, int b) {
-        // return a random variable X ~ [a, b]
-            // int = get_int_xoshiro()
-            int spread = (b - a) + 1;
-            double x = this->next_double(); // returns a value in [0, 1)
-
-            return (int) std::floor(x * spread) + (a) ; // floor(x * spread) returns a vlue in [0, spread)
-        }
-
-        inline double Xoshiro::unifd(double a, double b) {
-
-            double spread = (b - a);
-
-            double x = this->next_double(); // returns a value in [0, 1)
-
-            return x * spread + a;
-        }
-
-        // double Xoshir
-
-        inline double Xoshiro::norm() {
-
-            double u1 = this->unifd(0, 1);
-            double u2 = this->unifd(0, 1);
-
-            double R = std::sqrt(-2 * std::log(u1));
-
-            return R * std::cos(2 * M_PI * u2);
-        }
-
-        // sample from X ~ N(mean, std^2)
-        inline double Xoshiro::norm(double mean, double std) {
-            return (norm() * std) + mean;
-        }
-
-        // sample once from the exponential distribution
-        inline double Xoshiro::exp(double rate) {
-
-            double y = this->unifd(0, 1);
-
-            return (-1.0 / rate) * std::log(1 - y);
-        }
-
-        // erturn a single single sample from the Pareto distribution with parameters xm and alpha
-        // via the inverse transform method
-        inline double Xoshiro::pareto(double xm, double alpha) {
-
-            double u = this->unifd(0, 1);
-
-            return (xm / std::pow(u, 1.0 / alpha));
-
-        }
-
-        // a single trial of a binomial experiment
-        inline int Xoshiro::binom(int size, double p) {
-            int count = 0;
-            for (int i = 0; i < size; i++) {
-                if (this->next_double() <= p) count++;
-            }
-            return count;
-        }
-
-            // int hyper(int ndraws, int N, int K);
-        // n draws, return the number of successes with population N and successful elements K
-        inline int Xoshiro::hyper(int ndraws, int N, int K) {
-            // std::cout << "Calculating hyper with ndraws: " << ndraws << ", N: " << N << ", K: " << K << "\n";
-            int count = 0;
-            double p = 0;
-            for (int i = 0; i < ndraws; i++) {
-
-                p = (double) K / N;
-
-                // std::cout << "calculated p: " << p << " == " << K << "/" << N << std::endl;
-
-                if (this->next_double() < p) {
-                    // std::cout << "Success, decrementing K\n";
-                    count ++;
-                    K --; // don't replace the element if we have a success
-                } else {
-                    // std::cout << "Failure, decrememnting N\n";
+        // Replace the state of g by its image under the polynomial `poly` of the transition
+        // matrix, which is how the jumps are expressed (Blackman & Vigna's reference code)
+        inline Xoshiro& jump_by(Xoshiro& g, const uint64_t (&poly)[4]) {
+            uint64_t s[4] = {0, 0, 0, 0};
+            for (uint64_t word : poly) {
+                for (int b = 0; b < 64; b++) {
+                    if (word & (uint64_t(1) << b)) {
+                        for (int i = 0; i < 4; i++) s[i] ^= g.state[i];
+                    }
+                    g.next();
                 }
-                N --; // Reduce the number of total elements, no matter which ball is pulled
             }
-            return count;
+            return g.seed(s[0], s[1], s[2], s[3]);
         }
 
-        inline bool Xoshiro::bernouilli(double p) {
-            return unifd(0, 1) <= p;
+        inline Xoshiro& Xoshiro::jump() {
+            static constexpr uint64_t JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+            return jump_by(*this, JUMP);
         }
 
-        // return a number between 1 and p.size()
-        template <class T>
-        inline std::size_t Xoshiro::categorical(const Grid1D<T>& p) {
-
-            // iterate along the elements of the matrix (hopefully sorted...)
-            // and return the integer of the corresponding division that it falls in
-            // | p1 |   p2   |p3|     p4     |, where all the probabilites are ASSUMED
-            // to add up to one.
-            double x = unifd(0, 1);
-            double acc = 0;
-
-            for (std::size_t i = 1; i <= p.size(); i++) {
-                acc += p(i);
-                if (x < acc) return i;
-            }
-
-            return 0u;
+        inline Xoshiro& Xoshiro::long_jump() {
+            static constexpr uint64_t LONG_JUMP[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+            return jump_by(*this, LONG_JUMP);
         }
 
+        /**
+         * @brief n non-overlapping generators for parallel sampling
+         *
+         * Stream i is `master` advanced by i jumps, so each one owns 2^128 draws.
+         * The master itself then long-jumps past all of them (2^192 draws), and
+         * the next call hands out fresh streams: a sequence of parallel calls is
+         * reproducible from the master's seed and the stream counts alone.
+         */
+        inline std::vector<Xoshiro> split(Xoshiro& master, std::size_t n) {
+            std::vector<Xoshiro> out (n, master);
+            for (std::size_t i = 1; i < n; i++) out[i] = Xoshiro(out[i - 1]).jump();
+            master.long_jump();
+            return out;
+        }
 
-        // create a global Xoshiro
-        Xoshiro g_XOSHIRO{};
+        // n non-overlapping generators derived from a single seed
+        inline std::vector<Xoshiro> streams(uint64_t seed, std::size_t n) {
+            Xoshiro master (seed);
+            return split(master, n);
+        }
 
     };
 
@@ -0,0 +1,161 @@
+/**========================================================================
+ * ?                          alias.hpp
+ * @brief   : Walker's alias method for categorical sampling in O(1)
+ * @details : Vose's construction ("A linear algorithm for generating random
+ *            numbers with a given distribution", IEEE TSE 17, 1991) splits k
+ *            weights into k columns of equal height, each holding at most two
+ *            outcomes: column j keeps its own outcome with probability prob_j
+ *            and otherwise yields its alias. Building is O(k); a draw is one
+ *            64-bit word and one table read, whatever k.
+ *
+ *            Outcomes of zero weight get no column, so a table over a sparse
+ *            row of a transition matrix only costs its nonzeros. Negative
+ *            weights within roundoff of the total, as computed rows (expm)
+ *            leave them, count as zero. Outcomes are 1-based, as in
+ *            Distributions::categorical.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "types.hpp"
+
+namespace ejovo {
+
+    namespace rng {
+
+        struct AliasSlot {
+            double prob;        // keep `self` when the fractional part is below prob
+            uint32_t self;      // 1-based outcome of the column
+            uint32_t alias;     // 1-based outcome otherwise
+        };
+
+    namespace detail {
+
+        /**
+         * @brief Alias table of the k weights w[0], w[stride], ... into out
+         *
+         * Returns the number of columns written (the number of positive weights).
+         * `out` must hold k slots.
+         */
+        inline std::size_t build_alias(const double *w, std::size_t k, std::size_t stride, AliasSlot *out) {
+
+            double total = 0, lowest = 0;
+            std::size_t nnz = 0;
+            for (std::size_t i = 0; i < k; i++) {
+                const double x = w[i * stride];
+                if (!std::isfinite(x)) throw std::runtime_error("Categorical weights must be finite and nonnegative");
+                if (x > 0) {
+                    total += x;
+                    nnz++;
+                }
+                lowest = std::min(lowest, x);
+            }
+            if (nnz == 0) throw std::runtime_error("Categorical weights must not all be zero");
+            // negatives within roundoff of the total (rows of expm, say) count as 0
+            if (lowest < -64 * double(k) * std::numeric_limits<double>::epsilon() * total) {
+                throw std::runtime_error("Categorical weights must be finite and nonnegative");
+            }
+
+            // scaled weights, average 1
+            std::vector<double> p (nnz);
+            std::vector<uint32_t> small, large;
+            small.reserve(nnz);
+            large.reserve(nnz);
+            for (std::size_t i = 0, c = 0; i < k; i++) {
+                const double x = w[i * stride];
+                if (x <= 0) continue;
+                out[c].self = static_cast<uint32_t>(i + 1);
+                p[c] = x * double(nnz) / total;
+                (p[c] < 1 ? small : large).push_back(static_cast<uint32_t>(c));
+                c++;
+            }
+
+            while (!small.empty() && !large.empty()) {
+                const uint32_t s = small.back(), l = large.back();
+                small.pop_back();
+                large.pop_back();
+                out[s].prob = p[s];
+                out[s].alias = out[l].self;
+                p[l] = (p[l] + p[s]) - 1;
+                (p[l] < 1 ? small : large).push_back(l);
+            }
+            // what is left is 1 up to roundoff
+            for (uint32_t c : small) out[c] = {1.0, out[c].self, out[c].self};
+            for (uint32_t c : large) out[c] = {1.0, out[c].self, out[c].self};
+
+            return nnz;
+        }
+
+        // Outcome of the table `slots` of k columns for the 64-bit word `bits`
+        inline uint32_t alias_sample(const AliasSlot *slots, std::size_t k, uint64_t bits) {
+            const double u = double(bits >> 11) * 0x1.0p-53 * double(k);
+            const std::size_t j = std::min(static_cast<std::size_t>(u), k - 1);
+            const AliasSlot& s = slots[j];
+            return (u - double(j) < s.prob) ? s.self : s.alias;
+        }
+
+    };
+
+    /**
+     * @brief Categorical distribution over 1, ..., k with weights proportional to w
+     *
+     * @code
+     * rng::AliasTable table (ejovo::vec({0.7, 0.2, 0.1}));
+     * std::size_t x = table(rng::engine());   // 1, 2 or 3
+     * @endcode
+     */
+    class AliasTable {
+
+    public:
+
+        AliasTable() = default;
+
+        AliasTable(const double *w, std::size_t k, std::size_t stride = 1) : slots_(k) {
+            slots_.resize(detail::build_alias(w, k, stride, slots_.data()));
+            slots_.shrink_to_fit();
+            k_ = k;
+        }
+
+        explicit AliasTable(const std::vector<double>& w) : AliasTable(w.data(), w.size()) {}
+
+        template <class T>
+        explicit AliasTable(const Grid1D<T>& w) : AliasTable(to_vector(w)) {}
+
+        // Number of outcomes, including those of zero weight
+        std::size_t size() const { return k_; }
+
+        template <class G>
+        std::size_t operator()(G& g) const {
+            return detail::alias_sample(slots_.data(), slots_.size(), g.next());
+        }
+
+        template <class G>
+        void fill(G& g, int *out, std::size_t n) const {
+            for (std::size_t i = 0; i < n; i++) out[i] = static_cast<int>((*this)(g));
+        }
+
+    private:
+
+        std::vector<AliasSlot> slots_;
+        std::size_t k_ = 0;
+
+        template <class T>
+        static std::vector<double> to_vector(const Grid1D<T>& w) {
+            std::vector<double> out (w.size());
+            for (std::size_t i = 0; i < w.size(); i++) out[i] = static_cast<double>(w(i + 1));
+            return out;
+        }
+
+    };
+
+    };
+
+};
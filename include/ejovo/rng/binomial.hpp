@@ -0,0 +1,237 @@
+/**========================================================================
+ * ?                          binomial.hpp
+ * @brief   : Exact binomial and hypergeometric samplers in O(1) expected time
+ * @details : Binomial: BTPE (Kachitvichyanukul & Schmeiser, "Binomial random
+ *            variate generation", CACM 31, 1988), an acceptance-rejection
+ *            scheme over a triangle, two parallelograms and two exponential
+ *            tails; used when n min(p, 1 - p) > 30. Below that, inversion by
+ *            sequential search costs O(n p) = O(1).
+ *
+ *            Hypergeometric: HRUA* (Stadlober, "The ratio of uniforms approach
+ *            for generating discrete random variates", J. Comput. Appl. Math.
+ *            31, 1990), ratio of uniforms with a log-gamma squeeze, for samples
+ *            of more than 10 draws; otherwise the HYP sequential method.
+ *
+ *            Both follow the reference implementations also used by NumPy and
+ *            are exact: only the acceptance tests use approximations, which are
+ *            bounds, never the returned distribution. G is any engine with
+ *            next_double().
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+namespace ejovo {
+
+    namespace rng {
+
+    namespace detail {
+
+        // X ~ B(n, p) by sequential search of the CDF, p <= 1/2 and n p small
+        template <class G>
+        int64_t binomial_inversion(G& g, int64_t n, double p) {
+            const double q = 1 - p;
+            const double qn = std::exp(n * std::log(q));
+            const double np = n * p;
+            const double bound = std::min(double(n), np + 10.0 * std::sqrt(np * q + 1));
+
+            int64_t x = 0;
+            double px = qn;
+            double u = g.next_double();
+            while (u > px) {
+                x++;
+                if (x > bound) {
+                    // lost in the far tail through roundoff: start over
+                    x = 0;
+                    px = qn;
+                    u = g.next_double();
+                } else {
+                    u -= px;
+                    px = ((n - x + 1) * p * px) / (x * q);
+                }
+            }
+            return x;
+        }
+
+        // Stirling series of log Gamma(x) - ((x - 1/2) log x - x + log(2 pi) / 2), x large
+        inline double stirling_tail(double x) {
+            const double x2 = x * x;
+            return (13860. - (462. - (132. - (99. - 140. / x2) / x2) / x2) / x2) / x / 166320.;
+        }
+
+        // X ~ B(n, p) by BTPE, p <= 1/2 and n p > 30
+        template <class G>
+        int64_t binomial_btpe(G& g, int64_t n, double p) {
+
+            const double r = p, q = 1 - p;
+            const double fm = n * r + r;
+            const int64_t m = static_cast<int64_t>(std::floor(fm));
+            const double p1 = std::floor(2.195 * std::sqrt(n * r * q) - 4.6 * q) + 0.5;
+            const double xm = m + 0.5, xl = xm - p1, xr = xm + p1;
+            const double c = 0.134 + 20.5 / (15.3 + m);
+            double a = (fm - xl) / (fm - xl * r);
+            const double laml = a * (1 + a / 2);
+            a = (xr - fm) / (xr * q);
+            const double lamr = a * (1 + a / 2);
+            const double p2 = p1 * (1 + 2 * c), p3 = p2 + c / laml, p4 = p3 + c / lamr;
+            const double nrq = n * r * q;
+
+            for (;;) {
+
+                const double u = g.next_double() * p4;
+                double v = g.next_double();
+                int64_t y;
+
+                if (u <= p1) {
+                    // triangular region: always accepted
+                    return static_cast<int64_t>(std::floor(xm - p1 * v + u));
+                } else if (u <= p2) {
+                    // parallelograms
+                    const double x = xl + (u - p1) / c;
+                    v = v * c + 1 - std::abs(m - x + 0.5) / p1;
+                    if (v > 1) continue;
+                    y = static_cast<int64_t>(std::floor(x));
+                } else if (u <= p3) {
+                    // left exponential tail
+                    if (v == 0) continue;
+                    y = static_cast<int64_t>(std::floor(xl + std::log(v) / laml));
+                    if (y < 0) continue;
+                    v = v * (u - p2) * laml;
+                } else {
+                    // right exponential tail
+                    if (v == 0) continue;
+                    y = static_cast<int64_t>(std::floor(xr - std::log(v) / lamr));
+                    if (y > n) continue;
+                    v = v * (u - p3) * lamr;
+                }
+
+                const int64_t k = std::abs(y - m);
+
+                if (k <= 20 || k >= nrq / 2 - 1) {
+                    // explicit evaluation of f(y) / f(m) by recursion
+                    const double s = r / q, as = s * (n + 1);
+                    double F = 1;
+                    if (m < y) {
+                        for (int64_t i = m + 1; i <= y; i++) F *= (as / i - s);
+                    } else if (m > y) {
+                        for (int64_t i = y + 1; i <= m; i++) F /= (as / i - s);
+                    }
+                    if (v <= F) return y;
+                    continue;
+                }
+
+                // squeeze on log f(y) / f(m), then the Stirling-corrected bound
+                const double rho = (k / nrq) * ((k * (k / 3.0 + 0.625) + 0.16666666666666666) / nrq + 0.5);
+                const double t = -double(k) * k / (2 * nrq);
+                const double A = std::log(v);
+                if (A < t - rho) return y;
+                if (A > t + rho) continue;
+
+                const double x1 = y + 1, f1 = m + 1, z = n + 1 - m, w = n - y + 1;
+                const double bound = xm * std::log(f1 / x1) + (n - m + 0.5) * std::log(z / w)
+                                   + (y - m) * std::log(w * r / (x1 * q))
+                                   + stirling_tail(f1) + stirling_tail(z) + stirling_tail(x1) + stirling_tail(w);
+                if (A <= bound) return y;
+            }
+        }
+
+        // Successes among `sample` draws without replacement from good + bad items, sample <= 10
+        template <class G>
+        int64_t hypergeometric_hyp(G& g, int64_t good, int64_t bad, int64_t sample) {
+            const int64_t d1 = bad + good - sample;
+            const double d2 = double(std::min(bad, good));
+
+            double y = d2;
+            int64_t k = sample;
+            while (y > 0) {
+                const double u = g.next_double();
+                y -= static_cast<int64_t>(std::floor(u + y / (d1 + k)));
+                k--;
+                if (k == 0) break;
+            }
+            int64_t z = static_cast<int64_t>(d2 - y);
+            if (good > bad) z = sample - z;
+            return z;
+        }
+
+        // Same, by HRUA*, for larger samples
+        template <class G>
+        int64_t hypergeometric_hrua(G& g, int64_t good, int64_t bad, int64_t sample) {
+
+            constexpr double D1 = 1.7155277699214135;   // 2 sqrt(2 / e)
+            constexpr double D2 = 0.8989161620588988;   // 3 - 2 sqrt(3 / e)
+
+            const int64_t mingoodbad = std::min(good, bad), maxgoodbad = std::max(good, bad);
+            const int64_t popsize = good + bad;
+            const int64_t m = std::min(sample, popsize - sample);
+
+            auto loggam = [] (double x) { return std::lgamma(x); };
+
+            const double d4 = double(mingoodbad) / popsize, d5 = 1 - d4;
+            const double d6 = m * d4 + 0.5;
+            const double d7 = std::sqrt(double(popsize - m) * sample * d4 * d5 / (popsize - 1) + 0.5);
+            const double d8 = D1 * d7 + D2;
+            const int64_t d9 = static_cast<int64_t>(std::floor(double(m + 1) * (mingoodbad + 1) / (popsize + 2)));
+            const double d10 = loggam(d9 + 1) + loggam(mingoodbad - d9 + 1) + loggam(m - d9 + 1)
+                             + loggam(maxgoodbad - m + d9 + 1);
+            // 16 standard deviations: the mass beyond is below double precision
+            const double d11 = std::min(std::min(m, mingoodbad) + 1.0, std::floor(d6 + 16 * d7));
+
+            int64_t z;
+            for (;;) {
+                const double x = g.next_double(), y = g.next_double();
+                const double w = d6 + d8 * (y - 0.5) / x;
+
+                if (w < 0 || w >= d11) continue;
+
+                z = static_cast<int64_t>(std::floor(w));
+                const double t = d10 - (loggam(z + 1) + loggam(mingoodbad - z + 1) + loggam(m - z + 1)
+                                      + loggam(maxgoodbad - m + z + 1));
+
+                if (x * (4 - x) - 3 <= t) break;     // fast acceptance
+                if (x * (x - t) >= 1) continue;       // fast rejection
+                if (2 * std::log(x) <= t) break;
+            }
+
+            // map back from the symmetric reductions (Frohne's corrections)
+            if (good > bad) z = m - z;
+            if (m < sample) z = good - z;
+            return z;
+        }
+
+    };
+
+    /**
+     * @brief X ~ B(n, p)
+     */
+    template <class G>
+    int64_t binomial(G& g, int64_t n, double p) {
+        if (n <= 0 || p <= 0) return 0;
+        if (p >= 1) return n;
+        if (p <= 0.5) {
+            return (n * p <= 30) ? detail::binomial_inversion(g, n, p) : detail::binomial_btpe(g, n, p);
+        }
+        const double q = 1 - p;
+        return n - ((n * q <= 30) ? detail::binomial_inversion(g, n, q) : detail::binomial_btpe(g, n, q));
+    }
+
+    /**
+     * @brief Number of successes in `ndraws` draws without replacement from N items, K of which are successes
+     */
+    template <class G>
+    int64_t hypergeometric(G& g, int64_t ndraws, int64_t N, int64_t K) {
+        if (ndraws <= 0 || K <= 0) return 0;
+        if (K >= N) return ndraws;
+        if (ndraws >= N) return K;
+        const int64_t bad = N - K;
+        return (ndraws > 10) ? detail::hypergeometric_hrua(g, K, bad, ndraws)
+                             : detail::hypergeometric_hyp(g, K, bad, ndraws);
+    }
+
+    };
+
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include "types.hpp"
+#include "ziggurat.hpp"
+#include "binomial.hpp"
+#include "gamma.hpp"
+#include "poisson.hpp"
+
+namespace ejovo {
+
+    namespace rng {
+
+        /**
+         * @brief Sampling methods shared by every engine (CRTP)
+         *
+         * An engine G derives from Distributions<G> and provides `uint64_t next()`,
+         * 64 uniformly distributed bits; every distribution is expressed through it,
+         * so rng::Xoshiro and rng::Philox sample in exactly the same way.
+         */
+        template <class G>
+        class Distributions {
+
+        public:
+
+            inline double next_double();
+            inline int next_int();
+
+            inline int unif(int a, int b);
+            inline double unifd(double a, double e);
+            inline double norm();
+            inline double norm(double mean, double sd);
+            inline double exp(double rate = 1);
+            inline double pareto(double xm, double alpha); // return a value from the pareto distribution with parameters xm and alpha
+            inline int binom(int size, double p = 0.5);
+            inline int hyper(int ndraws, int N, int K);
+            inline double gamma(double shape, double scale = 1);
+            inline double beta(double a, double b);
+            inline int poisson(double lambda);
+            inline void dirichlet(const double *alpha, std::size_t k, double *out); // k components summing to 1
+            inline bool bernouilli(double p = 0.5); // return true or false
+            template <class T> inline std::size_t categorical(const Grid1D<T>& p); // return an integer i from 1 to k representing the category of the p(i)
+
+        private:
+
+            G& engine() { return static_cast<G&>(*this); }
+
+        };
+
+        template <class G>
+        inline int Distributions<G>::next_int() {
+        // interpret the high 32 bits of the 64 bits as an integer. - this returns a uniform X ~ [0, 2147483647]
+            const uint64_t bits = engine().next();
+            return std::abs(static_cast<int>(static_cast<uint32_t>(bits >> 32)));
+        }
+
+        // get a double in the range [0, 1]
+        template <class G>
+        inline double Distributions<G>::next_double() {
+            uint64_t val = engine().next();
+            return (double) val / (double) ULONG_MAX; // This is how we "take the top 53 bits I think........."
+        }
+
+        template <class G>
+        inline int Distributions<G>::unif(int a, int b) {
+        // return a random variable X ~ [a, b]
+            int spread = (b - a) + 1;
+            double x = this->next_double(); // returns a value in [0, 1)
+
+            return (int) std::floor(x * spread) + (a) ; // floor(x * spread) returns a vlue in [0, spread)
+        }
+
+        template <class G>
+        inline double Distributions<G>::unifd(double a, double b) {
+
+            double spread = (b - a);
+
+            double x = this->next_double(); // returns a value in [0, 1)
+
+            return x * spread + a;
+        }
+
+        // Ziggurat: one 64-bit draw and no transcendental call for ~99% of the samples
+        template <class G>
+        inline double Distributions<G>::norm() {
+            return ziggurat_normal(engine());
+        }
+
+        // sample from X ~ N(mean, std^2)
+        template <class G>
+        inline double Distributions<G>::norm(double mean, double std) {
+            return (norm() * std) + mean;
+        }
+
+        // sample once from the exponential distribution, by the ziggurat
+        template <class G>
+        inline double Distributions<G>::exp(double rate) {
+            return ziggurat_exp(engine()) / rate;
+        }
+
+        // return a single single sample from the Pareto distribution with parameters xm and alpha
+        // via the inverse transform method
+        template <class G>
+        inline double Distributions<G>::pareto(double xm, double alpha) {
+
+            double u = this->unifd(0, 1);
+
+            return (xm / std::pow(u, 1.0 / alpha));
+
+        }
+
+        // a single trial of a binomial experiment, in O(1) expected time (BTPE)
+        template <class G>
+        inline int Distributions<G>::binom(int size, double p) {
+            return static_cast<int>(binomial(engine(), size, p));
+        }
+
+        // n draws, return the number of successes with population N and successful elements K (HRUA*)
+        template <class G>
+        inline int Distributions<G>::hyper(int ndraws, int N, int K) {
+            return static_cast<int>(hypergeometric(engine(), ndraws, N, K));
+        }
+
+        // Marsaglia-Tsang, boosted for shape < 1
+        template <class G>
+        inline double Distributions<G>::gamma(double shape, double scale) {
+            return rng::gamma(engine(), shape, scale);
+        }
+
+        template <class G>
+        inline double Distributions<G>::beta(double a, double b) {
+            return rng::beta(engine(), a, b);
+        }
+
+        // PTRS for lambda >= 10, in O(1) expected time
+        template <class G>
+        inline int Distributions<G>::poisson(double lambda) {
+            return static_cast<int>(rng::poisson(engine(), lambda));
+        }
+
+        template <class G>
+        inline void Distributions<G>::dirichlet(const double *alpha, std::size_t k, double *out) {
+            rng::dirichlet(engine(), alpha, k, out);
+        }
+
+        template <class G>
+        inline bool Distributions<G>::bernouilli(double p) {
+            return unifd(0, 1) <= p;
+        }
+
+        // return a number between 1 and p.size()
+        template <class G>
+        template <class T>
+        inline std::size_t Distributions<G>::categorical(const Grid1D<T>& p) {
+
+            // iterate along the elements of the matrix (hopefully sorted...)
+            // and return the integer of the corresponding division that it falls in
+            // | p1 |   p2   |p3|     p4     |, where all the probabilites are ASSUMED
+            // to add up to one.
+            double x = unifd(0, 1);
+            double acc = 0;
+
+            for (std::size_t i = 1; i <= p.size(); i++) {
+                acc += p(i);
+                if (x < acc) return i;
+            }
+
+            return 0u;
+        }
+
+    };
+
+};
@@ -0,0 +1,158 @@
+/**========================================================================
+ * ?                          engine.hpp
+ * @brief   : Thread-local default generators
+ * @details : Every thread owns its default engines (a scalar rng::Xoshiro and
+ *            a bulk rng::XoshiroSimd), so the r* functions and Matrix::rand
+ *            never share mutable state: no data race and no cache line bouncing.
+ *
+ *            The engines of a thread are derived from the global seed and the
+ *            thread's stream number, fixed at its first draw: 0 for the main
+ *            thread, the OpenMP thread number t > 0 for a worker of a top-level
+ *            team, and 2^32 + k for the k-th other thread to draw. A team number
+ *            is held by one live thread at a time: the master of a team opened by
+ *            another std::thread, workers of nested teams, and a worker whose
+ *            number is already held all take a 2^32 + k stream, so no two threads
+ *            ever share one. (OpenMP cannot tell a worker which thread forked its
+ *            team; the main team's layout is reproducible when it draws before
+ *            any other team.) set_seed() changes the global seed; each thread
+ *            reseeds lazily on its next draw, keeping its stream number, so a run
+ *            is reproducible given the seed and the thread layout. Until then the
+ *            seed comes from the operating system, as before.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <cstdint>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "Xoshiro.hpp"
+#include "xoshiro_simd.hpp"
+
+namespace ejovo {
+
+    namespace rng {
+
+    namespace detail {
+
+        // splitmix64's output function: a bijective avalanche of 64 bits
+        inline uint64_t mix64(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+        struct SeedState {
+            std::atomic<uint64_t> seed {Xoshiro().next()};
+            std::atomic<uint64_t> generation {1};   // bumped by every set_seed
+            std::atomic<uint64_t> others {0};       // threads that are neither main nor OpenMP workers
+
+            // holder of the team stream t, a default id while it is free
+            std::mutex claims_mutex;
+            std::vector<std::thread::id> claims;
+
+            // Take the team stream t for the calling thread, unless another live thread holds it
+            bool claim(std::size_t t) {
+                const std::lock_guard<std::mutex> lock (claims_mutex);
+                if (claims.size() <= t) claims.resize(t + 1);
+                const auto me = std::this_thread::get_id();
+                if (claims[t] != std::thread::id() && claims[t] != me) return false;
+                claims[t] = me;
+                return true;
+            }
+
+            void release(std::size_t t) {
+                const std::lock_guard<std::mutex> lock (claims_mutex);
+                if (t < claims.size() && claims[t] == std::this_thread::get_id()) claims[t] = std::thread::id();
+            }
+        };
+
+        inline SeedState g_SEED;
+
+        // Dynamic initialization of namespace-scope variables runs on the main thread
+        inline const std::thread::id main_thread = std::this_thread::get_id();
+
+        // Seed of the engine `kind` (0 scalar, 1 bulk) of a stream
+        inline uint64_t stream_seed(uint64_t seed, uint64_t stream, uint64_t kind) {
+            return mix64(seed + mix64(2 * stream + kind + 1));
+        }
+
+        struct ThreadEngines {
+
+            uint64_t generation = 0;
+            uint64_t stream = stream_number();
+            Xoshiro scalar {0};
+            XoshiroSimd<> bulk {0};
+
+            ThreadEngines() = default;
+            ThreadEngines(const ThreadEngines&) = delete;
+            ThreadEngines& operator=(const ThreadEngines&) = delete;
+
+            // An exiting thread gives its team number back
+            ~ThreadEngines() {
+                if (stream > 0 && stream < (uint64_t(1) << 32)) g_SEED.release(static_cast<std::size_t>(stream));
+            }
+
+            // Only the seed changes with the generation, never the stream
+            void refresh() {
+                const uint64_t g = g_SEED.generation.load(std::memory_order_acquire);
+                if (g == generation) return;
+                const uint64_t seed = g_SEED.seed.load(std::memory_order_relaxed);
+                scalar.seed(stream_seed(seed, stream, 0));
+                bulk.seed(stream_seed(seed, stream, 1));
+                generation = g;
+            }
+
+            static uint64_t stream_number() {
+                if (std::this_thread::get_id() == main_thread) return 0;
+            #ifdef _OPENMP
+                // thread 0 of a team is its forking thread, which is not main here
+                if (omp_in_parallel() && omp_get_level() == 1) {
+                    const int t = omp_get_thread_num();
+                    if (t > 0 && g_SEED.claim(static_cast<std::size_t>(t))) return static_cast<uint64_t>(t);
+                }
+            #endif
+                return (uint64_t(1) << 32) + g_SEED.others.fetch_add(1, std::memory_order_relaxed);
+            }
+
+        };
+
+        inline ThreadEngines& thread_engines() {
+            thread_local ThreadEngines engines;
+            engines.refresh();
+            return engines;
+        }
+
+    };
+
+    // The calling thread's scalar default engine
+    inline Xoshiro& engine() {
+        return detail::thread_engines().scalar;
+    }
+
+    // The calling thread's bulk default engine, behind runif, rnorm and rexp
+    inline XoshiroSimd<>& simd_engine() {
+        return detail::thread_engines().bulk;
+    }
+
+    // Reseed the default engines of every thread: the caller's at once, the others on their next draw
+    inline void seed_all(uint64_t seed) {
+        detail::g_SEED.seed.store(seed, std::memory_order_relaxed);
+        detail::g_SEED.generation.fetch_add(1, std::memory_order_release);
+        detail::thread_engines();
+    }
+
+    // Former global engine, now bound to the calling thread's default engine.
+    // Prefer rng::engine(), which also picks up a set_seed made by another thread.
+    inline thread_local Xoshiro& g_XOSHIRO = engine();
+
+    };
+
+};
@@ -0,0 +1,251 @@
+/**========================================================================
+ * ?                          gamma.hpp
+ * @brief   : Gamma, Beta and Dirichlet samplers
+ * @details : Gamma: Marsaglia & Tsang ("A simple method for generating gamma
+ *            variables", ACM TOMS 26, 2000). For shape >= 1, X = d (1 + c Z)^3
+ *            with Z normal is accepted with probability above 95%, mostly by a
+ *            polynomial squeeze that needs no logarithm. Shape < 1 is boosted:
+ *            Gamma(a) = Gamma(a + 1) U^(1/a).
+ *
+ *            Beta: X / (X + Y) with X ~ Gamma(a) and Y ~ Gamma(b), except when
+ *            both parameters are at most 1, where Johnk's method is used so that
+ *            no 0 / 0 arises from underflowing gammas.
+ *
+ *            Dirichlet: normalized independent gammas, or stick-breaking by Beta
+ *            variates when every parameter is below 0.1 (the gammas would then
+ *            underflow to 0 with high probability).
+ *
+ *            The scalar samplers take any engine with next() and next_double().
+ *            The bulk fill_* ones take an engine with fill_norm and fill_uniform
+ *            (rng::XoshiroSimd): proposals are drawn in batches and the rejected
+ *            ones redrawn together, until every slot is accepted.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "ziggurat.hpp"
+
+namespace ejovo {
+
+    namespace rng {
+
+    namespace detail {
+
+        // Marsaglia & Tsang's acceptance test of the proposal x (a standard normal) for u uniform
+        inline bool gamma_accept(double x, double u, double d, double c, double& out) {
+            const double t = 1 + c * x;
+            if (t <= 0) return false;
+            const double v = t * t * t;
+            const double x2 = x * x;
+            if (u < 1 - 0.0331 * x2 * x2 || std::log(u) < 0.5 * x2 + d * (1 - v + std::log(v))) {
+                out = d * v;
+                return true;
+            }
+            return false;
+        }
+
+        // Johnk's Beta(a, b), a, b <= 1: accept (U^(1/a), V^(1/b)) under the diagonal
+        inline bool johnk_accept(double u, double v, double a, double b, double& out) {
+            if (u == 0 && v == 0) return false;
+            const double x = std::pow(u, 1 / a), y = std::pow(v, 1 / b);
+            const double s = x + y;
+            if (s > 1) return false;
+            if (s > 0) {
+                out = x / s;
+            } else {
+                // both underflowed: redo the ratio in log space
+                double lx = std::log(u) / a, ly = std::log(v) / b;
+                const double lm = std::max(lx, ly);
+                lx -= lm;
+                ly -= lm;
+                out = std::exp(lx - std::log(std::exp(lx) + std::exp(ly)));
+            }
+            return true;
+        }
+
+        /**
+         * @brief Fill out[0, n) by batched rejection
+         *
+         * propose(p, q, k) draws k pairs of proposals into p and q. squeeze(p, q, x) is a
+         * cheap, branch-free test run over whole batches: it writes x either way and
+         * returns whether the pair is accepted. accept(p, q, x) is the exact test, run
+         * only on what the squeeze left; it writes x when it returns true.
+         */
+        template <class Propose, class Squeeze, class Accept>
+        void fill_accepted(double *out, std::size_t n, Propose&& propose, Squeeze&& squeeze, Accept&& accept) {
+            constexpr std::size_t batch = 512;
+            double p[batch], q[batch];
+            std::size_t pending[batch];
+            for (std::size_t i0 = 0; i0 < n; i0 += batch) {
+                std::size_t k = std::min(batch, n - i0);
+                double *o = out + i0;
+
+                propose(p, q, k);
+                std::size_t left = 0;
+                for (std::size_t i = 0; i < k; i++) {
+                    pending[left] = i;
+                    left += !squeeze(p[i], q[i], o[i]);
+                }
+                k = 0;
+                for (std::size_t j = 0; j < left; j++) {
+                    const std::size_t i = pending[j];
+                    if (!accept(p[i], q[i], o[i])) pending[k++] = i;
+                }
+
+                // redraw the rejected slots together
+                while (k > 0) {
+                    propose(p, q, k);
+                    left = 0;
+                    for (std::size_t j = 0; j < k; j++) {
+                        if (!accept(p[j], q[j], o[pending[j]])) pending[left++] = pending[j];
+                    }
+                    k = left;
+                }
+            }
+        }
+
+        inline void check_gamma(double shape, double scale) {
+            if (!(shape > 0) || !(scale > 0)) throw std::runtime_error("Gamma parameters must be positive");
+        }
+
+    };
+
+    /**
+     * @brief X ~ Gamma(shape, scale), of mean shape * scale
+     */
+    template <class G>
+    double gamma(G& g, double shape, double scale = 1) {
+        detail::check_gamma(shape, scale);
+        if (shape < 1) {
+            const double u = g.next_double();
+            return gamma(g, shape + 1, scale) * std::pow(u, 1 / shape);
+        }
+        const double d = shape - 1.0 / 3, c = 1 / std::sqrt(9 * d);
+        double x;
+        for (;;) {
+            const double z = ziggurat_normal(g);
+            if (detail::gamma_accept(z, g.next_double(), d, c, x)) return x * scale;
+        }
+    }
+
+    /**
+     * @brief X ~ Beta(a, b)
+     */
+    template <class G>
+    double beta(G& g, double a, double b) {
+        if (!(a > 0) || !(b > 0)) throw std::runtime_error("Beta parameters must be positive");
+        if (a <= 1 && b <= 1) {
+            double x;
+            for (;;) {
+                const double u = g.next_double(), v = g.next_double();
+                if (detail::johnk_accept(u, v, a, b, x)) return x;
+            }
+        }
+        const double x = gamma(g, a), y = gamma(g, b);
+        return x / (x + y);
+    }
+
+    /**
+     * @brief (X_1, ..., X_k) ~ Dirichlet(alpha), written to out[0], out[stride], ...
+     */
+    template <class G>
+    void dirichlet(G& g, const double *alpha, std::size_t k, double *out, std::size_t stride = 1) {
+        if (k == 0) return;
+        double amax = 0;
+        for (std::size_t i = 0; i < k; i++) {
+            if (!(alpha[i] > 0)) throw std::runtime_error("Dirichlet parameters must be positive");
+            amax = std::max(amax, alpha[i]);
+        }
+
+        if (amax < 0.1) {
+            // stick-breaking: X_i = (1 - X_1 - ... - X_{i-1}) Beta(alpha_i, alpha_{i+1} + ... + alpha_k)
+            double rest = 0;
+            for (std::size_t i = 0; i < k; i++) rest += alpha[i];
+            double left = 1;
+            for (std::size_t i = 0; i + 1 < k; i++) {
+                rest -= alpha[i];
+                const double x = left * beta(g, alpha[i], rest);
+                out[i * stride] = x;
+                left -= x;
+            }
+            out[(k - 1) * stride] = left;
+            return;
+        }
+
+        double sum = 0;
+        for (std::size_t i = 0; i < k; i++) sum += (out[i * stride] = gamma(g, alpha[i]));
+        for (std::size_t i = 0; i < k; i++) out[i * stride] /= sum;
+    }
+
+    /**
+     * @brief n draws of Gamma(shape, scale) from a bulk engine
+     */
+    template <class B>
+    void fill_gamma(B& v, double *out, std::size_t n, double shape, double scale = 1) {
+        detail::check_gamma(shape, scale);
+        const double a = shape < 1 ? shape + 1 : shape;
+        const double d = a - 1.0 / 3, c = 1 / std::sqrt(9 * d);
+
+        detail::fill_accepted(out, n,
+            [&] (double *z, double *u, std::size_t k) {
+                v.fill_norm(z, k);
+                v.fill_uniform(u, k);
+            },
+            [&] (double z, double u, double& x) {
+                const double t = 1 + c * z, z2 = z * z;
+                x = d * t * t * t;
+                return t > 0 && u < 1 - 0.0331 * z2 * z2;
+            },
+            [&] (double z, double u, double& x) { return detail::gamma_accept(z, u, d, c, x); });
+
+        if (shape < 1) {
+            constexpr std::size_t batch = 512;
+            double u[batch];
+            for (std::size_t i0 = 0; i0 < n; i0 += batch) {
+                const std::size_t len = std::min(batch, n - i0);
+                v.fill_uniform(u, len);
+                for (std::size_t i = 0; i < len; i++) out[i0 + i] *= std::pow(u[i], 1 / shape);
+            }
+        }
+
+        if (scale != 1) {
+            for (std::size_t i = 0; i < n; i++) out[i] *= scale;
+        }
+    }
+
+    /**
+     * @brief n draws of Beta(a, b) from a bulk engine
+     */
+    template <class B>
+    void fill_beta(B& v, double *out, std::size_t n, double a, double b) {
+        if (!(a > 0) || !(b > 0)) throw std::runtime_error("Beta parameters must be positive");
+        if (a <= 1 && b <= 1) {
+            detail::fill_accepted(out, n,
+                [&] (double *u, double *w, std::size_t k) {
+                    v.fill_uniform(u, k);
+                    v.fill_uniform(w, k);
+                },
+                [&] (double u, double w, double& x) { return detail::johnk_accept(u, w, a, b, x); },
+                [&] (double u, double w, double& x) { return detail::johnk_accept(u, w, a, b, x); });
+            return;
+        }
+
+        constexpr std::size_t batch = 512;
+        double y[batch];
+        fill_gamma(v, out, n, a);
+        for (std::size_t i0 = 0; i0 < n; i0 += batch) {
+            const std::size_t len = std::min(batch, n - i0);
+            fill_gamma(v, y, len, b);
+            for (std::size_t i = 0; i < len; i++) out[i0 + i] /= out[i0 + i] + y[i];
+        }
+    }
+
+    };
+
+};
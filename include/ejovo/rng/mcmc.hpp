@@ -6,6 +6,9 @@
 // The first thing that I'd like to implement is a Markov chain.
 
 #include "types.hpp"
+#include "ejovo/rng/alias.hpp"
+#include "ejovo/linalg/eigen.hpp"
+#include "ejovo/linalg/expm.hpp"
 
 // I want to create a Markov chain object
 namespace ejovo {
@@ -34,7 +37,21 @@ public:
     Matrix<int> simulate(int n = 10, int X0 = 1);
     Matrix<double> pow(int k);
 
+    // pi <- pi T^k for a distribution pi of n values, stored as a row or a column vector.
+    // `work` is swapped with pi at every step; nothing is allocated when it already holds n values.
+    void propagate(mat& pi, mat& work, int k = 1) const;
+    void propagate(mat& pi, int k = 1) const;
+    // out = pi T on raw storage
+    void propagate(const double *pi, double *out) const;
+
+    // Row vector pi with pi T = pi and sum(pi) = 1
+    Matrix<double> stationary() const;
+    // Eigenvalues of T, by decreasing modulus
+    linalg::Eigen<double> eigenvalues() const;
+
     static MarkovChain gamblers();
+    // Chain observed every t time units of the continuous-time chain with generator Q, T = exp(Q t)
+    static MarkovChain continuous(const mat& Q, double t = 1.0);
 
 
 private:
@@ -42,6 +59,13 @@ private:
     mat T; // Transition matrix
     int n; // number of states
 
+    // Alias tables of the rows of T, built by the first simulation: row i has the
+    // columns alias[alias_start[i] .. alias_start[i + 1])
+    std::vector<rng::AliasSlot> alias;
+    std::vector<std::size_t> alias_start;
+
+    void build_alias();
+
 
 };
 
@@ -63,12 +87,16 @@ MarkovChain::MarkovChain(mat&& __T) {
 MarkovChain::MarkovChain(const MarkovChain& rhs)
     : T{rhs.T}
     , n{rhs.n}
+    , alias{rhs.alias}
+    , alias_start{rhs.alias_start}
     {}
 
 // Need to return rhs to a valid, default state
 MarkovChain::MarkovChain(MarkovChain&& rhs)
     : T{rhs.T}
     , n{rhs.n}
+    , alias{std::move(rhs.alias)}
+    , alias_start{std::move(rhs.alias_start)}
 {
     rhs.n = 0;
     rhs.T.nullify();
@@ -80,44 +108,105 @@ MarkovChain::MarkovChain(MarkovChain&& rhs)
 MarkovChain& MarkovChain::operator=(const MarkovChain& rhs) {
     this->T = rhs.T;
     this->n = rhs.n;
+    this->alias = rhs.alias;
+    this->alias_start = rhs.alias_start;
     return *this;
 }
 
 MarkovChain& MarkovChain::operator=(MarkovChain&& rhs) {
     this->T = rhs.T;
     this->n = rhs.n;
+    this->alias = std::move(rhs.alias);
+    this->alias_start = std::move(rhs.alias_start);
     return *this;
 }
 
 bool MarkovChain::is_valid_state(int X) { return X >= 1 && X <= n; }
 
+void MarkovChain::build_alias() {
+    // The rows of T are strided in column-major storage: copy them a panel at a time
+    constexpr int panel = 64;
+    std::vector<double> rows (static_cast<std::size_t>(panel) * n);
+    std::vector<rng::AliasSlot> slots (n);
+    alias.clear();
+    alias_start.assign(1, 0);
+    for (int i0 = 0; i0 < n; i0 += panel) {
+        const int r = std::min(panel, n - i0);
+        for (int j = 0; j < n; j++) {
+            const double *t = T.data.get() + i0 + static_cast<std::size_t>(j) * n;
+            for (int i = 0; i < r; i++) rows[static_cast<std::size_t>(i) * n + j] = t[i];
+        }
+        for (int i = 0; i < r; i++) {
+            const std::size_t k = rng::detail::build_alias(rows.data() + static_cast<std::size_t>(i) * n, n, 1, slots.data());
+            alias.insert(alias.end(), slots.begin(), slots.begin() + k);
+            alias_start.push_back(alias.size());
+        }
+    }
+    alias.shrink_to_fit();
+}
+
 Matrix<int> MarkovChain::simulate(int n, int x0) {
 
     // if x0 is not valid state, then bail
-    if (!is_valid_state(x0)) return Matrix<int>::null();
+    if (!is_valid_state(x0) || n <= 0) return Matrix<int>::null();
+
+    if (alias_start.empty()) build_alias();
 
-    // else let's simulate this bitch!
-    // for whatever state we are curerntly at, let's get the row of the matrix and get a category
+    // One 64-bit draw and one table read per step
     Matrix<int> out (1, n);
-    out(1) = x0;
+    int *x = out.data.get();
+    x[0] = x0;
+    const rng::AliasSlot *slots = alias.data();
+    const std::size_t *start = alias_start.data();
+    auto& g = rng::engine();
+
+    for (int i = 1; i < n; i++) {
+        const std::size_t s = x[i - 1] - 1;
+        x[i] = rng::detail::alias_sample(slots + start[s], start[s + 1] - start[s], g.next());
+    }
 
-    T.print();
+    return out;
+}
 
-    // To simulate this appropriately, I need a method to "get_row_views" from a matrix that returns
-    // a vector of views. Otherwise, I am just going to continually get the row of the current state.
-    for (int i = 2; i <= n; i++) {
-        const int& current_state = out(i - 1);
-        const auto& this_row = T.get_row(current_state); // the probability distribution of the current states row
-        out(i) = ejovo::rng::xoroshiro.categorical(this_row);
+void MarkovChain::propagate(const double *pi, double *out) const {
+    blas::gemv(blas::Op::T, n, n, 1.0, T.data.get(), n, pi, 0.0, out);
+}
+
+void MarkovChain::propagate(mat& pi, mat& work, int k) const {
+    if (pi.size() != static_cast<std::size_t>(n)) throw std::runtime_error("Distribution and transition matrix have incompatible sizes");
+    if (work.nrow() != pi.nrow() || work.ncol() != pi.ncol()) work = mat(pi.nrow(), pi.ncol());
+    for (int i = 0; i < k; i++) {
+        propagate(pi.data.get(), work.data.get());
+        pi.data.swap(work.data);
     }
+}
 
-    return out;
+void MarkovChain::propagate(mat& pi, int k) const {
+    mat work (pi.nrow(), pi.ncol());
+    propagate(pi, work, k);
 }
 
 Matrix<double> MarkovChain::pow(int k) {
     return T^k;
 }
 
+// The stationary distribution is the left eigenvector of T for the eigenvalue 1. It is
+// found by inverse iteration on T^T instead of reading a row of T^k for a large k. For a
+// reducible chain (several closed classes) this returns one of the stationary distributions.
+Matrix<double> MarkovChain::stationary() const {
+    auto pi = linalg::eigvec(T.t(), 1.0);
+    const double total = pi.sum();
+    return (pi / total).as_rowvec();
+}
+
+linalg::Eigen<double> MarkovChain::eigenvalues() const {
+    return linalg::eig(T);
+}
+
+MarkovChain MarkovChain::continuous(const mat& Q, double t) {
+    return MarkovChain(linalg::expm(Q * t));
+}
+
 MarkovChain MarkovChain::gamblers() {
     MarkovChain mc (Matrix<double>::from({1.0, 0.0, 0.0, 0.0, 0.0,
                                           0.6, 0.0, 0.4, 0.0, 0.0,
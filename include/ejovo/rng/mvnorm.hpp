@@ -0,0 +1,100 @@
+/**========================================================================
+ * ?                          mvnorm.hpp
+ * @brief   : Multivariate normal sampler with a cached Cholesky factor
+ * @details : X = mu + L Z with Sigma = L L^T and Z standard normal. The factor
+ *            is computed once, at construction. Batches are sampled as data
+ *            matrices (rows are observations, as in linalg::cov): a block of
+ *            rows of Z is filled with bulk normals and multiplied by L^T with
+ *            one blas::gemm, so the cost is that of a GEMM instead of n
+ *            matrix-vector products.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+#include "types.hpp"
+#include "ejovo/linalg/blas.hpp"
+#include "ejovo/linalg/cholesky.hpp"
+
+namespace ejovo {
+
+    namespace rng {
+
+    /**
+     * @brief N(mu, Sigma) for a k-vector mu and a k x k positive definite Sigma
+     *
+     * @code
+     * rng::MultivariateNormal mvn (mu, Sigma);
+     * Matrix<double> X (n, mvn.dim());
+     * mvn.fill(rng::simd_engine(), X.data.get(), n);   // n observations
+     * @endcode
+     */
+    class MultivariateNormal {
+
+    public:
+
+        // Only the lower triangle of Sigma is read
+        MultivariateNormal(const Matrix<double>& mu, const Matrix<double>& sigma)
+            : mu_(mu.data.get(), mu.data.get() + mu.size()), chol_(sigma)
+        {
+            if (chol_.size() != mu_.size()) throw std::runtime_error("Mean and covariance dimensions differ");
+            if (!chol_.is_spd()) throw std::runtime_error("Covariance matrix is not positive definite");
+        }
+
+        std::size_t dim() const { return mu_.size(); }
+        const Matrix<double>& L() const { return chol_.factors(); }
+
+        // One observation into out[0], out[stride], ...
+        template <class G>
+        void operator()(G& g, double *out, std::size_t stride = 1) const {
+            const std::size_t k = dim();
+            const double *l = chol_.factors().data.get();
+            std::vector<double> z (k);
+            for (auto& x : z) x = g.norm();
+            for (std::size_t i = 0; i < k; i++) {
+                double acc = mu_[i];
+                for (std::size_t j = 0; j <= i; j++) acc += l[i + j * k] * z[j];
+                out[i * stride] = acc;
+            }
+        }
+
+        /**
+         * @brief n observations into the rows of the n x k column-major matrix at out (leading dimension ld)
+         *
+         * `v` is a bulk engine with fill_norm, such as rng::XoshiroSimd.
+         */
+        template <class B>
+        void fill(B& v, double *out, std::size_t n, std::size_t ld = 0) const {
+            if (ld == 0) ld = n;
+            const std::size_t k = dim();
+            const double *l = chol_.factors().data.get();
+            std::vector<double> z (block * k);
+            for (std::size_t r0 = 0; r0 < n; r0 += block) {
+                const std::size_t rows = std::min(block, n - r0);
+                v.fill_norm(z.data(), rows * k);
+                // X = Z L^T, then the mean
+                blas::gemm(blas::Op::N, blas::Op::T, rows, k, k, 1.0, z.data(), rows, l, k, 0.0, out + r0, ld);
+                for (std::size_t j = 0; j < k; j++) {
+                    double *col = out + r0 + j * ld;
+                    for (std::size_t i = 0; i < rows; i++) col[i] += mu_[j];
+                }
+            }
+        }
+
+    private:
+
+        static constexpr std::size_t block = 256;   // rows of Z per product
+
+        std::vector<double> mu_;
+        linalg::Cholesky<double> chol_;
+
+    };
+
+    };
+
+};
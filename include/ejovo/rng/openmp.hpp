@@ -11,9 +11,17 @@
 // need to find openmp libraries with FindOpenMP
 // Need to provide conditional compilation if the OpenMP libraries are found
 #include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 #include <omp.h>
 
 #include "types.hpp"
+#include "engine.hpp"
+#include "alias.hpp"
+#include "gamma.hpp"
+#include "mvnorm.hpp"
 
 #pragma once
 
@@ -26,36 +34,182 @@ namespace omp  {
     // Let's add some omp utility functions here
     const auto processor_count = std::thread::hardware_concurrency();
 
+    // Tuning of the parallel samplers
+    struct SampleOptions {
+        std::size_t np = 0;             // number of threads, 0 for omp_get_max_threads()
+        std::size_t grain = 1 << 16;    // elements (rows, for matrix samplers) per chunk; every chunk draws from its own stream
+    };
+
+namespace detail {
+
+    // Chunk c draws from the master long-jumped c times, so the scalar stream of a chunk
+    // and the SIMD lanes an XoshiroSimd seeded from it (plain jumps) never overlap another chunk
+    inline std::vector<rng::Xoshiro> chunk_streams(rng::Xoshiro& master, std::size_t chunks) {
+        std::vector<rng::Xoshiro> out;
+        out.reserve(chunks);
+        for (std::size_t c = 0; c < chunks; c++) {
+            out.push_back(master);
+            master.long_jump();
+        }
+        return out;
+    }
+
 };
 
+    /**
+     * @brief Run f(g, begin, len) over the chunks of [0, n) in parallel
+     *
+     * The chunks hold opts.grain indices; chunk c gets g, the c-th stream split off the calling
+     * thread's rng::engine(). This is the scheduling behind parallel_fill, for samplers that do
+     * not write one contiguous range (the rows of a column-major matrix, say).
+     */
+    template <class F>
+    void parallel_chunks(std::size_t n, F&& f, SampleOptions opts = {}) {
+
+        if (n == 0) return;
+        if (opts.grain == 0) throw std::runtime_error("parallel sampling: the grain must be positive");
+
+        const std::size_t np = opts.np ? opts.np : static_cast<std::size_t>(omp_get_max_threads());
+        const std::size_t chunks = (n + opts.grain - 1) / opts.grain;
+        auto streams = detail::chunk_streams(rng::engine(), chunks);
+
+        #pragma omp parallel for num_threads(np) schedule(static)
+        for (std::size_t c = 0; c < chunks; c++) {
+            const std::size_t begin = c * opts.grain;
+            f(streams[c], begin, std::min(opts.grain, n - begin));
+        }
+    }
 
+    /**
+     * @brief Fill out[0, n) with draws of any distribution, in parallel
+     *
+     * `draw` is either a per-element sampler `T draw(rng::Xoshiro&)` or a bulk one
+     * `void draw(rng::Xoshiro&, T* out, std::size_t len)`. The range is cut into
+     * chunks of opts.grain elements, chunk c being sampled from the c-th stream
+     * split off the calling thread's rng::engine(); chunks are dealt statically to
+     * the threads. The result therefore only depends on the seed and the grain,
+     * never on the number of threads or on scheduling.
+     *
+     * Each chunk is written by the thread that samples it: on a freshly
+     * allocated (untouched) Matrix, its pages are first touched there and land on
+     * that thread's NUMA node.
+     */
+    template <class T, class F>
+    void parallel_fill(T *out, std::size_t n, F&& draw, SampleOptions opts = {}) {
+        parallel_chunks(n, [&] (rng::Xoshiro& g, std::size_t begin, std::size_t len) {
+            if constexpr (std::is_invocable_v<F&, rng::Xoshiro&, T*, std::size_t>) {
+                draw(g, out + begin, len);
+            } else {
+                for (std::size_t i = begin; i < begin + len; i++) out[i] = static_cast<T>(draw(g));
+            }
+        }, opts);
+    }
 
+    // Row vector of n draws of `draw`, sampled by parallel_fill
+    template <class T, class F>
+    Matrix<T> parallel_sample(int n, F&& draw, SampleOptions opts = {}) {
 
-inline Matrix<double> runif_omp(int n, double a = 0, double b = 1, std::size_t np = 5000) {
+        if (n <= 0) return Matrix<T>::null();
 
+        Matrix<T> out(1, n);
+        parallel_fill<T>(out.data.get(), out.size(), std::forward<F>(draw), opts);
 
-    if (n <= 0) return Matrix<double>::null();
+        return out;
+    }
+
+};
 
-    // Use one less processor then the maximum processor count
-    std::size_t n_processors = std::max(np, static_cast<std::size_t>(omp::processor_count - 1));
-    Matrix<double> out(1, n);
-    auto thread_rng = rng::Xoshiro();
+/**
+ * @brief n uniform deviates on [a, b], drawn in parallel
+ *
+ * Sampled by omp::parallel_fill with the default grain: after ejovo::set_seed(s)
+ * a run is bit-reproducible, whatever np (which defaults to the number of OpenMP threads).
+ */
+inline Matrix<double> runif_omp(int n, double a = 0, double b = 1, std::size_t np = 0) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g, double *out, std::size_t len) {
+        rng::XoshiroSimd<>(g).fill_uniform(out, len, a, b);
+    }, {.np = np});
+}
 
-    #pragma omp parallel private(thread_rng)
-    {
+inline Matrix<double> rnorm_omp(int n, double mean = 0, double sd = 1, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g, double *out, std::size_t len) {
+        rng::XoshiroSimd<>(g).fill_norm(out, len, mean, sd);
+    }, opts);
+}
 
-        thread_rng.seed();
+inline Matrix<double> rexp_omp(int n, double rate = 1, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g, double *out, std::size_t len) {
+        rng::XoshiroSimd<>(g).fill_exp(out, len, rate);
+    }, opts);
+}
 
-        #pragma omp for
-        for (std::size_t i = 0; i < out.size(); i++) {
-            out[i] = thread_rng.unifd(a, b);
-        }
-    }
+inline Matrix<double> rbinom_omp(int n, int size, double p = 0.5, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g) { return g.binom(size, p); }, opts);
+}
+
+inline Matrix<bool> rbernoulli_omp(int n, double p = 0.5, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<bool>(n, [=] (rng::Xoshiro& g) { return g.bernouilli(p); }, opts);
+}
+
+// The alias table is built once and shared read-only by every thread
+inline Matrix<int> rcat_omp(int n, const Matrix<double>& p, omp::SampleOptions opts = {}) {
+    const rng::AliasTable table (p);
+    return omp::parallel_sample<int>(n, [&] (rng::Xoshiro& g, int *out, std::size_t len) {
+        table.fill(g, out, len);
+    }, opts);
+}
+
+inline Matrix<double> rhyper_omp(int n, int ndraws, int N, int K, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g) { return g.hyper(ndraws, N, K); }, opts);
+}
+
+inline Matrix<double> rgamma_omp(int n, double shape, double scale = 1, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g, double *out, std::size_t len) {
+        rng::XoshiroSimd<> v(g);
+        rng::fill_gamma(v, out, len, shape, scale);
+    }, opts);
+}
+
+inline Matrix<double> rbeta_omp(int n, double a, double b, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g, double *out, std::size_t len) {
+        rng::XoshiroSimd<> v(g);
+        rng::fill_beta(v, out, len, a, b);
+    }, opts);
+}
+
+inline Matrix<double> rpois_omp(int n, double lambda, omp::SampleOptions opts = {}) {
+    return omp::parallel_sample<double>(n, [=] (rng::Xoshiro& g) { return g.poisson(lambda); }, opts);
+}
+
+// n x k, one draw per row; chunks are blocks of rows
+inline Matrix<double> rdirichlet_omp(int n, const Matrix<double>& alpha, omp::SampleOptions opts = {}) {
+
+    if (n <= 0 || alpha.size() == 0) return Matrix<double>::null();
+
+    const std::size_t k = alpha.size();
+    Matrix<double> out(n, k);
+    double *x = out.data.get();
+    omp::parallel_chunks(n, [&] (rng::Xoshiro& g, std::size_t begin, std::size_t len) {
+        for (std::size_t i = begin; i < begin + len; i++) rng::dirichlet(g, alpha.data.get(), k, x + i, n);
+    }, opts);
 
     return out;
 }
 
+// n x k, one draw per row; Sigma is factored once and every block of rows is one GEMM
+inline Matrix<double> rmvnorm_omp(int n, const Matrix<double>& mu, const Matrix<double>& sigma, omp::SampleOptions opts = {}) {
 
+    if (n <= 0) return Matrix<double>::null();
+
+    const rng::MultivariateNormal mvn (mu, sigma);
+    Matrix<double> out(n, mvn.dim());
+    omp::parallel_chunks(n, [&] (rng::Xoshiro& g, std::size_t begin, std::size_t len) {
+        rng::XoshiroSimd<> v(g);
+        mvn.fill(v, out.data.get() + begin, len, n);
+    }, opts);
+
+    return out;
+}
 
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,221 @@
+/**========================================================================
+ * ?                          philox.hpp
+ * @brief   : Philox4x32-10 counter-based generator
+ * @details : Philox (Salmon et al., "Parallel random numbers: as easy as
+ *            1, 2, 3", SC 2011) is a keyed bijection of 128-bit counters:
+ *            output i of a stream is a pure function of (seed, stream, i).
+ *            Skipping ahead is free, any sample can be recomputed on its own,
+ *            and a matrix filled in parallel is identical whatever the number
+ *            of threads or the way the work is split.
+ *
+ *            Block b of a stream encrypts the counter {b, stream} under the key
+ *            `seed` and yields 128 bits, i.e. the 64-bit outputs 2b and 2b + 1.
+ *            The engine exposes the same distribution API as rng::Xoshiro
+ *            through rng::Distributions, consuming outputs sequentially from
+ *            its position; generate() and the fill_* methods compute many
+ *            blocks at once, one counter per SIMD lane.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "distributions.hpp"
+
+namespace ejovo {
+
+    namespace rng {
+
+        class Philox : public Distributions<Philox> {
+
+        public:
+
+            using Counter = std::array<uint32_t, 4>;
+            using Key = std::array<uint32_t, 2>;
+
+            static constexpr int rounds = 10;
+
+            explicit Philox(uint64_t seed = 0, uint64_t stream = 0) : seed_{seed}, stream_{stream} {}
+
+            // The Philox4x32-10 bijection of a single counter
+            static Counter block(Counter ctr, Key key);
+
+            // Output i of the stream, without touching the position
+            uint64_t operator[](uint64_t i) const;
+
+            // Outputs first, ..., first + n - 1 of the stream into out
+            void generate(uint64_t first, std::size_t n, uint64_t *out) const;
+
+            // Sequential interface, used by the distributions
+            inline uint64_t next();
+            uint64_t position() const { return pos_; }
+            Philox& seek(uint64_t i) { pos_ = i; return *this; }
+            Philox& discard(uint64_t n) { pos_ += n; return *this; }
+
+            /**
+             * @brief out[i] ~ U(a, b) from the outputs position() + i, then skip past them
+             *
+             * Computed in parallel; the values do not depend on the thread count
+             * and equal those of n successive unifd(a, b) calls.
+             */
+            void fill_unif(double *out, std::size_t n, double a = 0, double b = 1);
+
+            /**
+             * @brief out[i] ~ N(mean, sd^2) by Box-Muller on the output pairs position() + 2k, + 2k + 1
+             *
+             * Both deviates of each pair are used, so this consumes n rounded up to an
+             * even number of outputs and does not reproduce successive norm() calls.
+             */
+            void fill_norm(double *out, std::size_t n, double mean = 0, double sd = 1);
+
+        private:
+
+            uint64_t seed_;
+            uint64_t stream_;
+            uint64_t pos_ = 0;
+            uint64_t cached_ = ~uint64_t(0);  // block held in buf_
+            uint64_t buf_[2];
+
+            // Visit the outputs [first, first + n) in chunks: f(offset, count, values)
+            template <class F>
+            void for_each_chunk(uint64_t first, std::size_t n, F&& f) const;
+
+        };
+
+        namespace detail {
+
+            inline constexpr uint32_t philox_m0 = 0xD2511F53, philox_m1 = 0xCD9E8D57;
+            inline constexpr uint32_t philox_w0 = 0x9E3779B9, philox_w1 = 0xBB67AE85;
+
+            // Up to 2^53 in [0, 1], the same mapping as Distributions::next_double
+            inline double to_unit(uint64_t bits) {
+                return (double) bits / (double) ULONG_MAX;
+            }
+
+        };
+
+        inline Philox::Counter Philox::block(Counter c, Key k) {
+            for (int r = 0; r < rounds; r++) {
+                const uint64_t p0 = uint64_t(detail::philox_m0) * c[0];
+                const uint64_t p1 = uint64_t(detail::philox_m1) * c[2];
+                c = {uint32_t(p1 >> 32) ^ c[1] ^ k[0], uint32_t(p1), uint32_t(p0 >> 32) ^ c[3] ^ k[1], uint32_t(p0)};
+                k[0] += detail::philox_w0;
+                k[1] += detail::philox_w1;
+            }
+            return c;
+        }
+
+        inline uint64_t Philox::operator[](uint64_t i) const {
+            const uint64_t b = i / 2;
+            const auto x = block({uint32_t(b), uint32_t(b >> 32), uint32_t(stream_), uint32_t(stream_ >> 32)},
+                                 {uint32_t(seed_), uint32_t(seed_ >> 32)});
+            return (i % 2 == 0) ? (x[0] | uint64_t(x[1]) << 32) : (x[2] | uint64_t(x[3]) << 32);
+        }
+
+        inline void Philox::generate(uint64_t first, std::size_t n, uint64_t *out) const {
+
+            if (n == 0) return;
+
+            // odd head, whole blocks, odd tail
+            std::size_t i = 0;
+            if (first % 2 == 1) out[i++] = (*this)[first];
+
+            constexpr std::size_t lanes = 64;
+            const uint32_t s0 = uint32_t(stream_), s1 = uint32_t(stream_ >> 32);
+
+            while (n - i >= 2) {
+
+                const uint64_t b0 = (first + i) / 2;
+                const std::size_t nb = std::min(lanes, (n - i) / 2);
+
+                uint32_t c0[lanes], c1[lanes], c2[lanes], c3[lanes];
+                #pragma omp simd
+                for (std::size_t l = 0; l < nb; l++) {
+                    const uint64_t b = b0 + l;
+                    c0[l] = uint32_t(b);
+                    c1[l] = uint32_t(b >> 32);
+                    c2[l] = s0;
+                    c3[l] = s1;
+                }
+
+                uint32_t k0 = uint32_t(seed_), k1 = uint32_t(seed_ >> 32);
+                for (int r = 0; r < rounds; r++) {
+                    #pragma omp simd
+                    for (std::size_t l = 0; l < nb; l++) {
+                        const uint64_t p0 = uint64_t(detail::philox_m0) * c0[l];
+                        const uint64_t p1 = uint64_t(detail::philox_m1) * c2[l];
+                        const uint32_t x0 = uint32_t(p1 >> 32) ^ c1[l] ^ k0;
+                        const uint32_t x2 = uint32_t(p0 >> 32) ^ c3[l] ^ k1;
+                        c1[l] = uint32_t(p1);
+                        c3[l] = uint32_t(p0);
+                        c0[l] = x0;
+                        c2[l] = x2;
+                    }
+                    k0 += detail::philox_w0;
+                    k1 += detail::philox_w1;
+                }
+
+                uint64_t *o = out + i;
+                #pragma omp simd
+                for (std::size_t l = 0; l < nb; l++) {
+                    o[2 * l] = c0[l] | uint64_t(c1[l]) << 32;
+                    o[2 * l + 1] = c2[l] | uint64_t(c3[l]) << 32;
+                }
+                i += 2 * nb;
+            }
+
+            if (i < n) out[i] = (*this)[first + i];
+        }
+
+        inline uint64_t Philox::next() {
+            const uint64_t b = pos_ / 2;
+            if (b != cached_) {
+                generate(2 * b, 2, buf_);
+                cached_ = b;
+            }
+            return buf_[pos_++ % 2];
+        }
+
+        template <class F>
+        void Philox::for_each_chunk(uint64_t first, std::size_t n, F&& f) const {
+            constexpr std::size_t chunk = 4096;
+            const std::size_t chunks = (n + chunk - 1) / chunk;
+            #pragma omp parallel for if(chunks > 1) schedule(static)
+            for (std::size_t c = 0; c < chunks; c++) {
+                uint64_t bits[chunk];
+                const std::size_t i0 = c * chunk, len = std::min(chunk, n - i0);
+                generate(first + i0, len, bits);
+                f(i0, len, bits);
+            }
+        }
+
+        inline void Philox::fill_unif(double *out, std::size_t n, double a, double b) {
+            const double spread = b - a;
+            for_each_chunk(pos_, n, [&] (std::size_t i0, std::size_t len, const uint64_t *bits) {
+                #pragma omp simd
+                for (std::size_t i = 0; i < len; i++) out[i0 + i] = detail::to_unit(bits[i]) * spread + a;
+            });
+            pos_ += n;
+        }
+
+        inline void Philox::fill_norm(double *out, std::size_t n, double mean, double sd) {
+            const std::size_t pairs = (n + 1) / 2;
+            // chunks hold an even number of outputs, so every pair stays within one chunk
+            for_each_chunk(pos_, 2 * pairs, [&] (std::size_t i0, std::size_t len, const uint64_t *bits) {
+                for (std::size_t i = 0; i < len; i += 2) {
+                    const double R = std::sqrt(-2 * std::log(detail::to_unit(bits[i])));
+                    const double theta = 2 * M_PI * detail::to_unit(bits[i + 1]);
+                    out[i0 + i] = mean + sd * R * std::cos(theta);
+                    if (i0 + i + 1 < n) out[i0 + i + 1] = mean + sd * R * std::sin(theta);
+                }
+            });
+            pos_ += 2 * pairs;
+        }
+
+    };
+
+};
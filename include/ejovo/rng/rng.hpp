@@ -4,6 +4,10 @@
 
 #include "types.hpp"
 #include "Xoshiro.hpp"
+#include "xoshiro_simd.hpp"
+#include "engine.hpp"
+#include "alias.hpp"
+#include "mvnorm.hpp"
 #include "ejovo/quadrature.hpp"
 
 
@@ -12,10 +16,16 @@ namespace ejovo {
 
     namespace rng {
 
-        Xoshiro xoroshiro {};
+        // Former global engine, now bound to the calling thread's default engine (see engine.hpp)
+        inline thread_local Xoshiro& xoroshiro = engine();
 
     };
 
+    // Seed the default generators of every thread, making every subsequent sample reproducible
+    inline void set_seed(uint64_t seed) {
+        rng::seed_all(seed);
+    }
+
     // Memoized version of nCk
     uint64_t n_choose_k(uint64_t n, uint64_t k) {
 
@@ -42,9 +52,7 @@ namespace ejovo {
         if (n <= 0) return Matrix<double>::null();
 
         Matrix<double> out(1, n);
-        out.loop([&] (double& x) {
-            x = ejovo::rng::xoroshiro.unifd(a, b);
-        });
+        ejovo::rng::simd_engine().fill_uniform(out.data.get(), out.size(), a, b);
 
         return out;
     }
@@ -55,9 +63,7 @@ namespace ejovo {
         if (n <= 0) return Matrix<double>::null();
 
         Matrix<double> out(1, n);
-        out.loop([&] (double& x) {
-            x = ejovo::rng::xoroshiro.norm(mean, sd);
-        });
+        ejovo::rng::simd_engine().fill_norm(out.data.get(), out.size(), mean, sd);
 
         return out;
     }
@@ -68,9 +74,7 @@ namespace ejovo {
         if (n <= 0) return Matrix<double>::null();
 
         Matrix<double> out(1, n);
-        out.loop([&] (double& x) {
-            x = ejovo::rng::xoroshiro.exp(rate);
-        });
+        ejovo::rng::simd_engine().fill_exp(out.data.get(), out.size(), rate);
 
         return out;
     }
@@ -80,8 +84,9 @@ namespace ejovo {
         if (n <= 0) return Matrix<double>::null();
 
         Matrix<double> out(1, n);
+        auto& g = ejovo::rng::engine();
         out.loop([&] (double& x) {
-            x = ejovo::rng::xoroshiro.binom(size, p);
+            x = g.binom(size, p);
         });
 
         return out;
@@ -92,8 +97,9 @@ namespace ejovo {
         if (n <= 0) return Matrix<bool>::null();
 
         Matrix<bool> out(1, n);
+        auto& g = ejovo::rng::engine();
         out.loop([&] (bool& b) {
-            b = ejovo::rng::xoroshiro.bernouilli(p);
+            b = g.bernouilli(p);
         });
 
         return out;
@@ -104,10 +110,10 @@ namespace ejovo {
 
         if (n == 0) return Matrix<int>::null();
 
+        // O(k) once, then O(1) per draw
+        const rng::AliasTable table (p);
         Matrix<int> out(1, n);
-        out.loop([&] (int& x) {
-            x = ejovo::rng::xoroshiro.categorical<double>(p);
-        });
+        table.fill(ejovo::rng::engine(), out.data.get(), out.size());
 
         return out;
 
@@ -129,12 +135,90 @@ namespace ejovo {
         if (n == 0) return Matrix<double>::null();
 
         Matrix<double> out(1, n);
+        auto& g = ejovo::rng::engine();
+        out.loop([&] (double& x) {
+            x = g.hyper(ndraws, N, K);
+        });
+
+        return out;
+
+    }
+
+    inline Matrix<double> rgamma(int n, double shape, double scale = 1) {
+
+        if (n <= 0) return Matrix<double>::null();
+
+        Matrix<double> out(1, n);
+        rng::fill_gamma(ejovo::rng::simd_engine(), out.data.get(), out.size(), shape, scale);
+
+        return out;
+    }
+
+    inline Matrix<double> rbeta(int n, double a, double b) {
+
+        if (n <= 0) return Matrix<double>::null();
+
+        Matrix<double> out(1, n);
+        rng::fill_beta(ejovo::rng::simd_engine(), out.data.get(), out.size(), a, b);
+
+        return out;
+    }
+
+    inline Matrix<double> rpois(int n, double lambda) {
+
+        if (n <= 0) return Matrix<double>::null();
+
+        Matrix<double> out(1, n);
+        auto& g = ejovo::rng::engine();
         out.loop([&] (double& x) {
-            x = ejovo::rng::xoroshiro.hyper(ndraws, N, K);
+            x = g.poisson(lambda);
         });
 
         return out;
+    }
+
+    // n x k matrix whose rows are draws of Dirichlet(alpha)
+    inline Matrix<double> rdirichlet(int n, const Matrix<double>& alpha) {
 
+        if (n <= 0 || alpha.size() == 0) return Matrix<double>::null();
+
+        const std::size_t k = alpha.size();
+        Matrix<double> out(n, k);
+        double *x = out.data.get();
+
+        if (alpha.all([] (double a) { return a < 0.1; })) {
+            // tiny parameters: stick-breaking, row by row
+            auto& g = ejovo::rng::engine();
+            for (int i = 0; i < n; i++) rng::dirichlet(g, alpha.data.get(), k, x + i, n);
+            return out;
+        }
+
+        // one column of gammas per component, then normalize the rows
+        auto& v = ejovo::rng::simd_engine();
+        for (std::size_t j = 0; j < k; j++) rng::fill_gamma(v, x + j * n, n, alpha[j]);
+
+        auto sum = Matrix<double>::zeros(n, 1);
+        for (std::size_t j = 0; j < k; j++) {
+            for (int i = 0; i < n; i++) sum[i] += x[i + j * n];
+        }
+        for (std::size_t j = 0; j < k; j++) {
+            for (int i = 0; i < n; i++) x[i + j * n] /= sum[i];
+        }
+
+        return out;
+    }
+
+    // n x k matrix whose rows are draws of N(mu, Sigma). Sample with rng::MultivariateNormal
+    // directly to factor Sigma only once across calls.
+    inline Matrix<double> rmvnorm(int n, const Matrix<double>& mu, const Matrix<double>& sigma) {
+
+        if (n <= 0) return Matrix<double>::null();
+
+        const rng::MultivariateNormal mvn (mu, sigma);
+        Matrix<double> out(n, mvn.dim());
+        mvn.fill(ejovo::rng::simd_engine(), out.data.get(), n);
+
+        return out;
     }
 
     template <int N = 1000>
@@ -0,0 +1,190 @@
+/**========================================================================
+ * ?                          xoshiro_simd.hpp
+ * @brief   : Interleaved xoshiro256** lanes for bulk generation
+ * @details : XoshiroSimd<L> advances L independent xoshiro256** states in
+ *            lockstep. The states are stored lane-contiguous (s[word][lane]),
+ *            so one step of all the lanes is a handful of vector shifts, xors
+ *            and rotates: with L = 8 it fills an AVX-512 register (two AVX2
+ *            ones) per state word.
+ *
+ *            Lane l is the master generator advanced by l jumps (2^128 draws),
+ *            so the lanes never overlap and lane l reproduces exactly the
+ *            sequence of the scalar rng::Xoshiro it was derived from.
+ *
+ *            The fill_* methods write whole blocks of L values; when n is not
+ *            a multiple of L the outputs of the last partial block are dropped.
+ *            Doubles take the top 53 bits, (x >> 11) 2^-53, which lies in [0, 1).
+ *
+ *            Normal and exponential deviates use the ziggurat: the fast path is
+ *            evaluated for a whole batch of words at once and the few rejected
+ *            samples are then redrawn from a spare stream (the master jumped L times).
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "Xoshiro.hpp"
+#include "ziggurat.hpp"
+
+namespace ejovo {
+
+    namespace rng {
+
+        template <std::size_t L = 8>
+        class XoshiroSimd {
+
+        public:
+
+            static constexpr std::size_t lanes = L;
+
+            XoshiroSimd() : XoshiroSimd(Xoshiro()) {}
+            explicit XoshiroSimd(uint64_t seed) : XoshiroSimd(Xoshiro(seed)) {}
+            explicit XoshiroSimd(Xoshiro master) { seed(master); }
+
+            // Lane l takes the state of `master` jumped l times
+            XoshiroSimd& seed(Xoshiro master) {
+                for (std::size_t l = 0; l < L; l++) {
+                    for (int w = 0; w < 4; w++) s_[w][l] = master.state[w];
+                    master.jump();
+                }
+                spare_ = master;
+                return *this;
+            }
+
+            XoshiroSimd& seed(uint64_t seed) { return this->seed(Xoshiro(seed)); }
+
+            // The scalar generator currently in lane l
+            Xoshiro lane(std::size_t l) const {
+                return Xoshiro(s_[0][l], s_[1][l], s_[2][l], s_[3][l]);
+            }
+
+            // out[k L + l] = k-th next output of lane l, for k L + l < n
+            void fill(uint64_t *out, std::size_t n);
+
+            void fill_uniform(double *out, std::size_t n, double a = 0, double b = 1);
+            void fill_norm(double *out, std::size_t n, double mean = 0, double sd = 1);
+            void fill_exp(double *out, std::size_t n, double rate = 1);
+
+        private:
+
+            alignas(64) uint64_t s_[4][L];
+            Xoshiro spare_ {0};  // slow paths of the ziggurat
+
+            // Visit the outputs in stack-sized batches: f(offset, count, bits)
+            template <class F>
+            void batches(std::size_t n, F&& f) {
+                constexpr std::size_t batch = 64 * L;
+                alignas(64) uint64_t bits[batch];
+                for (std::size_t i = 0; i < n; i += batch) {
+                    const std::size_t len = std::min(batch, n - i);
+                    fill(bits, len);
+                    f(i, len, bits);
+                }
+            }
+
+            static double to_unit(uint64_t x) {
+                return double(x >> 11) * 0x1.0p-53;
+            }
+
+        };
+
+        template <std::size_t L>
+        void XoshiroSimd<L>::fill(uint64_t *out, std::size_t n) {
+
+            // The state lives in registers for the whole loop
+            alignas(64) uint64_t s0[L], s1[L], s2[L], s3[L];
+            std::copy_n(s_[0], L, s0);
+            std::copy_n(s_[1], L, s1);
+            std::copy_n(s_[2], L, s2);
+            std::copy_n(s_[3], L, s3);
+
+            for (std::size_t k = 0; k < n; k += L) {
+                alignas(64) uint64_t r[L];
+                #pragma omp simd aligned(s0, s1, s2, s3, r : 64)
+                for (std::size_t l = 0; l < L; l++) {
+                    const uint64_t x = s1[l] * 5;
+                    r[l] = ((x << 7) | (x >> 57)) * 9;
+                    const uint64_t t = s1[l] << 17;
+                    s2[l] ^= s0[l];
+                    s3[l] ^= s1[l];
+                    s1[l] ^= s2[l];
+                    s0[l] ^= s3[l];
+                    s2[l] ^= t;
+                    s3[l] = (s3[l] << 45) | (s3[l] >> 19);
+                }
+                const std::size_t len = std::min(L, n - k);
+                std::copy_n(r, len, out + k);
+            }
+
+            std::copy_n(s0, L, s_[0]);
+            std::copy_n(s1, L, s_[1]);
+            std::copy_n(s2, L, s_[2]);
+            std::copy_n(s3, L, s_[3]);
+        }
+
+        template <std::size_t L>
+        void XoshiroSimd<L>::fill_uniform(double *out, std::size_t n, double a, double b) {
+            const double spread = b - a;
+            batches(n, [&] (std::size_t i0, std::size_t len, const uint64_t *bits) {
+                double *o = out + i0;
+                #pragma omp simd
+                for (std::size_t i = 0; i < len; i++) o[i] = to_unit(bits[i]) * spread + a;
+            });
+        }
+
+        template <std::size_t L>
+        void XoshiroSimd<L>::fill_norm(double *out, std::size_t n, double mean, double sd) {
+            const auto& t = detail::zig_normal;
+            batches(n, [&] (std::size_t i0, std::size_t len, const uint64_t *bits) {
+                double *o = out + i0;
+                bool rejected = false;
+                #pragma omp simd reduction(||:rejected)
+                for (std::size_t i = 0; i < len; i++) {
+                    const unsigned k = bits[i] & 0xff;
+                    const double x = (2 * detail::zig_unit(bits[i]) - 1) * t.x[k];
+                    const bool inside = std::abs(x) < t.x[k + 1];
+                    o[i] = x;
+                    rejected = rejected || !inside;
+                }
+                if (rejected) {
+                    for (std::size_t i = 0; i < len; i++) {
+                        const unsigned k = bits[i] & 0xff;
+                        if (!(std::abs(o[i]) < t.x[k + 1])) o[i] = ziggurat_normal(bits[i], spare_);
+                    }
+                }
+                #pragma omp simd
+                for (std::size_t i = 0; i < len; i++) o[i] = mean + sd * o[i];
+            });
+        }
+
+        template <std::size_t L>
+        void XoshiroSimd<L>::fill_exp(double *out, std::size_t n, double rate) {
+            const auto& t = detail::zig_exp;
+            const double scale = 1.0 / rate;
+            batches(n, [&] (std::size_t i0, std::size_t len, const uint64_t *bits) {
+                double *o = out + i0;
+                bool rejected = false;
+                #pragma omp simd reduction(||:rejected)
+                for (std::size_t i = 0; i < len; i++) {
+                    const unsigned k = bits[i] & 0xff;
+                    const double x = detail::zig_unit(bits[i]) * t.x[k];
+                    o[i] = x;
+                    rejected = rejected || !(x < t.x[k + 1]);
+                }
+                if (rejected) {
+                    for (std::size_t i = 0; i < len; i++) {
+                        if (!(o[i] < t.x[(bits[i] & 0xff) + 1])) o[i] = ziggurat_exp(bits[i], spare_);
+                    }
+                }
+                #pragma omp simd
+                for (std::size_t i = 0; i < len; i++) o[i] *= scale;
+            });
+        }
+
+    };
+
+};
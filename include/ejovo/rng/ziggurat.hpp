@@ -0,0 +1,166 @@
+/**========================================================================
+ * ?                          ziggurat.hpp
+ * @brief   : Ziggurat samplers for the normal and exponential distributions
+ * @details : Marsaglia & Tsang's ziggurat (J. Stat. Softw. 5, 2000) covers the
+ *            density with 256 horizontal layers of equal area. A draw picks a
+ *            layer and a point of it from a single 64-bit word: the low 8 bits
+ *            give the layer and the top 53 bits the abscissa, so, unlike the
+ *            original 32-bit version criticised by Doornik (2005), the two are
+ *            independent. About 99% of the draws land in the rectangular core
+ *            of their layer and cost one multiply and one compare; the rest
+ *            fall in a wedge (one exp) or the tail.
+ *
+ *            The layer tables are computed at compile time from (r, v), the
+ *            rightmost layer edge and the common layer area.
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+namespace ejovo {
+
+    namespace rng {
+
+    namespace detail {
+
+        // Constant-expression exp, log and sqrt, only used to build the tables
+
+        constexpr double cexp(double x) {
+            constexpr double ln2 = 0.69314718055994530942;
+            const long k = static_cast<long>(x / ln2 + (x < 0 ? -0.5 : 0.5));
+            const double r = x - k * ln2;
+            double term = 1, sum = 1;
+            for (int i = 1; i < 30; i++) {
+                term *= r / i;
+                sum += term;
+            }
+            for (long i = 0; i < k; i++) sum *= 2;
+            for (long i = 0; i > k; i--) sum /= 2;
+            return sum;
+        }
+
+        constexpr double clog(double y) {
+            constexpr double ln2 = 0.69314718055994530942;
+            int e = 0;
+            while (y >= 2) { y /= 2; e++; }
+            while (y < 1) { y *= 2; e--; }
+            // log(y) = 2 atanh(t), t = (y - 1) / (y + 1) <= 1/3
+            const double t = (y - 1) / (y + 1), t2 = t * t;
+            double power = t, sum = 0;
+            for (int i = 1; i < 80; i += 2) {
+                sum += power / i;
+                power *= t2;
+            }
+            return 2 * sum + e * ln2;
+        }
+
+        constexpr double csqrt(double y) {
+            if (y <= 0) return 0;
+            double x = y > 1 ? y : 1;
+            for (int i = 0; i < 100; i++) x = 0.5 * (x + y / x);
+            return x;
+        }
+
+        /**
+         * @brief Layer edges x[i] (decreasing) and density values f[i] = f(x[i])
+         *
+         * x[0] = v / f(r) is the width of the base strip (which carries the tail),
+         * x[1] = r and x[256] = 0.
+         */
+        struct ZigguratTable {
+            double r;
+            double x[257];
+            double f[257];
+        };
+
+        template <class F, class Finv>
+        constexpr ZigguratTable make_ziggurat(double r, double v, F f, Finv finv) {
+            ZigguratTable t {};
+            t.r = r;
+            t.x[0] = v / f(r);
+            t.x[1] = r;
+            for (int i = 1; i < 255; i++) t.x[i + 1] = finv(v / t.x[i] + f(t.x[i]));
+            t.x[256] = 0;
+            for (int i = 0; i < 257; i++) t.f[i] = f(t.x[i]);
+            return t;
+        }
+
+        // Unnormalized densities exp(-x^2 / 2) and exp(-x)
+        inline constexpr ZigguratTable zig_normal = make_ziggurat(3.654152885361008796, 0.00492867323399,
+            [] (double x) { return cexp(-0.5 * x * x); },
+            [] (double y) { return csqrt(-2 * clog(y)); });
+
+        inline constexpr ZigguratTable zig_exp = make_ziggurat(7.69711747013104972, 0.0039496598225815571993,
+            [] (double x) { return cexp(-x); },
+            [] (double y) { return -clog(y); });
+
+        // Top 53 bits as a double in [0, 1)
+        inline double zig_unit(uint64_t bits) {
+            return double(bits >> 11) * 0x1.0p-53;
+        }
+
+    };
+
+    /**
+     * @brief Standard normal deviate from the 64-bit word `bits`
+     *
+     * Words already drawn in bulk go through the fast path directly; g supplies
+     * the extra uniforms of the wedge and tail cases (and fresh words on rejection).
+     */
+    template <class G>
+    double ziggurat_normal(uint64_t bits, G& g) {
+        const auto& t = detail::zig_normal;
+        for (;;) {
+            const unsigned i = bits & 0xff;
+            const double u = 2 * detail::zig_unit(bits) - 1;
+            const double x = u * t.x[i];
+            if (std::abs(x) < t.x[i + 1]) return x;
+
+            if (i == 0) {
+                // Marsaglia's tail: x = r + a with a ~ Exp(r), accepted with probability exp(-a^2 / 2)
+                double a, b;
+                do {
+                    a = -std::log(1 - detail::zig_unit(g.next())) / t.r;
+                    b = -std::log(1 - detail::zig_unit(g.next()));
+                } while (2 * b < a * a);
+                return u < 0 ? -(t.r + a) : t.r + a;
+            }
+
+            if (t.f[i] + (t.f[i + 1] - t.f[i]) * detail::zig_unit(g.next()) < std::exp(-0.5 * x * x)) return x;
+            bits = g.next();
+        }
+    }
+
+    template <class G>
+    double ziggurat_normal(G& g) {
+        return ziggurat_normal(g.next(), g);
+    }
+
+    // Exp(1) deviate from the 64-bit word `bits`, g supplying any extra uniforms
+    template <class G>
+    double ziggurat_exp(uint64_t bits, G& g) {
+        const auto& t = detail::zig_exp;
+        for (;;) {
+            const unsigned i = bits & 0xff;
+            const double x = detail::zig_unit(bits) * t.x[i];
+            if (x < t.x[i + 1]) return x;
+
+            // memoryless tail
+            if (i == 0) return t.r - std::log(1 - detail::zig_unit(g.next()));
+
+            if (t.f[i] + (t.f[i + 1] - t.f[i]) * detail::zig_unit(g.next()) < std::exp(-x)) return x;
+            bits = g.next();
+        }
+    }
+
+    template <class G>
+    double ziggurat_exp(G& g) {
+        return ziggurat_exp(g.next(), g);
+    }
+
+    };
+
+};
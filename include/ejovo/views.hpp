@@ -0,0 +1,141 @@
+/**========================================================================
+ * ?                          views.hpp
+ * @brief   : Lazy, pipeable range adaptors over Grid1D
+ * @details : Every Grid1D (Matrix, the Matrix views, Vector) models a
+ *            std::ranges random-access range, so the standard range adaptors
+ *            can be chained on top of them without allocating a Matrix at
+ *            every stage. The terminal adaptors `collect()`, `sum()` and
+ *            `reduce()` run the whole pipeline in a single pass.
+ *
+ *            auto s = m | views::filter(p) | views::map(f) | views::sum();
+ *            auto v = m | views::map(f) | views::take(10) | views::collect();
+ *
+ * @author  : Evan Voyles
+ * @email   : ejovo13@yahoo.com
+ *========================================================================**/
+#pragma once
+
+#include <ranges>
+#include <vector>
+#include <cstring>
+#include <type_traits>
+
+#include "types.hpp"
+
+namespace ejovo {
+
+    namespace views {
+
+        /**========================================================================
+         *!                           Lazy adaptors
+         *========================================================================**/
+        // These are the standard adaptors under the names used by Grid1D's eager
+        // counterparts (m.map(f), m.filter(p), m.take(n), m.drop(n))
+        inline constexpr auto map = std::views::transform;
+        inline constexpr auto filter = std::views::filter;
+        inline constexpr auto take = std::views::take;
+        inline constexpr auto drop = std::views::drop;
+        inline constexpr auto take_while = std::views::take_while;
+        inline constexpr auto drop_while = std::views::drop_while;
+        inline constexpr auto reverse = std::views::reverse;
+
+        /**========================================================================
+         *!                           Terminal adaptors
+         *========================================================================**/
+        namespace detail {
+
+            // Any closure object deriving from Terminal can be applied with `range | closure`
+            struct Terminal {};
+
+            template <class C>
+            concept terminal = std::is_base_of_v<Terminal, std::remove_cvref_t<C>>;
+
+        };
+
+        /**
+         * @brief Materialize a range into a row vector
+         *
+         * Sized ranges are written directly into the output Matrix, otherwise
+         * (for example after a `filter`) the elements are buffered once and the
+         * Matrix is allocated to the final length.
+         */
+        struct Collect : detail::Terminal {
+
+            template <std::ranges::input_range R>
+            auto operator()(R&& r) const {
+
+                using T = std::remove_cvref_t<std::ranges::range_value_t<R>>;
+
+                if constexpr (std::ranges::sized_range<R>) {
+
+                    const int n = std::ranges::size(r);
+                    if (n == 0) return Matrix<T>::null();
+
+                    Matrix<T> out (1, n);
+                    std::ranges::copy(r, out.data.get());
+                    return out;
+
+                } else {
+
+                    std::vector<T> buffer;
+                    for (auto&& x : r) buffer.push_back(x);
+
+                    if (buffer.empty()) return Matrix<T>::null();
+
+                    Matrix<T> out (1, static_cast<int>(buffer.size()));
+                    std::ranges::copy(buffer, out.data.get());
+                    return out;
+                }
+            }
+        };
+
+        /**
+         * @brief Fold a range with a binary operation, starting from `init`
+         */
+        template <class BinaryOp, class U>
+        struct Reduce : detail::Terminal {
+
+            BinaryOp op;
+            U init;
+
+            Reduce(BinaryOp op, U init) : op{op}, init{init} {}
+
+            template <std::ranges::input_range R>
+            auto operator()(R&& r) const {
+                using T = std::remove_cvref_t<std::ranges::range_value_t<R>>;
+                std::common_type_t<T, U> acc = init;
+                for (auto&& x : r) acc = op(acc, x);
+                return acc;
+            }
+        };
+
+        /**
+         * @brief Sum the elements of a range
+         */
+        struct Sum : detail::Terminal {
+
+            template <std::ranges::input_range R>
+            auto operator()(R&& r) const {
+                std::remove_cvref_t<std::ranges::range_value_t<R>> acc = 0;
+                for (auto&& x : r) acc += x;
+                return acc;
+            }
+        };
+
+        inline Collect collect() { return Collect{}; }
+        inline Sum sum() { return Sum{}; }
+
+        template <class BinaryOp, class U>
+        Reduce<BinaryOp, U> reduce(BinaryOp op, U init) {
+            return Reduce<BinaryOp, U>(op, init);
+        }
+
+        // range | views::collect()
+        template <std::ranges::input_range R, detail::terminal C>
+        auto operator|(R&& r, const C& closure) {
+            return closure(std::forward<R>(r));
+        }
+
+    };
+
+};
@@ -7,6 +7,7 @@
 #include "declarations/Grid1D.hpp"
 #include "declarations/Grid2D.hpp"
 #include "declarations/Matrix.hpp"
+#include "declarations/Broadcast.hpp"
 #include "declarations/Vector.hpp"
 #include "declarations/AbsView.hpp"
 #include "declarations/MatView.hpp"
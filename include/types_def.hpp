@@ -5,6 +5,7 @@
 #include "definitions/Grid1D.hpp"
 #include "definitions/Grid2D.hpp"
 #include "definitions/Matrix.hpp"
+#include "definitions/Broadcast.hpp"
 #include "definitions/Vector.hpp"
 #include "definitions/AbsView.hpp"
 #include "definitions/MatView.hpp"
@@ -16,4 +16,62 @@ TEST(Core, Sequences) {
     std::cout << "M.size(): " << m.size() << "\n";
     EXPECT_EQ(m[-1], 10);
 
-}
\ No newline at end of file
+}
+TEST(Core, Broadcasting) {
+
+    auto A = Matrix<double>::from({1, 2, 3,
+                                   4, 5, 6}, 2, 3, true);
+    auto col = Matrix<double>::from({10, 20}, 2, 1);
+    auto row = Matrix<double>::from({1, 2, 3}, 1, 3);
+
+    auto B = A + col;
+    EXPECT_EQ(B.nrow(), 2);
+    EXPECT_EQ(B.ncol(), 3);
+    EXPECT_EQ(B(1, 3), 13);
+    EXPECT_EQ(B(2, 1), 24);
+
+    // a column and a row stretch to their outer shape
+    auto C = col + row;
+    EXPECT_EQ(C.nrow(), 2);
+    EXPECT_EQ(C.ncol(), 3);
+    EXPECT_EQ(C(2, 3), 23);
+
+    auto D = A / row;
+    EXPECT_EQ(D(2, 3), 2);
+
+    // % broadcasts like +, even when the operands have as many elements
+    auto r3 = Matrix<double>::from({1, 2, 3}, 1, 3), c3 = Matrix<double>::from({1, 10, 100}, 3, 1);
+    auto P = r3 % c3;
+    EXPECT_EQ(P.nrow(), 3);
+    EXPECT_EQ(P.ncol(), 3);
+    EXPECT_EQ(P(3, 2), 200);
+    EXPECT_EQ((r3 + c3).nrow(), P.nrow());
+    EXPECT_EQ((A % row)(2, 3), 18);
+    auto E = A;
+    E %= row;
+    EXPECT_EQ(E(2, 2), 10);
+
+    auto mask = A > row;
+    EXPECT_EQ(mask.count(), 3);
+
+    A -= col;
+    EXPECT_EQ(A(1, 1), -9);
+}
+
+TEST(Core, Meshgrid) {
+
+    auto u = seq<double>(3);
+    auto v = Matrix<double>::from({5, 6}, 1, 2);
+
+    auto [xx, yy] = meshgrid(u, v);
+
+    EXPECT_EQ(xx.nrow(), 3);
+    EXPECT_EQ(xx.ncol(), 2);
+    EXPECT_EQ(xx(3, 2), 3);
+    EXPECT_EQ(yy(3, 2), 6);
+
+    auto zz = xx + yy;
+    EXPECT_EQ(zz(2, 1), 7);
+    EXPECT_EQ(zz.to_matrix().sum(), (1 + 2 + 3) * 2 + (5 + 6) * 3);
+    EXPECT_EQ(xx.to_matrix().sum(), 12);
+}
@@ -0,0 +1,671 @@
+#include "ejovotest.hpp"
+#include <gtest/gtest.h>
+
+using namespace ejovo;
+
+// Largest absolute element-wise difference between two matrices of the same size
+static double max_diff(const Matrix<double>& a, const Matrix<double>& b) {
+    EXPECT_EQ(a.size(), b.size());
+    double d = 0;
+    for (std::size_t i = 0; i < a.size(); i++) d = std::max(d, std::abs(a[i] - b[i]));
+    return d;
+}
+
+TEST(Linalg, KroneckerProduct) {
+
+    auto A = Matrix<double>::from({1, 2, 3, 4, 5, 6}, 2, 3, true);
+    auto B = Matrix<double>::from({0, 1, 1, 0}, 2, 2, true);
+
+    auto K = A.kronecker_product(B);
+    EXPECT_EQ(K.nrow(), 4);
+    EXPECT_EQ(K.ncol(), 6);
+    EXPECT_EQ(K(1, 2), 1);  // a11 * b12
+    EXPECT_EQ(K(2, 5), 3);  // a13 * b21
+    EXPECT_EQ(K(4, 3), 5);  // a22 * b22
+
+    auto op = linalg::kron(A, B);
+    auto x = Matrix<double>::rand(6, 3);
+    EXPECT_LT(max_diff(op * x, K * x), 1e-12);
+
+    // The raw apply, reused, for both associations of B X A^T
+    for (auto [C, D] : {std::pair{A, B}, std::pair{Matrix<double>::rand(5, 2), Matrix<double>::rand(3, 4)}}) {
+        auto kop = linalg::kron(C, D);
+        auto KD = kop.to_matrix();
+        for (int rep = 0; rep < 2; rep++) {
+            auto v = Matrix<double>::rand(kop.ncol(), 1);
+            Matrix<double> y (kop.nrow(), 1);
+            kop.apply(v.data.get(), y.data.get());
+            EXPECT_LT(max_diff(y, KD * v), 1e-9);
+
+            std::vector<double> work (kop.work_size());
+            kop.apply(v.data.get(), y.data.get(), work.data());
+            EXPECT_LT(max_diff(y, KD * v), 1e-9);
+        }
+
+        // One operator shared by concurrent applies
+        auto V = Matrix<double>::rand(kop.ncol(), 8);
+        Matrix<double> Y (kop.nrow(), 8);
+        #pragma omp parallel for num_threads(4)
+        for (int j = 0; j < 8; j++) {
+            for (int rep = 0; rep < 50; rep++) kop.apply(V.data.get() + j * kop.ncol(), Y.data.get() + j * kop.nrow());
+        }
+        EXPECT_LT(max_diff(Y, KD * V), 1e-9);
+    }
+}
+
+TEST(Linalg, KroneckerSum) {
+
+    auto A = Matrix<double>::rand(3, 3);
+    auto B = Matrix<double>::rand(4, 4);
+
+    auto op = linalg::kron_sum(A, B);
+    auto x = Matrix<double>::rand(12, 2);
+    EXPECT_LT(max_diff(op * x, op.to_matrix() * x), 1e-10);
+}
+
+TEST(Linalg, Gemm) {
+
+    // Large enough to go through the packed, threaded path with ragged edges
+    auto A = Matrix<double>::rand(203, 157);
+    auto B = Matrix<double>::rand(157, 131);
+
+    auto C = A * B;
+    double err = 0;
+    for (int i = 1; i <= 203; i += 17) {
+        for (int j = 1; j <= 131; j += 13) {
+            err = std::max(err, std::abs(C(i, j) - A.dot(B, i, j)));
+        }
+    }
+    EXPECT_LT(err, 1e-9);
+
+    // Transposed operands
+    Matrix<double> D (157, 157);
+    blas::gemm(blas::Op::T, blas::Op::N, 157, 157, 203, 1.0, A.data.get(), 203, A.data.get(), 203, 0.0, D.data.get(), 157);
+    EXPECT_LT(max_diff(D, A.t() * A), 1e-9);
+}
+
+TEST(Linalg, GemvGer) {
+
+    // Sizes around the unrolling and chunking boundaries
+    for (auto [m, n] : {std::pair{1, 1}, std::pair{7, 5}, std::pair{513, 6}, std::pair{1030, 67}}) {
+
+        auto A = Matrix<double>::rand(m, n, -1, 1);
+        auto x = Matrix<double>::rand(n, 1, -1, 1);
+        auto z = Matrix<double>::rand(m, 1, -1, 1);
+
+        // reference products through the packed gemm
+        auto Ax = Matrix<double>(m, 1);
+        blas::gemm(blas::Op::N, blas::Op::N, m, 1, n, 1.0, A.data.get(), m, x.data.get(), n, 0.0, Ax.data.get(), m);
+        auto Atz = Matrix<double>(n, 1);
+        blas::gemm(blas::Op::T, blas::Op::N, n, 1, m, 1.0, A.data.get(), m, z.data.get(), m, 0.0, Atz.data.get(), n);
+
+        EXPECT_LT(max_diff(A * x, Ax), 1e-12);
+        EXPECT_LT(max_diff(z.as_rowvec() * A, Atz.as_rowvec()), 1e-12);
+
+        auto y = z.clone();
+        blas::gemv(blas::Op::N, m, n, 2.0, A.data.get(), m, x.data.get(), -1.0, y.data.get());
+        EXPECT_LT(max_diff(y, Ax * 2.0 - z), 1e-12);
+
+        // A + 3 z x^T, with x read as a row of a matrix
+        auto X = Matrix<double>::zeros(2, n);
+        for (int j = 0; j < n; j++) X[1 + 2 * j] = x[j];
+        auto B = A.clone();
+        blas::ger(m, n, 3.0, z.data.get(), 1, X.data.get() + 1, 2, B.data.get(), m);
+        EXPECT_LT(max_diff(B, A + z * x.as_rowvec() * 3.0), 1e-12);
+    }
+
+    // Repeated propagation of a distribution through a chain, without temporaries
+    auto P = Matrix<double>::from({0.7, 0.2, 0.1, 0.15, 0.5, 0.35, 0.05, 0.2, 0.75}, 3, 3, true);
+    MarkovChain mc (P);
+    auto pi = Matrix<double>::from({1, 0, 0}, 1, 3);
+    auto work = Matrix<double>(1, 3);
+    mc.propagate(pi, work, 100);
+    EXPECT_LT(max_diff(pi, mc.pow(100).get_row(1)), 1e-12);
+    EXPECT_LT(max_diff(pi, mc.stationary()), 1e-12);
+
+    auto one = Matrix<double>::from({0, 1, 0}, 1, 3);
+    mc.propagate(one);
+    EXPECT_LT(max_diff(one, P.get_row(2)), 1e-15);
+}
+
+TEST(Linalg, LU) {
+
+    const int n = 150;
+    auto A = Matrix<double>::rand(n, n);
+    auto B = Matrix<double>::rand(n, 3);
+
+    linalg::LU lu (A, 16);
+    EXPECT_FALSE(lu.is_singular());
+    EXPECT_LT(max_diff(lu.P() * A, lu.L() * lu.U()), 1e-9);
+
+    auto X = lu.solve(B);
+    EXPECT_LT(max_diff(A * X, B), 1e-8);
+    EXPECT_LT(max_diff(A.t() * lu.solve_transpose(B), B), 1e-8);
+    EXPECT_LT(max_diff(A * lu.inv(), Matrix<double>::id(n)), 1e-8);
+
+    // det of a permuted triangular matrix
+    auto T = Matrix<double>::from({0, 2, 1, 3, 0, 5, 0, 0, 4}, 3, 3, true);
+    EXPECT_NEAR(linalg::det(T), -24, 1e-12);
+
+    // The Hilbert matrix is notoriously ill conditioned, the identity is not
+    EXPECT_LT(linalg::LU(Matrix<double>::hilbert(10)).rcond(), 1e-12);
+    EXPECT_NEAR(linalg::LU(Matrix<double>::id(10)).rcond(), 1, 1e-12);
+
+    // Singular matrices are reported rather than divided by zero
+    auto S = Matrix<double>::from({1, 2, 2, 4}, 2, 2, true);
+    linalg::LU slu (S);
+    EXPECT_TRUE(slu.is_singular());
+    EXPECT_EQ(slu.det(), 0);
+    EXPECT_THROW(slu.solve(B), std::runtime_error);
+
+    auto [L, U] = A.lu();
+    EXPECT_LT(max_diff(L * U, A), 1e-6);
+}
+
+TEST(Linalg, Cholesky) {
+
+    const int n = 300;
+    auto X = Matrix<double>::rand(n, n);
+    auto K = X.t() * X + Matrix<double>::id(n) * n;
+    auto B = Matrix<double>::rand(n, 4);
+
+    linalg::Cholesky ch (K, 32);
+    ASSERT_TRUE(ch.is_spd());
+    EXPECT_LT(max_diff(ch.L() * ch.L().t(), K), 1e-8);
+    EXPECT_LT(max_diff(K * ch.solve(B), B), 1e-8);
+    auto K5 = Matrix<double>::hilbert(5) + Matrix<double>::id(5);
+    EXPECT_NEAR(linalg::Cholesky(K5).det(), linalg::det(K5), 1e-10);
+    EXPECT_NEAR(linalg::Cholesky(K5).logdet(), std::log(linalg::det(K5)), 1e-10);
+
+    EXPECT_LT(max_diff(chol(K), ch.L()), 1e-10);
+    EXPECT_LT(max_diff(chol_gaxpy(K), ch.L()), 1e-10);
+
+    // Forward and back substitution with several right hand sides
+    auto L = ch.L();
+    EXPECT_LT(max_diff(L * linalg::forward_sub(L, B), B), 1e-10);
+    EXPECT_LT(max_diff(L.t() * linalg::back_sub(L.t(), B), B), 1e-10);
+
+    // Indefinite: the failing column is reported
+    auto S = Matrix<double>::from({4, 2, 0, 2, 1, 0, 0, 0, 1}, 3, 3, true);
+    linalg::Cholesky bad (S);
+    EXPECT_FALSE(bad.is_spd());
+    EXPECT_EQ(bad.info(), 2);
+    EXPECT_THROW(bad.solve(B), std::runtime_error);
+}
+
+TEST(Linalg, QR) {
+
+    const int m = 120, n = 45;
+    auto A = Matrix<double>::rand(m, n);
+    auto B = Matrix<double>::rand(m, 2);
+
+    linalg::QR qr (A, 8);
+    auto Q = qr.Q();
+    auto R = qr.R();
+    EXPECT_EQ(Q.nrow(), m);
+    EXPECT_EQ(Q.ncol(), n);
+    EXPECT_LT(max_diff(Q * R, A), 1e-10);
+    EXPECT_LT(max_diff(Q.t() * Q, Matrix<double>::id(n)), 1e-12);
+    EXPECT_EQ(R(3, 2), 0);
+
+    auto Qf = qr.Q(true);
+    EXPECT_LT(max_diff(Qf.t() * Qf, Matrix<double>::id(m)), 1e-12);
+    EXPECT_LT(max_diff(qr.apply_qt(B), Qf.t() * B), 1e-10);
+    EXPECT_LT(max_diff(qr.apply_q(qr.apply_qt(B)), B), 1e-10);
+
+    // Least squares: the residual is orthogonal to the range of A
+    auto X = linalg::lstsq(A, B);
+    EXPECT_LT((A.t() * (A * X - B)).abs().max(), 1e-9);
+
+    // Minimum norm solution of an underdetermined system lies in the row space
+    auto At = A.t();
+    auto b = Matrix<double>::rand(n, 1);
+    auto x = linalg::lstsq(At, b);
+    EXPECT_LT(max_diff(At * x, b), 1e-10);
+    EXPECT_LT(max_diff(A * linalg::lstsq(A, x), x), 1e-9);
+}
+
+TEST(Linalg, TSQR) {
+
+    const int m = 4000, n = 6;
+    auto A = Matrix<double>::rand(m, n);
+    auto b = Matrix<double>::rand(m, 1);
+
+    linalg::TSQR ts (A, 4);
+    EXPECT_EQ(ts.blocks(), 4);
+
+    auto R = ts.R();
+    EXPECT_LT(max_diff(R.t() * R, A.t() * A), 1e-6);
+    EXPECT_LT(max_diff(ts.Q() * R, A), 1e-10);
+    EXPECT_LT(max_diff(ts.solve(b), linalg::QR(A).solve(b)), 1e-10);
+}
+
+TEST(Linalg, SymmetricEigen) {
+
+    const int n = 80;
+    auto X = Matrix<double>::rand(n, n);
+    auto A = X + X.t();
+
+    auto [values, V] = linalg::eigh(A);
+    EXPECT_EQ(values.size(), n);
+    for (int i = 1; i < n; i++) EXPECT_LE(values[i - 1], values[i]);
+    EXPECT_LT(max_diff(V.t() * V, Matrix<double>::id(n)), 1e-10);
+
+    // A V = V diag(values)
+    auto AV = A * V;
+    double err = 0;
+    for (int j = 1; j <= n; j++) {
+        for (int i = 1; i <= n; i++) err = std::max(err, std::abs(AV(i, j) - V(i, j) * values(j)));
+    }
+    EXPECT_LT(err, 1e-9);
+
+    EXPECT_LT(max_diff(linalg::eigvalsh(A), values), 1e-9);
+
+    // A few of the largest pairs only
+    auto top = linalg::eigh(A, n - 2, n);
+    EXPECT_EQ(top.vectors.ncol(), 3);
+    for (int j = 1; j <= 3; j++) {
+        EXPECT_NEAR(top.values(j), values(n - 3 + j), 1e-9);
+        auto v = top.vectors.get_col(j);
+        EXPECT_LT(max_diff(A * v, v * top.values(j)), 1e-8);
+    }
+
+    // The first shift lands exactly on an eigenvalue: the offset is widened, never the start vector returned
+    auto D = Matrix<double>::from({1 + 1e-10, 0, 0, 0, 2, 1, 0, 0, 5}, 3, 3, true);
+    auto e1 = linalg::eigvec(D, 1.0);
+    EXPECT_LT(max_diff(D * e1, e1 * (1 + 1e-10)), 1e-8);
+    EXPECT_NEAR(std::abs(e1(1)), 1, 1e-8);
+
+    // 1 x 1: a single eigenpair, no tridiagonal solve beyond the first row
+    auto one = linalg::eigh(Matrix<double>::from({3.0}, 1, 1), 1, 1);
+    EXPECT_NEAR(one.values(1), 3, 1e-14);
+    EXPECT_NEAR(std::abs(one.vectors(1, 1)), 1, 1e-14);
+}
+
+TEST(Linalg, GeneralEigen) {
+
+    // Rotation by 90 degrees scaled by 2, plus a real eigenvalue 3
+    auto A = Matrix<double>::from({0, -2, 0, 2, 0, 0, 0, 0, 3}, 3, 3, true);
+    auto P = Matrix<double>::rand(3, 3) + Matrix<double>::id(3) * 3;
+    auto [re, im] = linalg::eig(P * A * linalg::inv(P));
+
+    EXPECT_NEAR(re(1), 3, 1e-10);
+    EXPECT_NEAR(im(1), 0, 1e-10);
+    EXPECT_NEAR(re(2), 0, 1e-10);
+    EXPECT_NEAR(std::abs(im(2)), 2, 1e-10);
+    EXPECT_NEAR(im(2), -im(3), 1e-12);
+
+    // Stationary distribution of an irreducible chain
+    auto T = Matrix<double>::from({0.5, 0.5, 0.0,
+                                   0.2, 0.5, 0.3,
+                                   0.0, 0.4, 0.6}, 3, 3, true);
+    MarkovChain mc (T);
+    auto pi = mc.stationary();
+    EXPECT_NEAR(pi.sum(), 1, 1e-12);
+    EXPECT_LT(max_diff(pi * T, pi), 1e-10);
+    EXPECT_LT(max_diff(pi, mc.pow(200).get_row(1)), 1e-10);
+    EXPECT_NEAR(mc.eigenvalues().real(1), 1, 1e-12);
+}
+
+// 5-point Laplacian on a k x k grid, with a first order term when c != 0
+static linalg::SparseMatrix<double> poisson2d(std::size_t k, double c = 0) {
+    std::vector<linalg::SparseMatrix<double>::triplet> t;
+    auto idx = [k] (std::size_t i, std::size_t j) { return i * k + j + 1; };
+    for (std::size_t i = 0; i < k; i++) {
+        for (std::size_t j = 0; j < k; j++) {
+            t.emplace_back(idx(i, j), idx(i, j), 4.0);
+            if (i > 0)     t.emplace_back(idx(i, j), idx(i - 1, j), -1.0 - c);
+            if (i + 1 < k) t.emplace_back(idx(i, j), idx(i + 1, j), -1.0 + c);
+            if (j > 0)     t.emplace_back(idx(i, j), idx(i, j - 1), -1.0);
+            if (j + 1 < k) t.emplace_back(idx(i, j), idx(i, j + 1), -1.0);
+        }
+    }
+    return linalg::SparseMatrix<double>(k * k, k * k, std::move(t));
+}
+
+TEST(Linalg, Krylov) {
+
+    const std::size_t k = 30, n = k * k;
+    auto A = poisson2d(k);
+    EXPECT_EQ(A.nnz(), 5 * n - 4 * k);
+    EXPECT_EQ(A(1, 1), 4);
+    EXPECT_EQ(A(1, 3), 0);
+
+    auto xs = Matrix<double>::rand(n, 1);
+    auto b = A * xs;
+
+    // Unpreconditioned and Jacobi/ILU(0) preconditioned CG agree with the true solution
+    Matrix<double> x;
+    auto plain = linalg::cg(A, b, x);
+    EXPECT_TRUE(plain.converged);
+    EXPECT_LT(max_diff(x, xs), 1e-7);
+
+    x = Matrix<double>();
+    auto ilu = linalg::cg(A, b, x, linalg::ILU0<double>(A));
+    EXPECT_TRUE(ilu.converged);
+    EXPECT_LT(ilu.iterations, plain.iterations);
+    EXPECT_LT(max_diff(x, xs), 1e-7);
+
+    x = Matrix<double>();
+    EXPECT_TRUE(linalg::cg(A, b, x, linalg::Jacobi<double>(A)).converged);
+    EXPECT_LT(max_diff(x, xs), 1e-7);
+
+    // Nonsymmetric systems
+    auto C = poisson2d(k, 0.4);
+    auto bc = C * xs;
+    x = Matrix<double>();
+    EXPECT_TRUE(linalg::bicgstab(C, bc, x, linalg::ILU0<double>(C)).converged);
+    EXPECT_LT(max_diff(x, xs), 1e-7);
+
+    x = Matrix<double>();
+    EXPECT_TRUE(linalg::gmres(C, bc, x, linalg::ILU0<double>(C), {.restart = 20}).converged);
+    EXPECT_LT(max_diff(x, xs), 1e-7);
+
+    // Dense matrices and lambdas are operators too
+    auto D = C.to_matrix();
+    x = Matrix<double>();
+    EXPECT_TRUE(linalg::gmres(D, bc, x).converged);
+    EXPECT_LT(max_diff(x, xs), 1e-7);
+
+    auto shifted = linalg::make_operator(n, [&A] (const double *u, double *v) {
+        A.apply(u, v);
+        for (std::size_t i = 0; i < 900; i++) v[i] += u[i];
+    });
+    auto bs = b + xs;
+    x = Matrix<double>();
+    EXPECT_TRUE(linalg::cg(shifted, bs, x).converged);
+    EXPECT_LT(max_diff(x, xs), 1e-7);
+}
+
+TEST(Linalg, KrylovEigen) {
+
+    // Symmetric: extreme eigenvalues of the Laplacian, both as CSR and as a Kronecker sum
+    const std::size_t k = 20;
+    auto A = poisson2d(k);
+    auto exact = linalg::eigvalsh(A.to_matrix());
+
+    auto top = linalg::lanczos(A, 3);
+    auto bottom = linalg::lanczos(A, 2, linalg::Which::Smallest);
+    for (int j = 1; j <= 3; j++) EXPECT_NEAR(top.values(j), exact(k * k - 3 + j), 1e-8);
+    for (int j = 1; j <= 2; j++) EXPECT_NEAR(bottom.values(j), exact(j), 1e-8);
+
+    auto v = top.vectors.get_col(3);
+    EXPECT_LT(max_diff(A * v, v * top.values(3)), 1e-6);
+
+    auto T = Matrix<double>::zeros(k, k);
+    for (std::size_t i = 1; i <= k; i++) {
+        T(i, i) = 2;
+        if (i > 1) T(i, i - 1) = -1;
+        if (i < k) T(i, i + 1) = -1;
+    }
+    auto L = linalg::kron_sum(T, T);
+    EXPECT_NEAR(linalg::lanczos(L, 1).values(1), exact(k * k), 1e-8);
+
+    // General: dominant eigenvalues match the dense solver
+    auto G = Matrix<double>::rand(200, 200);
+    auto dense = linalg::eig(G);
+    auto ritz = linalg::arnoldi(G, 1);
+    EXPECT_TRUE(ritz.converged);
+    EXPECT_NEAR(ritz.real(1), dense.real(1), 1e-8);
+    auto u = ritz.vectors.get_col(1);
+    EXPECT_LT(max_diff(G * u, u * ritz.real(1)), 1e-6);
+
+    // A dominant complex pair found with a small subspace, over several restarts
+    auto P = Matrix<double>::rand(200, 200, -1, 1) * 0.05;
+    P(1, 1) += 3;
+    P(2, 2) += 3;
+    P(1, 2) -= 1;
+    P(2, 1) += 1;
+    P(3, 3) += 2.5;
+    auto exact_p = linalg::eig(P);
+    auto pair = linalg::arnoldi(P, 3, {.subspace = 12, .max_restarts = 200});
+    EXPECT_TRUE(pair.converged);
+    for (int j = 1; j <= 3; j++) {
+        EXPECT_NEAR(pair.real(j), exact_p.real(j), 1e-8);
+        EXPECT_NEAR(pair.imag(j), exact_p.imag(j), 1e-8);
+    }
+    EXPECT_GT(pair.imag(1), 0.5);
+    auto u3 = pair.vectors.get_col(3);
+    EXPECT_LT(max_diff(P * u3, u3 * pair.real(3)), 1e-6);
+}
+
+TEST(Linalg, SVD) {
+
+    // Tall and wide matrices are reconstructed from orthonormal factors
+    for (auto [m, n] : {std::pair{60, 25}, std::pair{25, 60}}) {
+        auto A = Matrix<double>::rand(m, n, -1, 1);
+        auto [U, S, Vt] = linalg::svd(A);
+        const int r = std::min(m, n);
+        EXPECT_LT(max_diff(U.t() * U, Matrix<double>::id(r)), 1e-12);
+        EXPECT_LT(max_diff(Vt * Vt.t(), Matrix<double>::id(r)), 1e-12);
+        for (int i = 1; i < r; i++) EXPECT_GE(S(i), S(i + 1));
+
+        auto US = U.clone();
+        for (int j = 1; j <= r; j++) for (int i = 1; i <= m; i++) US(i, j) *= S(j);
+        EXPECT_LT(max_diff(US * Vt, A), 1e-12);
+
+        auto gram = linalg::eigvalsh(A.t() * A);
+        EXPECT_NEAR(S(1) * S(1), gram(n), 1e-10);
+    }
+
+    EXPECT_NEAR(linalg::svdvals(Matrix<double>::from({3, 0, 0, -4}, 2, 2, true))(1), 4, 1e-14);
+}
+
+TEST(Linalg, RandomizedSVD) {
+
+    // Rank 8 signal with a geometric spectrum plus small noise
+    const int m = 1500, n = 200, r = 8;
+    auto L = linalg::svd(Matrix<double>::rand(m, r, -1, 1)).U;
+    auto R = linalg::svd(Matrix<double>::rand(n, r, -1, 1)).U;
+    for (int j = 1; j <= r; j++) for (int i = 1; i <= m; i++) L(i, j) *= 100.0 / (1 << j);
+    auto A = L * R.t() + Matrix<double>::rand(m, n, -1e-6, 1e-6);
+    auto exact = linalg::svdvals(A);
+
+    auto [U, S, Vt] = linalg::rsvd(A, 5);
+    EXPECT_EQ(U.ncol(), 5);
+    EXPECT_EQ(Vt.nrow(), 5);
+    for (int j = 1; j <= 5; j++) EXPECT_NEAR(S(j), exact(j), 1e-8 * exact(1));
+    EXPECT_LT(max_diff(U.t() * U, Matrix<double>::id(5)), 1e-12);
+
+    // Single pass over column-major blocks and over a row-major buffer
+    linalg::StreamingSVD<double> blocks (n, 5), raw (n, 5);
+    auto At = A.t();
+    for (int i0 = 0; i0 < m; i0 += 400) {
+        const int rows = std::min(400, m - i0);
+        auto block = Matrix<double>(rows, n);
+        for (int j = 0; j < n; j++) for (int i = 0; i < rows; i++) block[i + j * rows] = A[i0 + i + j * m];
+        blocks.push(block);
+        raw.push(At.data.get() + i0 * n, rows);
+    }
+    EXPECT_EQ(raw.rows(), m);
+
+    for (auto* sketch : {&blocks, &raw}) {
+        auto f = sketch->finish();
+        for (int j = 1; j <= 5; j++) EXPECT_NEAR(f.S(j), exact(j), 1e-5 * exact(1));
+        EXPECT_LT(max_diff(f.U.t() * f.U, Matrix<double>::id(5)), 1e-10);
+        EXPECT_LT(std::abs(std::abs((f.Vt.get_row(1) * Vt.get_row(1).t())(1)) - 1), 1e-8);
+    }
+}
+
+TEST(Linalg, PowerAndExpm) {
+
+    // Binary exponentiation agrees with repeated products
+    auto A = Matrix<double>::rand(20, 20, -0.3, 0.3);
+    auto P = Matrix<double>::id(20);
+    for (int k = 0; k <= 13; k++) {
+        EXPECT_LT(max_diff(A ^ k, P), 1e-12);
+        P = P * A;
+    }
+
+    // Closed forms, through every Padé degree and through scaling and squaring
+    auto N = Matrix<double>::from({0, 1, 0, 0}, 2, 2, true);
+    EXPECT_LT(max_diff(linalg::expm(N), Matrix<double>::from({1, 1, 0, 1}, 2, 2, true)), 1e-15);
+
+    for (double theta : {0.01, 0.2, 0.9, 2.0, 5.0, 40.0}) {
+        auto R = Matrix<double>::from({0, -theta, theta, 0}, 2, 2, true);
+        auto E = Matrix<double>::from({std::cos(theta), -std::sin(theta), std::sin(theta), std::cos(theta)}, 2, 2, true);
+        EXPECT_LT(max_diff(linalg::expm(R), E), 1e-13 * std::max(1.0, theta));
+    }
+
+    auto B = Matrix<double>::rand(30, 30, -1, 1);
+    EXPECT_LT(max_diff(linalg::expm(B) * linalg::expm(B * -1.0), Matrix<double>::id(30)), 1e-10);
+
+    // A continuous-time chain: rows of exp(Q t) are distributions, and exp(Q (s + t)) = exp(Q s) exp(Q t)
+    auto Q = Matrix<double>::from({-3, 2, 1, 1, -1, 0, 0.5, 0.5, -1}, 3, 3, true);
+    auto T1 = MarkovChain::continuous(Q, 0.7).pow(1);
+    auto T2 = linalg::expm(Q * 1.4);
+    for (int i = 1; i <= 3; i++) EXPECT_NEAR(T1.get_row(i).sum(), 1, 1e-14);
+    EXPECT_LT(max_diff(T1 * T1, T2), 1e-14);
+}
+
+TEST(Linalg, Covariance) {
+
+    const int n = 5000, p = 37;
+    auto X = Matrix<double>::rand(n, p, -1, 1) + 3.0;
+    for (int i = 1; i <= n; i++) X(i, 2) = 2 * X(i, 1) - 1;       // perfectly correlated pair
+    for (int i = 1; i <= n; i++) X(i, 3) = -X(i, 1);
+
+    auto Xc = X.clone();
+    for (int j = 1; j <= p; j++) {
+        double mu = 0;
+        for (int i = 1; i <= n; i++) mu += X(i, j);
+        for (int i = 1; i <= n; i++) Xc(i, j) -= mu / n;
+    }
+    auto C = Xc.t() * Xc / (n - 1.0);
+
+    // Both the serial path and the threaded one that splits the rows
+    for (int threads : {1, 3}) {
+#ifdef _OPENMP
+        const int saved = omp_get_max_threads();
+        omp_set_num_threads(threads);
+#endif
+        EXPECT_LT(max_diff(linalg::gram(X), X.t() * X), 1e-9);
+        EXPECT_LT(max_diff(linalg::cov(X), C), 1e-12);
+
+        auto R = linalg::cor(X);
+        EXPECT_NEAR(R(1, 2), 1, 1e-12);
+        EXPECT_NEAR(R(3, 1), -1, 1e-12);
+        for (int j = 1; j <= p; j++) EXPECT_EQ(R(j, j), 1);
+        EXPECT_NEAR(R(5, 4), C(5, 4) / std::sqrt(C(4, 4) * C(5, 5)), 1e-12);
+        EXPECT_EQ(R(4, 5), R(5, 4));
+#ifdef _OPENMP
+        omp_set_num_threads(saved);
+#endif
+    }
+
+    // SYRK that splits a long k across threads
+    auto A = Matrix<double>::rand(8, 4000, -1, 1);
+    auto G = Matrix<double>::zeros(8, 8);
+#ifdef _OPENMP
+    const int saved = omp_get_max_threads();
+    omp_set_num_threads(4);
+#endif
+    blas::syrk(blas::Uplo::Upper, blas::Op::N, 8, 4000, 2.0, A.data.get(), 8, 0.0, G.data.get(), 8);
+#ifdef _OPENMP
+    omp_set_num_threads(saved);
+#endif
+    auto AAt = A * A.t();
+    for (int j = 1; j <= 8; j++) for (int i = 1; i <= j; i++) EXPECT_NEAR(G(i, j), 2 * AAt(i, j), 1e-10);
+    EXPECT_EQ(G(8, 1), 0);
+}
+
+TEST(Linalg, Strassen) {
+
+    // Odd sizes exercise the peeling at every level
+    for (auto [m, n, k] : {std::tuple{64, 64, 64}, std::tuple{101, 77, 93}, std::tuple{130, 65, 257}}) {
+        auto A = Matrix<double>::rand(m, k, -1, 1);
+        auto B = Matrix<double>::rand(k, n, -1, 1);
+        auto C = Matrix<double>(m, n);
+        blas::strassen<double>(m, n, k, A.data.get(), m, B.data.get(), k, C.data.get(), m, 16);
+        EXPECT_LT(max_diff(C, A * B), 1e-11);
+    }
+
+    // Through operator* and operator^ once enabled
+    auto& config = blas::strassen_config();
+    const auto saved = config;
+    config.enabled = true;
+    config.crossover = 32;
+
+    auto A = Matrix<double>::rand(150, 150, -0.1, 0.1);
+    auto B = Matrix<double>::rand(150, 150, -0.1, 0.1);
+    auto C = A * B;
+    config.enabled = false;
+    EXPECT_LT(max_diff(C, A * B), 1e-13);
+
+    config.enabled = true;
+    auto A5 = A ^ 5;
+    config = saved;
+    EXPECT_LT(max_diff(A5, A * A * A * A * A), 1e-15);
+}
+
+TEST(Linalg, ProductChain) {
+
+    auto A = Matrix<double>::rand(300, 200, -1, 1);
+    auto B = Matrix<double>::rand(200, 250, -1, 1);
+    auto C = Matrix<double>::rand(250, 300, -1, 1);
+    auto v = Matrix<double>::rand(300, 1, -1, 1);
+    auto expected = ((A * B) * C) * v;
+
+    // Right to left is chosen for a trailing vector: three matrix-vector products
+    auto chain = linalg::chain(A) * B * C * v;
+    EXPECT_EQ(chain.flops(), 2.0 * (250 * 300 + 200 * 250 + 300 * 200));
+    Matrix<double> y = chain;
+    EXPECT_LT(max_diff(y, expected), 1e-9);
+    EXPECT_LT(max_diff(linalg::multi_dot(A, B, C, v), expected), 1e-9);
+
+    // Leading row vector, and lazy transposes
+    auto w = Matrix<double>::rand(1, 300, -1, 1);
+    EXPECT_LT(max_diff(linalg::multi_dot(w, A, B), (w * A) * B), 1e-10);
+    EXPECT_LT(max_diff(linalg::multi_dot(linalg::trans(B), linalg::trans(A), v), (A * B).t() * v), 1e-10);
+
+    // Gram matrices through SYRK, with a lazy or a materialized transpose
+    auto X = Matrix<double>::rand(500, 40, -1, 1);
+    auto G = X.t() * X;
+    EXPECT_LT(max_diff(linalg::multi_dot(linalg::trans(X), X), G), 1e-11);
+    EXPECT_LT(max_diff(linalg::multi_dot(X.t(), X), G), 1e-11);
+    EXPECT_LT(max_diff(linalg::multi_dot(X, linalg::trans(X)), X * X.t()), 1e-11);
+
+    EXPECT_EQ(max_diff(linalg::multi_dot(A), A), 0);
+    EXPECT_THROW(linalg::multi_dot(A, A), std::runtime_error);
+}
+
+TEST(Linalg, Batched) {
+
+    constexpr std::size_t count = 1000 + 3;   // not a multiple of the chunk size
+    linalg::Batch<double, 4> A (count), S (count);
+    linalg::Batch<double, 4, 2> B (count);
+    for (std::size_t b = 0; b < count; b++) {
+        auto a = Matrix<double>::rand(4, 4, -1, 1);
+        A.set(b, a);
+        S.set(b, a.t() * a + Matrix<double>::id(4));
+        B.set(b, Matrix<double>::rand(4, 2, -1, 1));
+    }
+
+    auto C = A * B;
+    auto X = linalg::solve(A, B);
+    auto Ai = linalg::inv(A);
+    auto d = linalg::det(A);
+    auto L = linalg::cholesky(S);
+    auto Y = linalg::cholesky_solve(S, B);
+
+    for (std::size_t b : {std::size_t(0), std::size_t(63), std::size_t(64), std::size_t(517), count - 1}) {
+        auto a = A.get(b), s = S.get(b), rhs = B.get(b);
+        EXPECT_LT(max_diff(C.get(b), a * rhs), 1e-14);
+        EXPECT_LT(max_diff(a * X.get(b), rhs), 1e-9);
+        EXPECT_LT(max_diff(a * Ai.get(b), Matrix<double>::id(4)), 1e-9);
+        EXPECT_NEAR(d[b], linalg::LU<double>(a).det(), 1e-12);
+        EXPECT_LT(max_diff(L.get(b), linalg::cholesky(s).L()), 1e-12);
+        EXPECT_LT(max_diff(s * Y.get(b), rhs), 1e-10);
+    }
+
+    // Permutation matrix: pivoting is required and the determinant is -1
+    linalg::Batch<double, 3> P (2);
+    P.set(0, Matrix<double>::from({0, 1, 0, 1, 0, 0, 0, 0, 1}, 3, 3));
+    P.set(1, Matrix<double>::id(3));
+    auto dp = linalg::det(P);
+    EXPECT_EQ(dp[0], -1);
+    EXPECT_EQ(dp[1], 1);
+    EXPECT_EQ(max_diff(linalg::inv(P).get(0), P.get(0)), 0);
+
+    EXPECT_THROW(A.set(0, Matrix<double>::id(3)), std::runtime_error);
+}
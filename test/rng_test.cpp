@@ -0,0 +1,604 @@
+#include "ejovotest.hpp"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+using namespace ejovo;
+
+static bool same_state(const rng::Xoshiro& a, const rng::Xoshiro& b) {
+    for (int i = 0; i < 4; i++) if (a.state[i] != b.state[i]) return false;
+    return true;
+}
+
+TEST(Rng, JumpAndStreams) {
+
+    rng::Xoshiro g (42), h (42);
+    EXPECT_TRUE(same_state(g, h));
+    EXPECT_NE(g.state[0], rng::Xoshiro(43).state[0]);
+
+    // A jump is a polynomial in the transition, so it commutes with next()
+    auto a = rng::Xoshiro(g).jump();
+    a.next();
+    g.next();
+    g.jump();
+    EXPECT_TRUE(same_state(a, g));
+    EXPECT_FALSE(same_state(rng::Xoshiro(h).jump(), rng::Xoshiro(h).long_jump()));
+
+    // Stream i is the seed jumped i times
+    auto s = rng::streams(42, 4);
+    ASSERT_EQ(s.size(), 4);
+    EXPECT_TRUE(same_state(s[0], h));
+    EXPECT_TRUE(same_state(s[2], rng::Xoshiro(h).jump().jump()));
+
+    // The master moves on, so a second split does not reuse the streams
+    rng::Xoshiro master (7);
+    auto first = rng::split(master, 2), second = rng::split(master, 2);
+    EXPECT_FALSE(same_state(first[0], second[0]));
+    EXPECT_TRUE(same_state(second[0], rng::Xoshiro(7).long_jump()));
+}
+
+TEST(Rng, ReproducibleParallelUniforms) {
+
+    set_seed(2024);
+    auto x = runif_omp(10001, -1, 1, 3);
+    auto y = runif_omp(10001, -1, 1, 3);
+    set_seed(2024);
+    auto z = runif_omp(10001, -1, 1, 3);
+
+    EXPECT_TRUE(x.all([](double d) { return d >= -1 && d <= 1; }));
+    EXPECT_NEAR(x.mean(), 0, 0.05);
+    for (std::size_t i = 0; i < x.size(); i++) ASSERT_EQ(x[i], z[i]);
+    EXPECT_NE(x[0], y[0]);
+
+    // The thread count does not change the draws
+    set_seed(2024);
+    auto w = runif_omp(10001, -1, 1, 1);
+    for (std::size_t i = 0; i < x.size(); i++) ASSERT_EQ(x[i], w[i]);
+}
+
+TEST(Rng, ParallelSampling) {
+
+    const omp::SampleOptions one {.np = 1, .grain = 1000}, four {.np = 4, .grain = 1000};
+
+    // Chunk c comes from the master long-jumped c times
+    set_seed(5);
+    auto w = omp::parallel_sample<double>(2500, [] (rng::Xoshiro& g) { return g.next_double(); }, one);
+    set_seed(5);
+    rng::Xoshiro chunk = rng::engine();
+    chunk.long_jump().long_jump();
+    EXPECT_EQ(w[2000], chunk.next_double());
+
+    set_seed(11);
+    auto a = rnorm_omp(20000, 1, 2, one);
+    auto b = rbinom_omp(20000, 40, 0.25, one);
+    auto c = rcat_omp(20000, ejovo::vec({0.5, 0.0, 0.5}), one);
+    auto h = rhyper_omp(20000, 20, 100, 30, one);
+    set_seed(11);
+    auto a4 = rnorm_omp(20000, 1, 2, four);
+    auto b4 = rbinom_omp(20000, 40, 0.25, four);
+    auto c4 = rcat_omp(20000, ejovo::vec({0.5, 0.0, 0.5}), four);
+    auto h4 = rhyper_omp(20000, 20, 100, 30, four);
+
+    for (std::size_t i = 0; i < a.size(); i++) {
+        ASSERT_EQ(a[i], a4[i]);
+        ASSERT_EQ(b[i], b4[i]);
+        ASSERT_EQ(c[i], c4[i]);
+        ASSERT_EQ(h[i], h4[i]);
+    }
+
+    EXPECT_NEAR(a.mean(), 1, 0.05);
+    EXPECT_NEAR(b.mean(), 10, 0.1);
+    EXPECT_NEAR(h.mean(), 6, 0.1);
+    EXPECT_EQ(c.count([] (int k) { return k == 2; }), 0);
+    EXPECT_NEAR(rexp_omp(20000, 4, four).mean(), 0.25, 0.01);
+    EXPECT_NEAR(rbernoulli_omp(20000, 0.3, four).count([] (bool x) { return x; }) / 20000.0, 0.3, 0.02);
+    EXPECT_THROW(rnorm_omp(10, 0, 1, {.grain = 0}), std::runtime_error);
+}
+
+TEST(Rng, Philox) {
+
+    using rng::Philox;
+
+    // Known answers of the Random123 reference implementation
+    EXPECT_EQ(Philox::block({0, 0, 0, 0}, {0, 0}), (Philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (Philox::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(Philox::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (Philox::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+
+    // Sequential, random access and blocked generation agree, from any offset
+    Philox g (12345, 7);
+    std::vector<uint64_t> seq (301), blk (301);
+    for (auto& x : seq) x = g.next();
+    g.generate(0, 301, blk.data());
+    EXPECT_EQ(seq, blk);
+    EXPECT_EQ(g[200], seq[200]);
+    g.generate(99, 150, blk.data());
+    EXPECT_EQ(blk[0], seq[99]);
+    EXPECT_EQ(blk[149], seq[248]);
+    EXPECT_EQ(g.seek(201).next(), seq[201]);
+    EXPECT_NE(Philox(12345, 8)[0], seq[0]);
+
+    // Parallel fills do not depend on the thread count
+    const int threads = omp_get_max_threads();
+    Matrix<double> x (1, 20001), y (1, 20001);
+    omp_set_num_threads(1);
+    Philox(1).discard(3).fill_unif(x.data.get(), x.size(), -2, 2);
+    omp_set_num_threads(4);
+    Philox(1).discard(3).fill_unif(y.data.get(), y.size(), -2, 2);
+    omp_set_num_threads(threads);
+    for (std::size_t i = 0; i < x.size(); i++) ASSERT_EQ(x[i], y[i]);
+    Philox h (1);
+    h.discard(3);
+    EXPECT_EQ(x[10000], (h.discard(10000), h.unifd(-2, 2)));
+    EXPECT_EQ(h.position(), 10004);
+
+    Matrix<double> z (1, 100001);
+    Philox(9).fill_norm(z.data.get(), z.size(), 1, 2);
+    EXPECT_NEAR(z.mean(), 1, 0.03);
+    EXPECT_NEAR((z - z.mean()).map([](double d) { return d * d; }).mean(), 4, 0.1);
+}
+
+TEST(Rng, SimdLanes) {
+
+    // Lane l reproduces the scalar generator jumped l times
+    rng::XoshiroSimd<8> v (99);
+    std::vector<uint64_t> bits (8 * 5 + 3);
+    v.fill(bits.data(), bits.size());
+    rng::Xoshiro g (99);
+    for (std::size_t l = 0; l < 8; l++) {
+        auto lane = g;
+        for (std::size_t k = 0; 8 * k + l < bits.size(); k++) ASSERT_EQ(bits[8 * k + l], lane.next());
+        g.jump();
+    }
+
+    // The partial last block still advanced every lane: 6 steps each
+    rng::Xoshiro first (99);
+    for (int k = 0; k < 6; k++) first.next();
+    EXPECT_TRUE(same_state(v.lane(0), first));
+
+    set_seed(3);
+    auto u = runif(100001, 2, 5), n = rnorm(100001, -1, 3), e = rexp(100001, 4);
+    EXPECT_TRUE(u.all([](double d) { return d >= 2 && d < 5; }));
+    EXPECT_NEAR(u.mean(), 3.5, 0.02);
+    EXPECT_NEAR(n.mean(), -1, 0.05);
+    EXPECT_NEAR((n - n.mean()).map([](double d) { return d * d; }).mean(), 9, 0.2);
+    EXPECT_TRUE(e.all([](double d) { return d >= 0; }));
+    EXPECT_NEAR(e.mean(), 0.25, 0.005);
+
+    set_seed(3);
+    auto w = runif(100001, 2, 5);
+    for (std::size_t i = 0; i < u.size(); i++) ASSERT_EQ(u[i], w[i]);
+}
+
+TEST(Rng, Ziggurat) {
+
+    // Tables against Marsaglia & Tsang's published base strip widths
+    EXPECT_NEAR(rng::detail::zig_normal.x[0], 3.910757959537090045, 1e-12);
+    EXPECT_NEAR(rng::detail::zig_exp.x[0], 8.697117470131049720, 1e-12);
+
+    // Empirical CDFs at a few points, including the tails beyond r, for the scalar and the bulk paths
+    const std::size_t N = 1000000;
+    rng::Xoshiro g (11);
+    rng::XoshiroSimd<> v (11);
+    std::vector<double> z (N), e (N);
+    for (std::size_t i = 0; i < N; i++) z[i] = g.norm();
+    for (std::size_t i = 0; i < N; i++) e[i] = g.exp(2);
+
+    auto check = [&] (const std::vector<double>& x, auto cdf, std::initializer_list<double> points) {
+        for (double q : points) {
+            const double p = cdf(q);
+            const double freq = double(std::count_if(x.begin(), x.end(), [q](double d) { return d <= q; })) / double(x.size());
+            EXPECT_NEAR(freq, p, 5 * std::sqrt(p * (1 - p) / double(x.size())) + 1e-6) << "at " << q;
+        }
+    };
+    auto Phi = [] (double q) { return 0.5 * std::erfc(-q / std::sqrt(2.0)); };
+    auto Exp2 = [] (double q) { return 1 - std::exp(-2 * q); };
+
+    check(z, Phi, {-3.8, -2, -0.5, 0, 0.3, 1, 2.5, 3.7});
+    check(e, Exp2, {0.01, 0.2, 0.5, 1, 2, 3.9});
+
+    v.fill_norm(z.data(), N, 0, 1);
+    v.fill_exp(e.data(), N, 2);
+    check(z, Phi, {-3.8, -2, -0.5, 0, 0.3, 1, 2.5, 3.7});
+    check(e, Exp2, {0.01, 0.2, 0.5, 1, 2, 3.9});
+}
+
+// Largest deviation between empirical frequencies and the pmf, in standard errors
+template <class Sample, class Pmf>
+static double max_z_score(Sample sample, Pmf pmf, int lo, int hi, std::size_t draws) {
+    std::vector<std::size_t> counts (hi - lo + 1, 0);
+    for (std::size_t i = 0; i < draws; i++) {
+        const auto x = sample();
+        if (x >= lo && x <= hi) counts[x - lo]++;
+    }
+    double worst = 0;
+    for (int k = lo; k <= hi; k++) {
+        const double p = pmf(k);
+        if (p < 1e-4) continue;
+        worst = std::max(worst, std::abs(double(counts[k - lo]) / draws - p) / std::sqrt(p * (1 - p) / draws));
+    }
+    return worst;
+}
+
+TEST(Rng, BinomialAndHypergeometric) {
+
+    rng::Xoshiro g (21);
+    const std::size_t draws = 400000;
+
+    auto dbinom_exact = [] (int n, double p) {
+        return [=] (int k) {
+            return std::exp(std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0)
+                            + k * std::log(p) + (n - k) * std::log1p(-p));
+        };
+    };
+
+    // inversion (n p <= 30), BTPE, and BTPE through the p > 1/2 reflection
+    EXPECT_LT(max_z_score([&] { return g.binom(40, 0.2); }, dbinom_exact(40, 0.2), 0, 40, draws), 5);
+    EXPECT_LT(max_z_score([&] { return g.binom(200, 0.35); }, dbinom_exact(200, 0.35), 0, 200, draws), 5);
+    EXPECT_LT(max_z_score([&] { return g.binom(1000, 0.93); }, dbinom_exact(1000, 0.93), 0, 1000, draws), 5);
+
+    // A million trials per sample: moments only
+    double mean = 0, sq = 0;
+    for (int i = 0; i < 100000; i++) {
+        const double x = g.binom(1000000, 0.3);
+        mean += x;
+        sq += x * x;
+    }
+    mean /= 100000;
+    EXPECT_NEAR(mean, 300000, 3);
+    EXPECT_NEAR(sq / 100000 - mean * mean, 210000, 210000 * 0.03);
+
+    EXPECT_EQ(g.binom(0, 0.5), 0);
+    EXPECT_EQ(g.binom(17, 0), 0);
+    EXPECT_EQ(g.binom(17, 1), 17);
+
+    // BTPE's squeeze uses the Stirling correction, whose leading term is 1 / (12 x)
+    for (double x : {10.0, 31.0, 250.0}) {
+        const double tail = std::lgamma(x) - ((x - 0.5) * std::log(x) - x + 0.5 * std::log(2 * M_PI));
+        EXPECT_NEAR(rng::detail::stirling_tail(x), tail, 1e-12);
+    }
+
+    auto dhyper_exact = [] (int ndraws, int N, int K) {
+        auto lchoose = [] (double n, double k) { return std::lgamma(n + 1) - std::lgamma(k + 1) - std::lgamma(n - k + 1); };
+        return [=] (int k) {
+            if (k > K || ndraws - k > N - K) return 0.0;
+            return std::exp(lchoose(K, k) + lchoose(N - K, ndraws - k) - lchoose(N, ndraws));
+        };
+    };
+
+    // HYP for small samples, HRUA* otherwise, with more good than bad items and more than half drawn
+    EXPECT_LT(max_z_score([&] { return g.hyper(8, 60, 25); }, dhyper_exact(8, 60, 25), 0, 8, draws), 5);
+    EXPECT_LT(max_z_score([&] { return g.hyper(50, 1000, 300); }, dhyper_exact(50, 1000, 300), 0, 50, draws), 5);
+    EXPECT_LT(max_z_score([&] { return g.hyper(700, 1000, 800); }, dhyper_exact(700, 1000, 800), 0, 700, draws), 5);
+
+    EXPECT_EQ(g.hyper(10, 10, 4), 4);
+    EXPECT_EQ(g.hyper(5, 20, 0), 0);
+}
+
+TEST(Rng, AliasTable) {
+
+    // Unnormalized weights with a zero: outcome 3 never comes up
+    rng::AliasTable table (std::vector<double>{4, 1, 0, 2.5, 0.5});
+    EXPECT_EQ(table.size(), 5);
+    rng::Xoshiro g (5);
+    const std::vector<double> p {0.5, 0.125, 0, 0.3125, 0.0625};
+    const double z = max_z_score([&] { return int(table(g)) - 1; }, [&] (int k) { return p[k]; }, 0, 4, 400000);
+    EXPECT_LT(z, 5);
+    for (int i = 0; i < 10000; i++) ASSERT_NE(table(g), 3);
+
+    auto x = rcat(100000, vec({0.7, 0.2, 0.1}));
+    EXPECT_NEAR(double(x.count([](int c) { return c == 1; })) / x.size(), 0.7, 0.01);
+    EXPECT_TRUE(x.all([](int c) { return c >= 1 && c <= 3; }));
+
+    EXPECT_THROW(rng::AliasTable(std::vector<double>{0, 0}), std::runtime_error);
+    EXPECT_THROW(rng::AliasTable(std::vector<double>{1, -1}), std::runtime_error);
+
+    // Visit frequencies of a simulated chain converge to its stationary distribution
+    auto T = Matrix<double>::from({0.5, 0.5, 0.0,
+                                   0.2, 0.3, 0.5,
+                                   0.0, 0.6, 0.4}, 3, 3, true);
+    MarkovChain mc (T);
+    auto path = mc.simulate(300000, 3);
+    EXPECT_EQ(path(1), 3);
+    auto pi = mc.stationary();
+    for (int s = 1; s <= 3; s++) {
+        EXPECT_NEAR(double(path.count([s](int c) { return c == s; })) / path.size(), pi(s), 0.01);
+    }
+    // No transition of probability zero is ever taken
+    for (std::size_t i = 1; i < path.size(); i++) ASSERT_GT(T(path[i - 1], path[i]), 0);
+
+    // Roundoff negatives are zero weights, real negatives are errors
+    rng::AliasTable rounded (std::vector<double>{0.5, -5.5e-16, 0.5});
+    for (int i = 0; i < 1000; i++) ASSERT_NE(rounded(g), 2u);
+    EXPECT_THROW(rng::AliasTable(std::vector<double>{0.5, -0.1, 0.6}), std::runtime_error);
+
+    // Continuous-time chains: rows of expm(Q t) carry such roundoff
+    set_seed(12);
+    for (int trial = 0; trial < 200; trial++) {
+        auto Q = Matrix<double>::rand(5, 5, 0, 1);
+        for (int j = 1; j <= 5; j++) Q(5, j) = 0;   // absorbing state 5
+        for (int i = 1; i <= 5; i++) {
+            Q(i, i) = 0;
+            double rate = 0;
+            for (int j = 1; j <= 5; j++) rate += Q(i, j);
+            Q(i, i) = -rate;
+        }
+        auto chain = MarkovChain::continuous(Q, 2.7).simulate(5, 1);
+        ASSERT_EQ(chain.size(), 5u);
+        ASSERT_TRUE(chain.all([] (int c) { return c >= 1 && c <= 5; }));
+    }
+}
+
+TEST(Rng, ThreadLocalEngines) {
+
+    // Same seed, same draws on the main thread
+    set_seed(77);
+    auto a = runif(1000);
+    auto b = Matrix<double>::rand(10, 10, 0, 1);
+    set_seed(77);
+    EXPECT_EQ(runif(1000)[999], a[999]);
+    EXPECT_EQ(Matrix<double>::rand(10, 10, 0, 1)[99], b[99]);
+
+    // Inside a parallel region thread t draws from stream t, whichever thread runs first
+    set_seed(78);
+    std::vector<uint64_t> first (4), again (4);
+    #pragma omp parallel num_threads(4)
+    {
+        const int t = omp_get_thread_num();
+        first[t] = rng::engine().next();
+    }
+    set_seed(78);
+    #pragma omp parallel num_threads(4)
+    {
+        const int t = omp_get_thread_num();
+        again[t] = rng::engine().next();
+    }
+    EXPECT_EQ(first, again);
+    for (int t = 0; t < 4; t++) EXPECT_EQ(first[t], rng::Xoshiro(rng::detail::stream_seed(78, t, 0)).next());
+
+    // A team opened by another std::thread, or nested in a team, never reuses the main team's streams
+    for (bool foreign_first : {false, true}) {
+        set_seed(7);
+        std::vector<uint64_t> draws {rng::engine().next()};
+        std::mutex lock;
+        auto team = [&] {
+            #pragma omp parallel num_threads(4)
+            {
+                const uint64_t x = rng::engine().next();
+                std::vector<uint64_t> inner (2);
+                #pragma omp parallel num_threads(2)
+                inner[omp_get_thread_num()] = rng::engine().next();
+                const std::lock_guard<std::mutex> guard (lock);
+                draws.push_back(x);
+                if (omp_get_max_active_levels() > 1) draws.insert(draws.end(), inner.begin() + 1, inner.end());
+            }
+        };
+        if (foreign_first) {
+            std::thread(team).join();
+            team();
+        } else {
+            team();
+            std::thread(team).join();
+        }
+        std::sort(draws.begin(), draws.end());
+        EXPECT_EQ(std::adjacent_find(draws.begin(), draws.end()), draws.end()) << "foreign team first: " << foreign_first;
+        EXPECT_GE(draws.size(), 9u);
+    }
+
+    // Any other thread keeps its stream across reseeds, so its draws repeat too
+    std::thread([] {
+        set_seed(42);
+        const uint64_t x = rng::engine().next();
+        const double u = runif(10)[9];
+        set_seed(42);
+        EXPECT_EQ(rng::engine().next(), x);
+        EXPECT_EQ(runif(10)[9], u);
+    }).join();
+
+    // Vector's engine is the calling thread's too
+    const rng::Xoshiro *main_engine = &Vector<double>::xoroshiro, *other_engine = nullptr;
+    std::thread([&] { other_engine = &Vector<double>::xoroshiro; }).join();
+    EXPECT_EQ(main_engine, &rng::engine());
+    EXPECT_NE(main_engine, other_engine);
+
+    // Concurrent r* calls touch only their own thread's state
+    std::vector<double> means (4);
+    #pragma omp parallel num_threads(4)
+    {
+        const int t = omp_get_thread_num();
+        double total = 0;
+        for (int rep = 0; rep < 20; rep++) total += runif(5000).mean() + rnorm(500).mean() + rbinom(50, 100, 0.5).mean() / 100;
+        means[t] = total / 20;
+    }
+    for (double m : means) EXPECT_NEAR(m, 1.0, 0.05);
+}
+
+TEST(Rng, GammaBetaPoisson) {
+
+    rng::Xoshiro g (37);
+    const std::size_t draws = 400000;
+
+    auto dpois_exact = [] (double lambda) {
+        return [=] (int k) { return std::exp(k * std::log(lambda) - lambda - std::lgamma(k + 1.0)); };
+    };
+    EXPECT_LT(max_z_score([&] { return g.poisson(3.5); }, dpois_exact(3.5), 0, 30, draws), 5);
+    EXPECT_LT(max_z_score([&] { return g.poisson(45); }, dpois_exact(45), 0, 120, draws), 5);
+    EXPECT_EQ(g.poisson(0), 0);
+
+    // mean shape * scale and variance shape * scale^2, scalar and bulk
+    auto moments = [] (const Matrix<double>& x, double& mean, double& var) {
+        mean = x.mean();
+        const double mu = mean;
+        var = x.map([mu] (double d) { return (d - mu) * (d - mu); }).mean();
+    };
+    double mean, var;
+    for (double shape : {0.3, 2.5, 30.0}) {
+        auto bulk = rgamma(200000, shape, 2);
+        moments(bulk, mean, var);
+        EXPECT_NEAR(mean / (2 * shape), 1, 0.02);
+        EXPECT_NEAR(var / (4 * shape), 1, 0.05);
+
+        Matrix<double> scalar(1, 200000);
+        scalar.loop([&] (double& x) { x = g.gamma(shape, 2); });
+        moments(scalar, mean, var);
+        EXPECT_NEAR(mean / (2 * shape), 1, 0.02);
+        EXPECT_NEAR(var / (4 * shape), 1, 0.05);
+    }
+
+    for (auto [a, b] : {std::pair{0.5, 0.5}, std::pair{2.0, 5.0}, std::pair{0.3, 4.0}}) {
+        auto x = rbeta(200000, a, b);
+        EXPECT_TRUE(x.all([] (double d) { return d >= 0 && d <= 1; }));
+        moments(x, mean, var);
+        EXPECT_NEAR(mean, a / (a + b), 0.005);
+        EXPECT_NEAR(var, a * b / ((a + b) * (a + b) * (a + b + 1)), 0.002);
+        const double y = g.beta(a, b);
+        EXPECT_TRUE(y >= 0 && y <= 1);
+    }
+
+    // rows on the simplex, column means alpha / sum(alpha)
+    for (const auto& alpha : {ejovo::vec({1.0, 2.0, 7.0}), ejovo::vec({0.05, 0.02, 0.03})}) {
+        auto D = rdirichlet(50000, alpha);
+        EXPECT_EQ(D.ncol(), 3);
+        const double total = alpha.sum();
+        for (int i = 1; i <= 50000; i++) ASSERT_NEAR(D(i, 1) + D(i, 2) + D(i, 3), 1, 1e-12);
+        for (int j = 1; j <= 3; j++) {
+            double m = 0;
+            for (int i = 1; i <= 50000; i++) m += D(i, j);
+            EXPECT_NEAR(m / 50000, alpha(j) / total, 0.01);
+        }
+    }
+
+    EXPECT_THROW(rgamma(10, -1), std::runtime_error);
+    EXPECT_THROW(g.poisson(-2), std::runtime_error);
+
+    // parallel variants do not depend on the thread count
+    set_seed(3);
+    auto p1 = rgamma_omp(30000, 1.7, 1, {.np = 1, .grain = 4096});
+    auto q1 = rpois_omp(30000, 12, {.np = 1, .grain = 4096});
+    set_seed(3);
+    auto p4 = rgamma_omp(30000, 1.7, 1, {.np = 4, .grain = 4096});
+    auto q4 = rpois_omp(30000, 12, {.np = 4, .grain = 4096});
+    for (std::size_t i = 0; i < p1.size(); i++) {
+        ASSERT_EQ(p1[i], p4[i]);
+        ASSERT_EQ(q1[i], q4[i]);
+    }
+    EXPECT_NEAR(p1.mean(), 1.7, 0.05);
+    EXPECT_NEAR(q1.mean(), 12, 0.1);
+}
+
+TEST(Rng, MultivariateNormal) {
+
+    auto mu = Matrix<double>::from({1, -2, 0.5}, 3, 1);
+    auto sigma = Matrix<double>::from({4, 1.2, -0.6, 1.2, 1, 0.3, -0.6, 0.3, 0.5}, 3, 3, true);
+
+    set_seed(8);
+    auto X = rmvnorm(200000, mu, sigma);
+    EXPECT_EQ(X.nrow(), 200000);
+    EXPECT_EQ(X.ncol(), 3);
+
+    auto S = linalg::cov(X);
+    for (int j = 1; j <= 3; j++) {
+        double m = 0;
+        for (int i = 1; i <= 200000; i++) m += X(i, j);
+        EXPECT_NEAR(m / 200000, mu(j), 0.02);
+        for (int i = 1; i <= 3; i++) EXPECT_NEAR(S(i, j), sigma(i, j), 0.04);
+    }
+
+    // a single draw reuses the cached factor
+    rng::MultivariateNormal mvn (mu, sigma);
+    double x[3];
+    mvn(rng::engine(), x);
+    EXPECT_TRUE(std::isfinite(x[0] + x[1] + x[2]));
+
+    set_seed(9);
+    auto A = rmvnorm_omp(5000, mu, sigma, {.np = 1, .grain = 700});
+    set_seed(9);
+    auto B = rmvnorm_omp(5000, mu, sigma, {.np = 3, .grain = 700});
+    for (std::size_t i = 0; i < A.size(); i++) ASSERT_EQ(A[i], B[i]);
+
+    EXPECT_THROW(rmvnorm(10, mu, -1 * sigma), std::runtime_error);
+}
+
+TEST(Rng, QuasiMonteCarlo) {
+
+    // Known points of the Joe-Kuo Sobol sequence
+    qmc::Sobol sobol (3);
+    auto S = sobol.points(8);
+    const double d1[] = {0, 0.5, 0.75, 0.25, 0.375, 0.875, 0.625, 0.125};
+    const double d2[] = {0, 0.5, 0.25, 0.75, 0.375, 0.875, 0.125, 0.625};
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(S(i + 1, 1), d1[i]);
+        EXPECT_EQ(S(i + 1, 2), d2[i]);
+    }
+    EXPECT_EQ(sobol.index(), 8u);
+
+    // Every dimension is a (0, 1)-sequence: 2^10 points, one per interval of width 2^-10
+    qmc::Sobol full (qmc::Sobol::max_dim);
+    auto F = full.points(1024);
+    for (std::size_t j = 1; j <= full.dim(); j++) {
+        std::vector<int> hits (1024, 0);
+        for (int i = 1; i <= 1024; i++) hits[static_cast<int>(F(i, j) * 1024)]++;
+        ASSERT_TRUE(std::all_of(hits.begin(), hits.end(), [] (int h) { return h == 1; })) << "dimension " << j;
+    }
+
+    // Random access agrees with Gray-code stepping, also after a digital shift
+    full.scramble(17).seek(1000);
+    std::vector<double> x (full.dim()), y (full.dim());
+    for (int i = 0; i < 50; i++) {
+        full.point(1000 + i, y.data());
+        full.next(x.data());
+        ASSERT_EQ(x, y);
+    }
+    EXPECT_THROW(qmc::Sobol(qmc::Sobol::max_dim + 1), std::runtime_error);
+
+    // Halton: radical inverses in bases 2 and 3
+    qmc::Halton halton (2);
+    auto H = halton.points(5);
+    EXPECT_DOUBLE_EQ(H(4, 1), 0.75);
+    EXPECT_DOUBLE_EQ(H(4, 2), 1.0 / 9);
+    EXPECT_DOUBLE_EQ(H(5, 2), 4.0 / 9);
+
+    // Scrambling permutes digits and keeps the stratification: 3^5 points, one per interval
+    qmc::Halton scrambled (6);
+    scrambled.scramble(4);
+    auto Z = scrambled.points(243);
+    std::vector<int> hits (243, 0);
+    for (int i = 1; i <= 243; i++) hits[std::lround(Z(i, 2) * 243)]++;   // exactly k / 243 up to roundoff
+    EXPECT_TRUE(std::all_of(hits.begin(), hits.end(), [] (int h) { return h == 1; }));
+    scrambled.seek(100);
+    scrambled.next(x.data());
+    scrambled.point(100, y.data());
+    for (int j = 0; j < 6; j++) EXPECT_EQ(x[j], y[j]);
+
+    // Latin hypercube: each column hits each stratum once
+    set_seed(2);
+    auto L = qmc::latin_hypercube(100, 4);
+    for (int j = 1; j <= 4; j++) {
+        std::vector<int> strata (100, 0);
+        for (int i = 1; i <= 100; i++) strata[static_cast<int>(L(i, j) * 100)]++;
+        EXPECT_TRUE(std::all_of(strata.begin(), strata.end(), [] (int h) { return h == 1; }));
+    }
+
+    // Smooth integrands: far below the n^-1/2 Monte Carlo error
+    EXPECT_NEAR(monte_carlo::integrate_qmc(1 << 16, [] (double t) { return t * t; }, 0, 2), 8.0 / 3, 1e-4);
+
+    auto product = [] (const double *t) {
+        double p = 1;
+        for (int j = 0; j < 5; j++) p *= std::exp(t[j]) / (std::exp(1.0) - 1);
+        return p;
+    };
+    const auto zero = Matrix<double>::zeros(5, 1), one = zero.map([] (double) { return 1.0; });
+    EXPECT_NEAR(monte_carlo::integrate_box(1 << 14, product, zero, one), 1, 1e-3);
+    EXPECT_NEAR(monte_carlo::integrate_box(1 << 14, product, zero, one, qmc::Halton(5).scramble(3), 1000), 1, 2e-3);
+
+    // The scrambles' bounded integers: a full 128 bit product, and every residue hit evenly
+    uint64_t lo;
+    EXPECT_EQ(qmc::detail::mul_wide(~0ull, ~0ull, lo), ~0ull - 1);
+    EXPECT_EQ(lo, 1u);
+    rng::Xoshiro g (9);
+    std::vector<int> residues (7);
+    for (int i = 0; i < 70000; i++) residues[qmc::detail::below(g, 7)]++;
+    for (int h : residues) EXPECT_NEAR(h, 10000, 500);
+}
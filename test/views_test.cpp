@@ -0,0 +1,52 @@
+#include "ejovotest.hpp"
+#include <gtest/gtest.h>
+#include <ranges>
+
+using namespace ejovo;
+
+static_assert(std::ranges::contiguous_range<Matrix<double>>);
+static_assert(std::ranges::random_access_range<Grid1D<double>&>);
+static_assert(std::ranges::random_access_range<const Grid1D<double>&>);
+static_assert(std::ranges::random_access_range<Matrix<double>::MatView&>);
+static_assert(std::ranges::sized_range<Matrix<int>::RowView&>);
+
+TEST(Views, RangeFor) {
+
+    auto m = seq<int>(10);
+
+    int total = 0;
+    for (int x : m) total += x;
+    EXPECT_EQ(total, 55);
+
+    // iterate a view through the virtual Grid1D iterator
+    Grid1D<int>& g = m;
+    total = 0;
+    for (int x : g) total += x;
+    EXPECT_EQ(total, 55);
+}
+
+TEST(Views, LazyPipeline) {
+
+    auto m = seq<int>(10);
+
+    auto evens_squared = m | views::filter([] (int x) { return x % 2 == 0; })
+                           | views::map([] (int x) { return x * x; })
+                           | views::collect();
+
+    EXPECT_EQ(evens_squared.size(), 5);
+    EXPECT_TRUE(evens_squared.eq({4, 16, 36, 64, 100}));
+
+    int s = m | views::map([] (int x) { return 2 * x; }) | views::take(3) | views::sum();
+    EXPECT_EQ(s, 12);
+
+    int p = m | views::take(4) | views::reduce([] (int a, int b) { return a * b; }, 1);
+    EXPECT_EQ(p, 24);
+}
+
+TEST(Views, Quadrature) {
+
+    std::function<double(double)> sq = [] (double x) { return x * x; };
+
+    EXPECT_NEAR(quad::trapezoid(0.0, 1.0, sq, 1000), 1.0 / 3.0, 1e-6);
+    EXPECT_NEAR(quad::midpoint(0.0, 1.0, sq, 1000), 1.0 / 3.0, 1e-6);
+}